@@ -4684,6 +4684,11 @@ dmproc 1 setup_graphics {} {
 #---------------------------------------------------------------------
 
 dmproc 1 lz77_decode { data } {
+                                # Use the engine's decoder if present
+    if { [llength [info commands br::decode]] } {
+        return [br::decode lz77 $data]
+    }
+
     set LZ_Escape1 "\x01"
     set LZ_Escape2 "\x02"
 
@@ -4786,6 +4791,11 @@ dmproc 1 base64_decode { string } {
     global base64
 
     if { [string length $string] == 0 } { return "" }
+                                # Use the engine's decoder if present
+    if { [llength [info commands br::decode]] } {
+        return [br::decode base64 $string]
+    }
+
     if { ![info exists    base64] || \
          ![string length $base64] } { makebase64 }
 
@@ -4850,6 +4860,9 @@ dmproc 1 base64_decode { string } {
 #---------------------------------------------------------------------
 
 dmproc 1 lz77_base64_decode { data } {
+    if { [llength [info commands br::decode]] } {
+        return [br::decode {base64 lz77} $data]
+    }
     return [lz77_decode [base64_decode $data]]
 }
 
@@ -4867,6 +4880,12 @@ dmproc 1 lz77_base64_decode { data } {
 #---------------------------------------------------------------------
 
 dmproc 1 bxdiv_lz77_base64_decode { data } {
+                                # The engine's decoder does all three
+                                # steps in one pass
+    if { [llength [info commands br::decode]] } {
+        return [br::decode {base64 lz77 bxdiv} $data]
+    }
+
     set data [lz77_base64_decode $data]
     set n [binary scan $data a5a6a1a* magic revision divisor data]
     if { $n != 4 }           { puts "$IE-01: $n"     ; exit 1 }
@@ -5815,6 +5834,26 @@ dmproc 10 verify_sprite_exists { msg id } {
 
 #---------------------------------------------------------------------
 
+# Routine:    set_sprite_callback
+# Purpose:    Registers a sprite's callback with the engine
+# Arguments:  id = Sprite ID
+
+# If the engine provides "br::dispatch",  this routine hands it the call-
+# back recorded in sdata($id.),  so that the main loop can run the call-
+# backs for the whole sprite list in a single command.  The engine drops
+# the callback when the sprite is deleted.
+
+#---------------------------------------------------------------------
+
+dmproc 10 set_sprite_callback { id } {
+    global sdata
+    if { [llength [info commands br::dispatch]] } {
+        br::sprite callback $id $sdata($id.)
+    }
+}
+
+#---------------------------------------------------------------------
+
 # Routine:    collision_sprites
 # Purpose:    Sprite collision utility routine
 # Arguments:  id = Sprite ID
@@ -7874,6 +7913,11 @@ dmproc 1 set_world_name { name } {
 
     set lv        $name
     set gdata(lv) $name
+                                # Callbacks still to run  in the current
+                                # pass belong to the old world
+    if { [llength [info commands br::dispatch]] } {
+        br::dispatch stop
+    }
 }
 
 #---------------------------------------------------------------------
@@ -8022,6 +8066,7 @@ dmproc 2 group_generic_new { objclass } {
         ]
         verify_sprite_exists $rtn $id
         br::list add $layers($lv.spr-list) $id
+        set_sprite_callback $id
                                 # Randomly position the sprite
         random_position_sprite $id
         return $id
@@ -8130,6 +8175,7 @@ dmproc 2 new_ocinter { PortalType ToWorldName ToPortalID } {
 
     verify_sprite_exists new_ocinter $id
     br::list add $layers($lv.spr-list) $id
+    set_sprite_callback $id
                                 # Randomly position the sprite
     random_position_sprite $id
     return $id
@@ -8152,6 +8198,7 @@ dmproc 2 new_ocintra {} {
 
     array set sdata [list $id. run_ocintra]
     br::list add $layers($lv.spr-list) $id
+    set_sprite_callback $id
                                 # Randomly position the sprite
     random_position_sprite $id
     return $id
@@ -8221,6 +8268,7 @@ dmproc 2 new_ockarkinos {} {
             $id.speed_divisor  $speed_divisor       \
         ]
         br::list add $layers($lv.spr-list) $id
+        set_sprite_callback $id
                                 # Randomly position the sprite
         random_position_sprite $id
     }
@@ -8281,6 +8329,7 @@ dmproc 2 new_ocmedical {} {
         ]
         verify_sprite_exists $rtn $id
         br::list add $layers($lv.spr-list) $id
+        set_sprite_callback $id
                                 # Randomly position the sprite
         random_position_sprite $id
         return $id
@@ -8352,6 +8401,7 @@ dmproc 2 new_ocmoney {} {
     ]
     verify_sprite_exists $rtn $id
     br::list add $layers($lv.spr-list) $id
+    set_sprite_callback $id
                                 # Randomly position the sprite
     random_position_sprite $id
     return $id
@@ -8391,6 +8441,7 @@ dmproc 2 new_ocplayer {} {
     ]
 
     br::list add $layers($lv.spr-list) $ocplayer
+    set_sprite_callback $ocplayer
     random_position_sprite             $ocplayer
     account_ocplayer_position
     return $ocplayer
@@ -8414,6 +8465,7 @@ dmproc 2 new_ocscroll {} {
     array set sdata [list $id. run_ocscroll]
     verify_sprite_exists $rtn $id
     br::list add $layers($lv.spr-list) $id
+    set_sprite_callback $id
                                 # Randomly position the sprite
     random_position_sprite $id
     return $id
@@ -8477,6 +8529,7 @@ dmproc 2 new_octiger {} {
 
         verify_sprite_exists $rtn $id
         br::list add $layers($lv.spr-list) $id
+        set_sprite_callback $id
                                 # Randomly position the sprite
         random_position_sprite $id
         return $id
@@ -8513,6 +8566,7 @@ dmproc 2 new_octree {} {
     ]
     verify_sprite_exists $rtn $id
     br::list add $layers($lv.spr-list) $id
+    set_sprite_callback $id
                                 # Randomly position the sprite
     random_position_sprite $id
     return $id
@@ -9868,6 +9922,7 @@ dmproc 100 run_ocplayer { id } {
                                 # Add it to the lists
             br::list add $layers($lv.spr-list) $ocbullet
             set sdata($ocbullet.) run_ocbullet
+            set_sprite_callback $ocbullet
             set sdata($id.shot) 1
                                 # Play the appropriate sound
             play_sound gunshot 0
@@ -10204,12 +10259,19 @@ dmproc 1 setup_program {} {
 #---------------------------------------------------------------------
 
 dmproc 1 main_routine {} {
-    global BRICKAPI FPS lv gdata sdata
+    global BRICKAPI FPS layers lv gdata sdata
     setup_program             ; # Set up the program
+    set use_dispatch [llength [info commands br::dispatch]]
 
     while { $gdata(health) > 0 } {
-                                # Run callbacks for sprites
-        foreach { id callback } [array get sdata *.] {
+                                # Run callbacks for sprites.  If the en-
+                                # gine can do this  itself,  it skips any
+                                # sprite removed earlier in the pass, and
+                                # "set_world_name" ends the pass.
+        if { $use_dispatch } {
+            br::dispatch run $layers($lv.spr-list)
+        } else {
+            foreach { id callback } [array get sdata *.] {
 
 # The "info exists" test below is  an attempt to prevent callbacks re-
 # lated to sprites  that are  removed from  play mid-loop.  It appears
@@ -10220,12 +10282,13 @@ dmproc 1 main_routine {} {
 # problems,  the callback routines  have  been  modified  so that they
 # simply return if an inconsistency of this type is detected.
 
-            if { [info exists sdata($id)] } {
-                set oldlv $lv
-                $callback [string trim $id .]
+                if { [info exists sdata($id)] } {
+                    set oldlv $lv
+                    $callback [string trim $id .]
                                 # If we've changed worlds,  we need to
                                 # exit the inner loop immediately
-                if { $oldlv ne $lv } { break }
+                    if { $oldlv ne $lv } { break }
+                }
             }
         }
                                 # Take care of necessary business
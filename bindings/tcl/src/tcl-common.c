@@ -8,6 +8,41 @@
 #define NS "br"
 Tcl_Namespace *ns;
 
+/*
+ * engine handles are Tcl objects of their own type, which keep the
+ * pointer in their internal representation rather than re-parsing it
+ * from the string each time.  every handle given out is entered in the
+ * registry with the kind of object it is (one of the engine's OBJ_*
+ * constants), and left there until the engine says the object has been
+ * deleted, so a stale, made-up or wrong kind of handle is caught
+ * instead of being dereferenced.  a handle is only looked up again once
+ * something has been deleted since it was last checked; in between, it
+ * keeps the kind it was checked as alongside the epoch it was checked
+ * in.
+ */
+#define HANDLE_ANY 0
+#define HANDLE_KIND_BITS 4
+
+/* or'd into a kind by the commands that take a null handle, e.g. to take a layer's map away */
+#define HANDLE_NULL (1 << HANDLE_KIND_BITS)
+#define handle_stamp(kind) ((void *) ((handle_epoch << HANDLE_KIND_BITS) | (kind)))
+
+static Tcl_ObjType handle_type = { "br-handle", NULL, dup_handle, update_handle_string, set_handle_from_any };
+static Tcl_HashTable handles;
+static long handle_epoch;
+static int handles_ready;
+
+/*
+ * the commands br::dispatch runs for each sprite, keyed by sprite.  a
+ * sprite's command is dropped as soon as the engine deletes it, however
+ * that happens.  each one is stamped with a generation when it's set,
+ * so a sprite that is deleted and replaced at the same address
+ * part-way through a pass is not mistaken for the old one.
+ */
+static Tcl_HashTable callbacks;
+static unsigned long callback_gen;
+static int dispatch_stopped;
+
 /* Some shortcuts */
 #define Add_cmd(my_cmd, my_func) Tcl_CreateObjCommand(interp, NS "::" my_cmd, my_func, (ClientData) NULL, (Tcl_CmdDeleteProc *) NULL)
 #define Ensemble(name) \
@@ -27,6 +62,16 @@ void load_routines(Tcl_Interp *interp)
 	/* here we go! */
 	DEBUG("Registering C functions into tcl...");
 
+	/* the engine-handle type, and its registry */
+	if( !handles_ready )
+		{
+			Tcl_InitHashTable(&handles, TCL_ONE_WORD_KEYS);
+			Tcl_InitHashTable(&callbacks, TCL_ONE_WORD_KEYS);
+			Tcl_RegisterObjType(&handle_type);
+			set_delete_hook(handle_deleted);
+			handles_ready = 1;
+		}
+
 	/* create the namespace for the brick engine commands */
 	Tcl_Eval(interp, "namespace eval " NS " { namespace export * }");
 
@@ -150,12 +195,19 @@ void load_routines(Tcl_Interp *interp)
 	Add_cmd("sprite::frame", wrap_sprite_frame);
 	Add_cmd("sprite::z-hint", wrap_sprite_z_hint);
 	Add_cmd("sprite::scale", wrap_sprite_scale);
+	Add_cmd("sprite::filter", wrap_sprite_filter);
+	Add_cmd("sprite::angle", wrap_sprite_angle);
 	Add_cmd("sprite::collides", wrap_sprite_collides);
 	Add_cmd("sprite::bounding-box", wrap_sprite_bounding_box);
 	Add_cmd("sprite::pixel-mask", wrap_sprite_pixel_mask);
 	Add_cmd("sprite::pixel-mask-from", wrap_sprite_pixel_mask_from);
 	Add_cmd("sprite::position", wrap_sprite_position);
 	Add_cmd("sprite::velocity", wrap_sprite_velocity);
+	Add_cmd("sprite::positions", wrap_sprite_positions);
+	Add_cmd("sprite::velocities", wrap_sprite_velocities);
+	Add_cmd("sprite::frames", wrap_sprite_frames);
+	Add_cmd("sprite::states", wrap_sprite_states);
+	Add_cmd("sprite::callback", wrap_sprite_callback);
 	Add_cmd("sprite::add-frame", wrap_sprite_add_frame);
 	Add_cmd("sprite::add-frame-data", wrap_sprite_add_frame_data);
 	Add_cmd("sprite::add-subframe", wrap_sprite_add_subframe);
@@ -178,6 +230,7 @@ void load_routines(Tcl_Interp *interp)
 
 	Ensemble("collision");
 	Add_cmd("collision::map", wrap_collision_map);
+	Add_cmd("collision::map-all", wrap_collision_map_all);
 	Add_cmd("collision::sprites", wrap_collision_sprites);
 
 	Ensemble("motion");
@@ -187,6 +240,40 @@ void load_routines(Tcl_Interp *interp)
 	Ensemble("clock");
 	Add_cmd("clock::ms", wrap_clock_ms);
 	Add_cmd("clock::wait", wrap_clock_wait);
+	Add_cmd("clock::stats", wrap_clock_stats);
+	Add_cmd("clock::reset-stats", wrap_clock_reset_stats);
+
+	Ensemble("stats");
+	Add_cmd("stats::enabled", wrap_stats_enabled);
+	Add_cmd("stats::get", wrap_stats_get);
+	Add_cmd("stats::reset", wrap_stats_reset);
+
+	Add_cmd("decode", wrap_decode);
+
+	Ensemble("load");
+	Add_cmd("load::async", wrap_load_async);
+	Add_cmd("load::async-buffer", wrap_load_async_buffer);
+	Add_cmd("load::poll", wrap_load_poll);
+
+	Ensemble("cache");
+	Add_cmd("cache::open", wrap_cache_open);
+	Add_cmd("cache::close", wrap_cache_close);
+	Add_cmd("cache::frame-from-disk", wrap_cache_frame_from_disk);
+	Add_cmd("cache::frame-from-buffer", wrap_cache_frame_from_buffer);
+	Add_cmd("cache::sound-from-disk", wrap_cache_sound_from_disk);
+	Add_cmd("cache::sound-from-buffer", wrap_cache_sound_from_buffer);
+
+	Ensemble("pack");
+	Add_cmd("pack::open", wrap_pack_open);
+	Add_cmd("pack::close", wrap_pack_close);
+	Add_cmd("pack::frame", wrap_pack_frame);
+	Add_cmd("pack::bound", wrap_pack_bound);
+	Add_cmd("pack::sound", wrap_pack_sound);
+	Add_cmd("pack::font", wrap_pack_font);
+
+	Ensemble("dispatch");
+	Add_cmd("dispatch::run", wrap_dispatch_run);
+	Add_cmd("dispatch::stop", wrap_dispatch_stop);
 
 	/* set up package-stuff */
 	Tcl_ResetResult(interp);
@@ -210,12 +297,11 @@ void load_routines(Tcl_Interp *interp)
 			return TCL_ERROR; \
 	} while(0)
 
-#define FETCH_PTR(pos, var) \
+#define FETCH_PTR(pos, kind, var) \
 	do { \
-		char *__src; \
 		void *__res; \
-		__src = Tcl_GetString(objv[pos]); \
-		sscanf(__src, "%p", &__res); \
+		if( get_handle(interp, objv[pos], kind, &__res) == TCL_ERROR ) \
+			return TCL_ERROR; \
 		var = __res; \
 	} while(0)
 
@@ -290,21 +376,15 @@ void load_routines(Tcl_Interp *interp)
 		return TCL_OK; \
 	} while(0)
 
-#define RET_PTR(var) \
+#define RET_PTR(kind, var) \
 	do { \
-		char buf[PTR_LEN+1]; \
-		snprintf(buf, PTR_LEN, "%p", var); \
-		Tcl_Obj *tcl_result = Tcl_NewObj(); \
-		Tcl_SetStringObj(tcl_result, buf, -1); \
-		Tcl_SetObjResult(interp, tcl_result); \
+		Tcl_SetObjResult(interp, new_handle(kind, var)); \
 		return TCL_OK; \
 	} while(0)
 
-#define APPEND_PTR(list, ptr) \
+#define APPEND_PTR(list, kind, ptr) \
 	do { \
-		char buf[PTR_LEN+1]; \
-		snprintf(buf, PTR_LEN, "%p", ptr); \
-		Tcl_ListObjAppendElement(interp, list, Tcl_NewStringObj(buf, -1)); \
+		Tcl_ListObjAppendElement(interp, list, new_handle(kind, ptr)); \
 	} while(0)
 
 #define APPEND_STG(list, stg) \
@@ -368,6 +448,169 @@ void load_routines(Tcl_Interp *interp)
 
 
 
+/*
+ * make a Tcl object for an engine handle, and register the handle as
+ * the given kind.  with HANDLE_ANY, e.g. for whatever was in a list,
+ * the kind it was registered as is kept, and a pointer that isn't
+ * registered (because its object has since been deleted) isn't brought
+ * back to life.
+ */
+static Tcl_Obj *new_handle(int kind, void *ptr)
+{
+	Tcl_HashEntry *entry;
+	Tcl_Obj *obj;
+	void *stamp;
+	int is_new;
+
+	stamp = handle_stamp(kind);
+	if( ptr && kind != HANDLE_ANY )
+		{
+			entry = Tcl_CreateHashEntry(&handles, ptr, &is_new);
+			Tcl_SetHashValue(entry, (ClientData) (long) kind);
+		}
+	else if( ptr )
+		{
+			entry = Tcl_FindHashEntry(&handles, ptr);
+			if( entry )
+				stamp = handle_stamp((long) Tcl_GetHashValue(entry));
+			else
+				stamp = (void *) -1L;
+		}
+
+	/* the string is only made if it's asked for */
+	obj = Tcl_NewObj();
+	Tcl_InvalidateStringRep(obj);
+	obj->internalRep.twoPtrValue.ptr1 = ptr;
+	obj->internalRep.twoPtrValue.ptr2 = stamp;
+	obj->typePtr = &handle_type;
+	return obj;
+}
+
+/*
+ * fetch the pointer from a handle, checking it's still a live handle,
+ * and of the given kind unless that's HANDLE_ANY.  a null handle is
+ * only let through with HANDLE_NULL.
+ */
+static int get_handle(Tcl_Interp *interp, Tcl_Obj *obj, int kind, void **res)
+{
+	Tcl_HashEntry *entry;
+	long stamp;
+	void *ptr;
+
+	if( obj->typePtr != &handle_type && Tcl_ConvertToType(interp, obj, &handle_type) == TCL_ERROR )
+		return TCL_ERROR;
+
+	ptr = obj->internalRep.twoPtrValue.ptr1;
+	if( !ptr )
+		{
+			if( !(kind & HANDLE_NULL) )
+				{
+					Tcl_SetObjResult(interp, Tcl_NewStringObj("Invalid or deleted handle ", -1));
+					return TCL_ERROR;
+				}
+
+			*res = NULL;
+			return TCL_OK;
+		}
+	kind &= ~HANDLE_NULL;
+
+	/* anything deleted since this handle was last checked? */
+	stamp = (long) obj->internalRep.twoPtrValue.ptr2;
+	if( stamp >> HANDLE_KIND_BITS != handle_epoch )
+		{
+			entry = Tcl_FindHashEntry(&handles, ptr);
+			if( !entry )
+				{
+					Tcl_SetObjResult(interp, Tcl_NewStringObj("Invalid or deleted handle ", -1));
+					return TCL_ERROR;
+				}
+			obj->internalRep.twoPtrValue.ptr2 = handle_stamp((long) Tcl_GetHashValue(entry));
+			stamp = (long) obj->internalRep.twoPtrValue.ptr2;
+		}
+
+	if( kind != HANDLE_ANY && (stamp & ((1 << HANDLE_KIND_BITS) - 1)) != kind )
+		{
+			Tcl_SetObjResult(interp, Tcl_NewStringObj("Wrong kind of handle ", -1));
+			return TCL_ERROR;
+		}
+
+	*res = ptr;
+	return TCL_OK;
+}
+
+/* take a deleted object's handle out of the registry */
+static void forget_handle(void *ptr)
+{
+	Tcl_HashEntry *entry;
+
+	if( !ptr )
+		return;
+
+	entry = Tcl_FindHashEntry(&handles, ptr);
+	if( entry )
+		{
+			Tcl_DeleteHashEntry(entry);
+			handle_epoch++;
+		}
+}
+
+/*
+ * the engine's delete hook:  an object's going, whether it was deleted
+ * through a command or by the engine itself (e.g. the frames of a
+ * deleted sprite, or a sprite deleted by its motion program), so its
+ * handle mustn't be trusted any longer, and a sprite's callback goes
+ * with it rather than passing to the next sprite made at its address.
+ */
+static void handle_deleted(int kind, void *ptr)
+{
+	forget_handle(ptr);
+	if( kind == OBJ_SPRITE )
+		forget_callback(ptr);
+}
+
+static void dup_handle(Tcl_Obj *src, Tcl_Obj *dup)
+{
+	dup->internalRep = src->internalRep;
+	dup->typePtr = &handle_type;
+}
+
+static void update_handle_string(Tcl_Obj *obj)
+{
+	char buf[PTR_LEN+1];
+	int len;
+
+	len = snprintf(buf, PTR_LEN, "%p", obj->internalRep.twoPtrValue.ptr1);
+	obj->bytes = Tcl_Alloc(len + 1);
+	memcpy(obj->bytes, buf, len + 1);
+	obj->length = len;
+}
+
+/* parse a handle from its string, as written by update_handle_string() */
+static int set_handle_from_any(Tcl_Interp *interp, Tcl_Obj *obj)
+{
+	void *ptr;
+	char *src;
+
+	src = Tcl_GetString(obj);
+	if( sscanf(src, "%p", &ptr) != 1 )
+		{
+			if( interp )
+				Tcl_SetObjResult(interp, Tcl_NewStringObj("Invalid handle ", -1));
+			return TCL_ERROR;
+		}
+
+	if( obj->typePtr && obj->typePtr->freeIntRepProc )
+		obj->typePtr->freeIntRepProc(obj);
+
+	/* it's checked against the registry before it's first used */
+	obj->internalRep.twoPtrValue.ptr1 = ptr;
+	obj->internalRep.twoPtrValue.ptr2 = (void *) -1L;
+	obj->typePtr = &handle_type;
+	return TCL_OK;
+}
+
+
+
 /* process the request to open a graphics mode .. */
 static int wrap_graphics_open(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[])
 {
@@ -917,7 +1160,7 @@ static int wrap_sound_load_file(ClientData cData, Tcl_Interp *interp, int objc,
 	char *file;
 	HAS_ARGS(2, "filename ");
 	FETCH_STRING(1, file);
-	RET_PTR(sound_load_from_disk(file));
+	RET_PTR(OBJ_SOUND, sound_load_from_disk(file));
 }
 
 /* we have been requested to load a sound from a memory buffer */
@@ -927,7 +1170,7 @@ static int wrap_sound_load_buffer(ClientData cData, Tcl_Interp *interp, int objc
 	int len;
 	HAS_ARGS(2, "data ");
 	FETCH_DATA(1, len, data);
-	RET_PTR(sound_load_from_buffer(len, data));
+	RET_PTR(OBJ_SOUND, sound_load_from_buffer(len, data));
 }
 
 /*
@@ -941,7 +1184,7 @@ static int wrap_sound_load_raw(ClientData cData, Tcl_Interp *interp, int objc, T
 	int len;
 	HAS_ARGS(2, "data ");
 	FETCH_DATA(1, len, data);
-	RET_PTR(sound_load_raw(len, data));
+	RET_PTR(OBJ_SOUND, sound_load_raw(len, data));
 }
 
 /* play the named sound */
@@ -952,7 +1195,7 @@ static int wrap_sound_play(ClientData cData, Tcl_Interp *interp, int objc, Tcl_O
 	int ch;        /* the channel to return */
 
 	HAS_ARGS_2(2, 3, "sound-id ?volume? ");
-	FETCH_PTR(1, sound);
+	FETCH_PTR(1, OBJ_SOUND, sound);
 	if( objc == 3 )
 		FETCH_INT(2, vol);
 	else
@@ -1096,7 +1339,7 @@ static int wrap_song_adj_vol(ClientData cData, Tcl_Interp *interp, int objc, Tcl
 static int wrap_list_create(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[])
 {
 	HAS_ARGS(1, NULL);
-	RET_PTR(list_create());
+	RET_PTR(OBJ_LIST, list_create());
 }
 
 /* emptying a list. */
@@ -1104,7 +1347,7 @@ static int wrap_list_empty(ClientData cData, Tcl_Interp *interp, int objc, Tcl_O
 {
 	list *l;
 	HAS_ARGS(2, "list-id ");
-	FETCH_PTR(1, l);
+	FETCH_PTR(1, OBJ_LIST, l);
 	list_empty(l);
 	return TCL_OK;
 }
@@ -1114,7 +1357,7 @@ static int wrap_list_delete(ClientData cData, Tcl_Interp *interp, int objc, Tcl_
 {
 	list *l;
 	HAS_ARGS(2, "list-id ");
-	FETCH_PTR(1, l);
+	FETCH_PTR(1, OBJ_LIST, l);
 	list_delete(l);
 	return TCL_OK;
 }
@@ -1125,8 +1368,8 @@ static int wrap_list_add(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj
 	list *l;
 	void *item;
 	HAS_ARGS(3, "list-id item-id ");
-	FETCH_PTR(1, l);
-	FETCH_PTR(2, item);
+	FETCH_PTR(1, OBJ_LIST, l);
+	FETCH_PTR(2, HANDLE_ANY, item);
 	list_add(l, item);
 	return TCL_OK;
 }
@@ -1137,8 +1380,8 @@ static int wrap_list_prepend(ClientData cData, Tcl_Interp *interp, int objc, Tcl
 	list *l;
 	void *item;
 	HAS_ARGS(3, "list-id item-id ");
-	FETCH_PTR(1, l);
-	FETCH_PTR(2, item);
+	FETCH_PTR(1, OBJ_LIST, l);
+	FETCH_PTR(2, HANDLE_ANY, item);
 	list_prepend(l, item);
 	return TCL_OK;
 }
@@ -1148,8 +1391,8 @@ static int wrap_list_shift(ClientData cData, Tcl_Interp *interp, int objc, Tcl_O
 {
 	list *l;
 	HAS_ARGS(2, "list-id ");
-	FETCH_PTR(1, l);
-	RET_PTR(list_shift(l));
+	FETCH_PTR(1, OBJ_LIST, l);
+	RET_PTR(HANDLE_ANY, list_shift(l));
 }
 
 /* pop from a list. */
@@ -1157,8 +1400,8 @@ static int wrap_list_pop(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj
 {
 	list *l;
 	HAS_ARGS(2, "list-id ");
-	FETCH_PTR(1, l);
-	RET_PTR(list_pop(l));
+	FETCH_PTR(1, OBJ_LIST, l);
+	RET_PTR(HANDLE_ANY, list_pop(l));
 }
 
 /* remove from a list. */
@@ -1173,8 +1416,8 @@ static int wrap_list_remove(ClientData cData, Tcl_Interp *interp, int objc, Tcl_
 	int dir;
 
 	HAS_ARGS_2(3, 4, "list-id item-id ?direction? ");
-	FETCH_PTR(1, l);
-	FETCH_PTR(2, item);
+	FETCH_PTR(1, OBJ_LIST, l);
+	FETCH_PTR(2, HANDLE_ANY, item);
 
 	/* if the optional direction argument is given, parse it out */
 	if( objc == 4 )
@@ -1202,7 +1445,7 @@ static int wrap_list_length(ClientData cData, Tcl_Interp *interp, int objc, Tcl_
 {
 	list *l;
 	HAS_ARGS(2, "list-id ");
-	FETCH_PTR(1, l);
+	FETCH_PTR(1, OBJ_LIST, l);
 	RET_INT(list_length(l));
 }
 
@@ -1212,8 +1455,8 @@ static int wrap_list_find(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Ob
 	list *l;
 	void *item;
 	HAS_ARGS(3, "list-id item-id ");
-	FETCH_PTR(1, l);
-	FETCH_PTR(2, item);
+	FETCH_PTR(1, OBJ_LIST, l);
+	FETCH_PTR(2, HANDLE_ANY, item);
 	RET_INT(list_find(l, item));
 }
 
@@ -1276,11 +1519,11 @@ static int wrap_layer_sprite_list(ClientData cData, Tcl_Interp *interp, int objc
 	if( objc == 2 )
 		{
 			l = layer_get_sprite_list(id);
-			RET_PTR(l);
+			RET_PTR(OBJ_LIST, l);
 		}
 	else
 		{
-			FETCH_PTR(2, l);
+			FETCH_PTR(2, OBJ_LIST | HANDLE_NULL, l);
 			layer_set_sprite_list(id, l);
 			return TCL_OK;
 		}
@@ -1300,11 +1543,11 @@ static int wrap_layer_map(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Ob
 	if( objc == 2 )
 		{
 			map = layer_get_map(id);
-			RET_PTR(map);
+			RET_PTR(OBJ_MAP, map);
 		}
 	else
 		{
-			FETCH_PTR(2, map);
+			FETCH_PTR(2, OBJ_MAP | HANDLE_NULL, map);
 			layer_set_map(id, map);
 			return TCL_OK;
 		}
@@ -1324,11 +1567,11 @@ static int wrap_layer_string_list(ClientData cData, Tcl_Interp *interp, int objc
 	if( objc == 2 )
 		{
 			l = layer_get_string_list(id);
-			RET_PTR(l);
+			RET_PTR(OBJ_LIST, l);
 		}
 	else
 		{
-			FETCH_PTR(2, l);
+			FETCH_PTR(2, OBJ_LIST | HANDLE_NULL, l);
 			layer_set_string_list(id, l);
 			return TCL_OK;
 		}
@@ -1481,7 +1724,7 @@ static int wrap_frame_info(ClientData cData, Tcl_Interp *interp, int objc, Tcl_O
 
 
 	HAS_ARGS(2, "frame-id ");
-	FETCH_PTR(1, frame);
+	FETCH_PTR(1, OBJ_FRAME, frame);
 
 	/* get the frame info */
 	if( frame_info(frame, &w, &h, &mode) == ERR )
@@ -1501,6 +1744,117 @@ static int wrap_frame_info(ClientData cData, Tcl_Interp *interp, int objc, Tcl_O
 
 }
 
+/*
+ * make a frame that uses a bytearray's buffer as its data, rather than a
+ * copy of it.  only an unshared bytearray, i.e. a temporary such as the
+ * result of [read], is used as it is.  one that's shared -- which is any
+ * value held in a variable -- is copied once first, since the frame may
+ * rewrite the data in place, and the script could turn the value into
+ * some other type and free the bytes from under the frame.  either way
+ * the frame keeps a reference to the object until it's deleted.  NULL is
+ * returned if there isn't enough data, or if the type can't use it as it is.
+ */
+static frame *adopt_frame_data(Tcl_Obj *obj, int type, int w, int h)
+{
+	unsigned char *data;
+	int len, size;
+	frame *frame;
+
+	switch(type)
+		{
+			case FRAME_RGBA:  size = RGBA_BYTES; break;
+			case FRAME_DISPL: size = DISPL_SPAN * sizeof(short); break;
+			default:          size = 1; break;
+		}
+
+	data = Tcl_GetByteArrayFromObj(obj, &len);
+	if( w <= 0 || h <= 0 || len < w * h * size )
+		return NULL;
+
+	if( Tcl_IsShared(obj) )
+		obj = Tcl_DuplicateObj(obj);
+	Tcl_IncrRefCount(obj);
+	data = Tcl_GetByteArrayFromObj(obj, &len);
+	Tcl_InvalidateStringRep(obj);
+
+	frame = frame_adopt(type, w, h, data, release_bytes, obj);
+	if( !frame )
+		Tcl_DecrRefCount(obj);
+
+	return frame;
+}
+
+/* let go of a bytearray a frame has adopted */
+static void release_bytes(void *obj)
+{
+	Tcl_DecrRefCount((Tcl_Obj *) obj);
+}
+
+/*
+ * retrieve a convolution from a list, either a kernel thus:
+ * { w h { k1 k2 k3 .. kn } divisor offset }
+ * or a blur of the given radius, which needs no kernel:
+ * { box radius } or { gaussian radius }
+ */
+static int fetch_convolution(Tcl_Interp *interp, Tcl_Obj *spec, convolution *ck)
+{
+	const char *blurs[] = { "box", "gaussian", NULL };
+	Tcl_Obj *list;
+	int i, list_len, list_val;
+
+	FETCH_LEN(spec, list_len);
+
+	if( list_len == 2 )
+		{
+			/* a blur runs a one-pixel kernel that's never read */
+			Tcl_ListObjIndex(interp, spec, 0, &list);
+			if( Tcl_GetIndexFromObj(interp, list, blurs, "blur", 0, &list_val) == TCL_ERROR )
+				return TCL_ERROR;
+			FETCH_INT_FROM(spec, 1, ck->radius);
+
+			if( ck->radius < 1 || ck->radius > MAX_BLUR_RADIUS )
+				RET_ERROR("Blur radius out of range ");
+
+			ck->mode = list_val ? CONVO_GAUSSIAN : CONVO_BOX;
+			ck->kw = ck->kh = 1;
+			ck->kernel[0] = 1;
+			ck->divisor = 1;
+			ck->offset = 0;
+			return TCL_OK;
+		}
+
+	if( list_len != 5 )
+		RET_ERROR("Convolution kernel list must contain five elements ");
+
+	ck->mode = CONVO_KERNEL;
+	ck->radius = 0;
+
+	/* first fetch the kernel width and height */
+	FETCH_INT_FROM(spec, 0, ck->kw);
+	FETCH_INT_FROM(spec, 1, ck->kh);
+	FETCH_INT_FROM(spec, 3, ck->divisor);
+	FETCH_INT_FROM(spec, 4, ck->offset);
+
+	if( ck->kw > MAX_CK_SIZE || ck->kh > MAX_CK_SIZE )
+		RET_ERROR( "Convolution kernel too large ");
+
+	/* next, the kernel sublist itself */
+	Tcl_ListObjIndex(interp, spec, 2, &list);
+	FETCH_LEN(list, list_len);
+
+	if( list_len != ck->kw * ck->kh )
+		RET_ERROR("Incorrect amount of kernel data provided ");
+
+	/* and retrieve the values */
+	for( i=0; i < list_len; i++ )
+		{
+			FETCH_INT_FROM(list, i, list_val);
+			ck->kernel[i] = (char)list_val;
+		}
+
+	return TCL_OK;
+}
+
 /* create a frame */
 static int wrap_frame_create(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[])
 {
@@ -1517,7 +1871,7 @@ static int wrap_frame_create(ClientData cData, Tcl_Interp *interp, int objc, Tcl
 	lut l;
 
 	Tcl_Obj *list;
-	int list_len, list_val;
+	int list_val;
 
 	/* frame pointer */
 	frame *frame;
@@ -1545,7 +1899,9 @@ static int wrap_frame_create(ClientData cData, Tcl_Interp *interp, int objc, Tcl
 			if( !strcmp(mode, "rgba") )
 			  {
 					HAS_ARGS(5,"type w h frame-data ");
-				  frame = frame_create(FRAME_RGBA, w, h, data, NULL);
+				  frame = adopt_frame_data(objv[4], FRAME_RGBA, w, h);
+					if( !frame )
+						frame = frame_create(FRAME_RGBA, w, h, data, NULL);
 			  }
 			else if( !strcmp(mode, "rgb") )
 			  {
@@ -1570,49 +1926,30 @@ static int wrap_frame_create(ClientData cData, Tcl_Interp *interp, int objc, Tcl
 			else if( !strcmp(mode, "ct") )
 			  {
 					HAS_ARGS(5, "type w h frame-data ");
-					frame = frame_create(FRAME_CT, w, h, data, NULL);
+					frame = adopt_frame_data(objv[4], FRAME_CT, w, h);
+					if( !frame )
+						frame = frame_create(FRAME_CT, w, h, data, NULL);
 			  }
 			else if( !strcmp(mode, "sat") )
 			  {
 					HAS_ARGS(5, "type w h frame-data ");
-					frame = frame_create(FRAME_SAT, w, h, data, NULL);
+					frame = adopt_frame_data(objv[4], FRAME_SAT, w, h);
+					if( !frame )
+						frame = frame_create(FRAME_SAT, w, h, data, NULL);
 			  }
 			else if( !strcmp(mode, "displ") )
 			  {
 					HAS_ARGS(5, "type w h displacement-data ");
-					frame = frame_create(FRAME_DISPL, w, h, (short *)data, NULL);
+					frame = adopt_frame_data(objv[4], FRAME_DISPL, w, h);
+					if( !frame )
+						frame = frame_create(FRAME_DISPL, w, h, (short *)data, NULL);
 			  }
 			else if( !strcmp(mode, "convo") )
 			  {
-					/*
-					 * retrieve the convolution-kernel data from the list thus:
-					 * { w h { k1 k2 k3 .. kn } divisor offset }
-					 */
+					/* a kernel, or a blur */
 					HAS_ARGS(6, "type w h frame-data kernel ");
-					HAS_ITEMS(objv[5], 5, "Convolution kernel list must contain five elements ");
-
-					/* first fetch the kernel width and height */
-					FETCH_INT_FROM(objv[5], 0, ck.kw);
-					FETCH_INT_FROM(objv[5], 1, ck.kh);
-					FETCH_INT_FROM(objv[5], 3, ck.divisor);
-					FETCH_INT_FROM(objv[5], 4, ck.offset);
-
-					if( ck.kw > MAX_CK_SIZE || ck.kh > MAX_CK_SIZE )
-						RET_ERROR( "Convolution kernel too large ");
-
-					/* next, the kernel sublist itself */
-					Tcl_ListObjIndex(interp, objv[5], 2, &list);
-					FETCH_LEN(list, list_len);
-
-					if( list_len != ck.kw * ck.kh )
-					  RET_ERROR("Incorrect amount of kernel data provided ");
-
-					/* and retrieve the values */
-					for( i=0; i < list_len; i++ )
-					  {
-							FETCH_INT_FROM(list, i, list_val);
-						  ck.kernel[i] = (char)list_val;
-					  }
+					if( fetch_convolution(interp, objv[5], &ck) == TCL_ERROR )
+						return TCL_ERROR;
 
 					/* at last, add the convolution kernel */
 					frame = frame_create(FRAME_CONVO, w, h, data, &ck);
@@ -1656,7 +1993,7 @@ static int wrap_frame_create(ClientData cData, Tcl_Interp *interp, int objc, Tcl
 	if( !frame )
 		RET_ERROR("Invalid frame ");
 	else
-		RET_PTR(frame);
+		RET_PTR(OBJ_FRAME, frame);
 
 }
 
@@ -1665,7 +2002,7 @@ static int wrap_frame_delete(ClientData cData, Tcl_Interp *interp, int objc, Tcl
 {
 	frame *frame;
 	HAS_ARGS(2, "frame-id ");
-	FETCH_PTR(1, frame);
+	FETCH_PTR(1, OBJ_FRAME, frame);
 	frame_delete(frame);
 	return TCL_OK;
 }
@@ -1675,8 +2012,8 @@ static int wrap_frame_copy(ClientData cData, Tcl_Interp *interp, int objc, Tcl_O
 {
 	frame *frame;
 	HAS_ARGS(2, "frame-id ");
-	FETCH_PTR(1, frame);
-	RET_PTR(frame_copy(frame));
+	FETCH_PTR(1, OBJ_FRAME, frame);
+	RET_PTR(OBJ_FRAME, frame_copy(frame));
 }
 
 /* set frame offset .. */
@@ -1685,7 +2022,7 @@ static int wrap_frame_offset(ClientData cData, Tcl_Interp *interp, int objc, Tcl
 	frame *frame;
 	int x, y;
 	HAS_ARGS(4, "frame-id x y ");
-	FETCH_PTR(1, frame);
+	FETCH_PTR(1, OBJ_FRAME, frame);
 	FETCH_INT(2, x);
 	FETCH_INT(3, y);
 	frame_set_offset(frame, x, y);
@@ -1703,7 +2040,7 @@ static int wrap_frame_mask(ClientData cData, Tcl_Interp *interp, int objc, Tcl_O
 	int len;
 
 	HAS_ARGS(3, "frame-id data ");
-	FETCH_PTR(1, frame);
+	FETCH_PTR(1, OBJ_FRAME, frame);
 	FETCH_DATA(2, len, data);
 	if( len != frame->w * frame->h )
 		RET_ERROR("Amount of pixel mask data doesn't match frame size ");
@@ -1717,8 +2054,8 @@ static int wrap_frame_mask_from(ClientData cData, Tcl_Interp *interp, int objc,
 {
 	frame *frame, *src;
 	HAS_ARGS(3, "frame-id source-id ");
-	FETCH_PTR(1, frame);
-	FETCH_PTR(2, src);
+	FETCH_PTR(1, OBJ_FRAME, frame);
+	FETCH_PTR(2, OBJ_FRAME, src);
 	frame_set_mask_from(frame, src);
 	return TCL_OK;
 }
@@ -1730,7 +2067,7 @@ static int wrap_frame_slice(ClientData cData, Tcl_Interp *interp, int objc, Tcl_
 	int x, y, w, h;
 
 	HAS_ARGS(6, "frame-id x y w h ");
-	FETCH_PTR(1, frame);
+	FETCH_PTR(1, OBJ_FRAME, frame);
 	FETCH_INT(2, x);
 	FETCH_INT(3, y);
 	FETCH_INT(4, w);
@@ -1740,7 +2077,7 @@ static int wrap_frame_slice(ClientData cData, Tcl_Interp *interp, int objc, Tcl_
 	if( !res )
 		RET_ERROR("Invalid frame ");
 	else
-		RET_PTR(res);
+		RET_PTR(OBJ_FRAME, res);
 
 }
 
@@ -1756,10 +2093,10 @@ static int wrap_frame_convert(ClientData cData, Tcl_Interp *interp, int objc, Tc
 	lut l;
 
 	Tcl_Obj *list;
-	int i, list_len, list_val;
+	int i, list_val;
 
 	HAS_ARGS_2(3, 4, "frame-id mode ?auxiliary? ");
-	FETCH_PTR(1, frame);
+	FETCH_PTR(1, OBJ_FRAME, frame);
 	FETCH_STRING(2, mode);
 
 	if( !strcmp(mode, "rgba") )
@@ -1799,35 +2136,10 @@ static int wrap_frame_convert(ClientData cData, Tcl_Interp *interp, int objc, Tc
 		}
 	else if( !strcmp(mode, "convo") )
 		{
-			/*
-			 * retrieve the convolution-kernel data from the list thus:
-			 * { w h { k1 k2 k3 .. kn } divisor offset }
-			 */
+			/* a kernel, or a blur */
 			HAS_ARGS(4, "frame-id mode kernel ");
-			HAS_ITEMS(objv[3], 5, "Convolution kernel list must contain five elements ");
-
-			/* first fetch the kernel width and height */
-			FETCH_INT_FROM(objv[3], 0, ck.kw);
-			FETCH_INT_FROM(objv[3], 1, ck.kh);
-			FETCH_INT_FROM(objv[3], 3, ck.divisor);
-			FETCH_INT_FROM(objv[3], 4, ck.offset);
-
-			if( ck.kw > MAX_CK_SIZE || ck.kh > MAX_CK_SIZE )
-				RET_ERROR( "Convolution kernel too large ");
-
-			/* next, the kernel sublist itself */
-			Tcl_ListObjIndex(interp, objv[3], 2, &list);
-			FETCH_LEN(list, list_len);
-
-			if( list_len != ck.kw * ck.kh )
-				RET_ERROR("Incorrect amount of kernel data provided ");
-
-			/* and retrieve the values */
-			for( i=0; i < list_len; i++ )
-				{
-					FETCH_INT_FROM(list, i, list_val);
-					ck.kernel[i] = (char)list_val;
-				}
+			if( fetch_convolution(interp, objv[3], &ck) == TCL_ERROR )
+				return TCL_ERROR;
 
 			/* at last, add the convolution kernel */
 			res = frame_convert(frame, FRAME_CONVO, &ck);
@@ -1869,7 +2181,7 @@ static int wrap_frame_convert(ClientData cData, Tcl_Interp *interp, int objc, Tc
 	if( !res )
 		RET_ERROR("Invalid frame or requested new type ");
 	else
-		RET_PTR(frame);
+		RET_PTR(OBJ_FRAME, frame);
 
 }
 
@@ -1886,7 +2198,7 @@ static int wrap_frame_effect(ClientData cData, Tcl_Interp *interp, int objc, Tcl
 	color c;
 
 	HAS_ENOUGH_ARGS(3, "frame-id mode ?options? ");
-	FETCH_PTR(1, frame);
+	FETCH_PTR(1, OBJ_FRAME, frame);
 	FETCH_STRING(2, mode);
 
 	if( !strcmp(mode, "dropshadow") )
@@ -1904,7 +2216,7 @@ static int wrap_frame_effect(ClientData cData, Tcl_Interp *interp, int objc, Tcl
 			FETCH_INT(8, b); c.b = (unsigned char)b;
 
 			/* and create the drop shadow */
-			RET_PTR(frame_effect(frame, FRAME_EFFECT_DROP_SHADOW, x, y, blur, &c));
+			RET_PTR(OBJ_FRAME, frame_effect(frame, FRAME_EFFECT_DROP_SHADOW, x, y, blur, &c));
 
 		}
 	else
@@ -1931,7 +2243,7 @@ static int wrap_frame_from_disk(ClientData cData, Tcl_Interp *interp, int objc,
 	if( !res )
 		RET_ERROR("Bad file ");
 	else
-		RET_PTR(res);
+		RET_PTR(OBJ_FRAME, res);
 
 }
 
@@ -1954,7 +2266,7 @@ static int wrap_frame_from_buffer(ClientData cData, Tcl_Interp *interp, int objc
 	if( !res )
 		RET_ERROR("Bad file ");
 	else
-		RET_PTR(res);
+		RET_PTR(OBJ_FRAME, res);
 
 }
 
@@ -1964,7 +2276,7 @@ static int wrap_frame_from_buffer(ClientData cData, Tcl_Interp *interp, int objc
 static int wrap_map_create(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[])
 {
 	HAS_ARGS(1, NULL);
-	RET_PTR(map_create());
+	RET_PTR(OBJ_MAP, map_create());
 }
 
 /* emptying a map .. */
@@ -1974,7 +2286,7 @@ static int wrap_map_empty(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Ob
 	int delete_tiles;
 
 	HAS_ARGS_2(2, 3, "map-id ?delete-tiles?");
-	FETCH_PTR(1, map);
+	FETCH_PTR(1, OBJ_MAP, map);
 
 	if( objc == 2 )
 		delete_tiles = 0;
@@ -1990,7 +2302,7 @@ static int wrap_map_delete(ClientData cData, Tcl_Interp *interp, int objc, Tcl_O
 {
 	map *map;
 	HAS_ARGS(2, "map-id ");
-	FETCH_PTR(1, map);
+	FETCH_PTR(1, OBJ_MAP, map);
 	map_delete(map);
 	return TCL_OK;
 }
@@ -2003,7 +2315,7 @@ static int wrap_map_size(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj
 	Tcl_Obj *res;
 
 	HAS_ARGS_2(2, 4, "map-id ?width height? ");
-	FETCH_PTR(1, map);
+	FETCH_PTR(1, OBJ_MAP, map);
 
 	if( objc == 2 )
 		{
@@ -2039,7 +2351,7 @@ static int wrap_map_tile_size(ClientData cData, Tcl_Interp *interp, int objc, Tc
 	Tcl_Obj *res;
 
 	HAS_ARGS_2(2, 4, "map-id ?tile-width tile-height? ");
-	FETCH_PTR(1, map);
+	FETCH_PTR(1, OBJ_MAP, map);
 
 	if( objc == 2 )
 		{
@@ -2075,7 +2387,7 @@ static int wrap_map_tile(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj
 	int index;
 
 	HAS_ARGS_2(3, 4, "map-id index ?tile-id? ");
-	FETCH_PTR(1, map);
+	FETCH_PTR(1, OBJ_MAP, map);
 	FETCH_INT(2, index);
 
 	if( objc == 2 )
@@ -2084,12 +2396,12 @@ static int wrap_map_tile(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj
 			if( map_get_tile(map, index, &tile) == ERR )
 				RET_ERROR("Invalid map id ");
 			else
-				RET_PTR(tile);
+				RET_PTR(OBJ_TILE, tile);
 		}
 	else
 		{
 			/* or set the tile in the map's tile index */
-			FETCH_PTR(3, tile);
+			FETCH_PTR(3, OBJ_TILE | HANDLE_NULL, tile);
 			map_set_tile(map, index, tile);
 			return TCL_OK;
 		}
@@ -2110,7 +2422,7 @@ static int wrap_map_set_data(ClientData cData, Tcl_Interp *interp, int objc, Tcl
 	int w,h;
 
 	HAS_ARGS(3, "map-id map-data ");
-	FETCH_PTR(1, map);
+	FETCH_PTR(1, OBJ_MAP, map);
 	FETCH_DATA(2, len, data);
 
 	/* check the map dimensions */
@@ -2138,7 +2450,7 @@ static int wrap_map_set_single(ClientData cData, Tcl_Interp *interp, int objc, T
 	int data;
 
 	HAS_ARGS(5, "map-id x-pos y-pos data ");
-	FETCH_PTR(1, map);
+	FETCH_PTR(1, OBJ_MAP, map);
 	FETCH_INT(2, x);
 	FETCH_INT(3, y);
 	FETCH_INT(4, data);
@@ -2154,7 +2466,7 @@ static int wrap_map_animate_tiles(ClientData cData, Tcl_Interp *interp, int objc
 {
 	map *map;
 	HAS_ARGS(2, "map-id ");
-	FETCH_PTR(1, map);
+	FETCH_PTR(1, OBJ_MAP, map);
 	map_animate_tiles(map);
 	return TCL_OK;
 }
@@ -2164,7 +2476,7 @@ static int wrap_map_reset_tiles(ClientData cData, Tcl_Interp *interp, int objc,
 {
 	map *map;
 	HAS_ARGS(2, "map-id ");
-	FETCH_PTR(1, map);
+	FETCH_PTR(1, OBJ_MAP, map);
 	map_reset_tiles(map);
 	return TCL_OK;
 }
@@ -2175,7 +2487,7 @@ static int wrap_map_reset_tiles(ClientData cData, Tcl_Interp *interp, int objc,
 static int wrap_tile_create(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[])
 {
 	HAS_ARGS(1, NULL);
-	RET_PTR(tile_create());
+	RET_PTR(OBJ_TILE, tile_create());
 }
 
 /* deleting a tile .. */
@@ -2183,7 +2495,7 @@ static int wrap_tile_delete(ClientData cData, Tcl_Interp *interp, int objc, Tcl_
 {
 	tile *tile;
 	HAS_ARGS(2, "tile-id ");
-	FETCH_PTR(1, tile);
+	FETCH_PTR(1, OBJ_TILE, tile);
 	tile_delete(tile);
 	return TCL_OK;
 }
@@ -2199,7 +2511,7 @@ static int wrap_tile_anim_type(ClientData cData, Tcl_Interp *interp, int objc, T
 	int types_idx;
 
 	HAS_ARGS_2(2, 3, "tile-id ?animation-type? ");
-	FETCH_PTR(1, tile);
+	FETCH_PTR(1, OBJ_TILE, tile);
 
 	if( objc == 2 )
 		{
@@ -2229,7 +2541,7 @@ static int wrap_tile_collides(ClientData cData, Tcl_Interp *interp, int objc, Tc
 	int modes_idx;
 
 	HAS_ARGS_2(2, 3, "tile-id ?collision-mode? ");
-	FETCH_PTR(1, tile);
+	FETCH_PTR(1, OBJ_TILE, tile);
 
 	if( objc == 2 )
 		{
@@ -2262,8 +2574,8 @@ static int wrap_tile_add_frame(ClientData cData, Tcl_Interp *interp, int objc, T
 	tile *tile;
 	frame *frame;
 	HAS_ARGS(3, "tile-id frame-id ");
-	FETCH_PTR(1, tile);
-	FETCH_PTR(2, frame);
+	FETCH_PTR(1, OBJ_TILE, tile);
+	FETCH_PTR(2, OBJ_FRAME, frame);
 	RET_INT(tile_add_frame(tile, frame));
 }
 
@@ -2286,14 +2598,14 @@ static int wrap_tile_add_frame_data(ClientData cData, Tcl_Interp *interp, int ob
 	lut l;
 
 	Tcl_Obj *list;
-	int list_len, list_val;
+	int list_val;
 
 	/* the result */
 	int res;
 
 	/* check for some args */
 	HAS_ENOUGH_ARGS(5, "tile-id type w h ?options ..? ");
-	FETCH_PTR(1, tile);
+	FETCH_PTR(1, OBJ_TILE, tile);
 	FETCH_STRING(2, mode);
 	FETCH_INT(3, w);
 	FETCH_INT(4, h);
@@ -2353,35 +2665,10 @@ static int wrap_tile_add_frame_data(ClientData cData, Tcl_Interp *interp, int ob
 			  }
 			else if( !strcmp(mode, "convo") )
 			  {
-					/*
-					 * retrieve the convolution-kernel data from the list thus:
-					 * { w h { k1 k2 k3 .. kn } divisor offset }
-					 */
+					/* a kernel, or a blur */
 					HAS_ARGS(7, "tile-id type w h frame-data kernel ");
-					HAS_ITEMS(objv[6], 5, "Convolution kernel list must contain five elements ");
-
-					/* first fetch the kernel width and height */
-					FETCH_INT_FROM(objv[6], 0, ck.kw);
-					FETCH_INT_FROM(objv[6], 1, ck.kh);
-					FETCH_INT_FROM(objv[6], 3, ck.divisor);
-					FETCH_INT_FROM(objv[6], 4, ck.offset);
-
-					if( ck.kw > MAX_CK_SIZE || ck.kh > MAX_CK_SIZE )
-						RET_ERROR( "Convolution kernel too large ");
-
-					/* next, the kernel sublist itself */
-					Tcl_ListObjIndex(interp, objv[6], 2, &list);
-					FETCH_LEN(list, list_len);
-
-					if( list_len != ck.kw * ck.kh )
-					  RET_ERROR("Incorrect amount of kernel data provided ");
-
-					/* and retrieve the values */
-					for( i=0; i < list_len; i++ )
-					  {
-							FETCH_INT_FROM(list, i, list_val);
-						  ck.kernel[i] = (char)list_val;
-					  }
+					if( fetch_convolution(interp, objv[6], &ck) == TCL_ERROR )
+						return TCL_ERROR;
 
 					/* at last, add the convolution kernel */
 					res = tile_add_frame_data(tile, FRAME_CONVO, w, h, data, &ck);
@@ -2448,7 +2735,7 @@ static int wrap_tile_pixel_mask(ClientData cData, Tcl_Interp *interp, int objc,
 	int len;
 
 	HAS_ARGS(4, "tile-id index data ");
-	FETCH_PTR(1, tile);
+	FETCH_PTR(1, OBJ_TILE, tile);
 	FETCH_INT(2, index);
 	FETCH_DATA(3, len, data);
 	tile_set_pixel_mask(tile, index, data);
@@ -2464,9 +2751,9 @@ static int wrap_tile_pixel_mask_from(ClientData cData, Tcl_Interp *interp, int o
 	frame *frame;
 
 	HAS_ARGS(4, "tile-id index frame-id ");
-	FETCH_PTR(1, tile);
+	FETCH_PTR(1, OBJ_TILE, tile);
 	FETCH_INT(2, index);
-	FETCH_PTR(3, frame);
+	FETCH_PTR(3, OBJ_FRAME, frame);
 	tile_set_pixel_mask_from(tile, index, frame);
 	return TCL_OK;
 }
@@ -2476,7 +2763,7 @@ static int wrap_tile_animate(ClientData cData, Tcl_Interp *interp, int objc, Tcl
 {
 	tile *tile;
 	HAS_ARGS(2, "tile-id ");
-	FETCH_PTR(1, tile);
+	FETCH_PTR(1, OBJ_TILE, tile);
 	tile_animate(tile);
 	return TCL_OK;
 }
@@ -2486,7 +2773,7 @@ static int wrap_tile_reset(ClientData cData, Tcl_Interp *interp, int objc, Tcl_O
 {
 	tile *tile;
 	HAS_ARGS(2, "tile-id ");
-	FETCH_PTR(1, tile);
+	FETCH_PTR(1, OBJ_TILE, tile);
 	tile_reset(tile);
 	return TCL_OK;
 }
@@ -2497,7 +2784,7 @@ static int wrap_tile_reset(ClientData cData, Tcl_Interp *interp, int objc, Tcl_O
 static int wrap_sprite_create(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[])
 {
 	HAS_ARGS(1, NULL);
-	RET_PTR(sprite_create());
+	RET_PTR(OBJ_SPRITE, sprite_create());
 }
 
 /* clone the sprite */
@@ -2505,8 +2792,8 @@ static int wrap_sprite_copy(ClientData cData, Tcl_Interp *interp, int objc, Tcl_
 {
 	sprite *sprite;
 	HAS_ARGS(2, "sprite-id ");
-	FETCH_PTR(1, sprite);
-	RET_PTR(sprite_copy(sprite));
+	FETCH_PTR(1, OBJ_SPRITE, sprite);
+	RET_PTR(OBJ_SPRITE, sprite_copy(sprite));
 }
 
 /* delete the given sprite */
@@ -2514,7 +2801,7 @@ static int wrap_sprite_delete(ClientData cData, Tcl_Interp *interp, int objc, Tc
 {
 	sprite *sprite;
 	HAS_ARGS(2, "sprite-id ");
-	FETCH_PTR(1, sprite);
+	FETCH_PTR(1, OBJ_SPRITE, sprite);
 	sprite_delete(sprite);
 	return TCL_OK;
 }
@@ -2527,7 +2814,7 @@ static int wrap_sprite_frame(ClientData cData, Tcl_Interp *interp, int objc, Tcl
 	Tcl_Obj *res;
 
 	HAS_ARGS_2(2, 3, "sprite-id ?index? ");
-	FETCH_PTR(1, sprite);
+	FETCH_PTR(1, OBJ_SPRITE, sprite);
 
 	if( objc == 2 )
 		{
@@ -2553,7 +2840,7 @@ static int wrap_sprite_z_hint(ClientData cData, Tcl_Interp *interp, int objc, Tc
 	Tcl_Obj *res;
 
 	HAS_ARGS_2(2, 3, "sprite-id ?z-hint? ");
-	FETCH_PTR(1, sprite);
+	FETCH_PTR(1, OBJ_SPRITE, sprite);
 
 	if( objc == 2 )
 		{
@@ -2580,7 +2867,7 @@ static int wrap_sprite_scale(ClientData cData, Tcl_Interp *interp, int objc, Tcl
 	Tcl_Obj *res;
 
 	HAS_ARGS_2(2, 4, "sprite-id ?x y? ");
-	FETCH_PTR(1, sprite);
+	FETCH_PTR(1, OBJ_SPRITE, sprite);
 
 	if( objc == 2 )
 		{
@@ -2605,6 +2892,58 @@ static int wrap_sprite_scale(ClientData cData, Tcl_Interp *interp, int objc, Tcl
 
 }
 
+/* filtering of the sprite's scaled rgba frames */
+static int wrap_sprite_filter(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[])
+{
+	sprite *sprite;
+	int filter;
+
+	HAS_ARGS_2(2, 3, "sprite-id ?filter? ");
+	FETCH_PTR(1, OBJ_SPRITE, sprite);
+
+	if( objc == 2 )
+		{
+			if( sprite_get_filter(sprite, &filter) == ERR )
+				RET_ERROR("Invalid sprite id ");
+			else
+				RET_INT(filter);
+		}
+	else
+		{
+			FETCH_BOOL(2, filter);
+			sprite_set_filter(sprite, filter);
+			return TCL_OK;
+		}
+
+}
+
+/* the angle the sprite's turned, in degrees */
+static int wrap_sprite_angle(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[])
+{
+	sprite *sprite;
+	int angle;
+	double angle_float;
+
+	HAS_ARGS_2(2, 3, "sprite-id ?degrees? ");
+	FETCH_PTR(1, OBJ_SPRITE, sprite);
+
+	if( objc == 2 )
+		{
+			if( sprite_get_angle(sprite, &angle) == ERR )
+				RET_ERROR("Invalid sprite id ");
+
+			Tcl_SetObjResult(interp, Tcl_NewDoubleObj((double)angle / 65536));
+			return TCL_OK;
+		}
+	else
+		{
+			FETCH_FLOAT(2, angle_float);
+			sprite_set_angle(sprite, (int)(angle_float * 65536));
+			return TCL_OK;
+		}
+
+}
+
 /* the sprite's collision mode */
 static int wrap_sprite_collides(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[])
 {
@@ -2616,7 +2955,7 @@ static int wrap_sprite_collides(ClientData cData, Tcl_Interp *interp, int objc,
 	int modes_idx;
 
 	HAS_ARGS_2(2, 3, "sprite-id ?collision-mode? ");
-	FETCH_PTR(1, sprite);
+	FETCH_PTR(1, OBJ_SPRITE, sprite);
 
 	if( objc == 2 )
 		{
@@ -2650,7 +2989,7 @@ static int wrap_sprite_bounding_box(ClientData cData, Tcl_Interp *interp, int ob
 	int index;
 	box b;
 	HAS_ARGS(7, "sprite-id index x1 y1 x2 y2 ");
-	FETCH_PTR(1, sprite);
+	FETCH_PTR(1, OBJ_SPRITE, sprite);
 	FETCH_INT(2, index);
 	FETCH_INT(3, b.x1);
 	FETCH_INT(4, b.y1);
@@ -2672,7 +3011,7 @@ static int wrap_sprite_pixel_mask(ClientData cData, Tcl_Interp *interp, int objc
 	int len;
 
 	HAS_ARGS(4, "sprite-id index data ");
-	FETCH_PTR(1, sprite);
+	FETCH_PTR(1, OBJ_SPRITE, sprite);
 	FETCH_INT(2, index);
 	FETCH_DATA(3, len, data);
 	sprite_set_pixel_mask(sprite, index, data);
@@ -2688,9 +3027,9 @@ static int wrap_sprite_pixel_mask_from(ClientData cData, Tcl_Interp *interp, int
 	frame *frame;
 
 	HAS_ARGS(4, "sprite-id index frame-id ");
-	FETCH_PTR(1, sprite);
+	FETCH_PTR(1, OBJ_SPRITE, sprite);
 	FETCH_INT(2, index);
-	FETCH_PTR(3, frame);
+	FETCH_PTR(3, OBJ_FRAME, frame);
 	sprite_set_pixel_mask_from(sprite, index, frame);
 	return TCL_OK;
 }
@@ -2704,7 +3043,7 @@ static int wrap_sprite_position(ClientData cData, Tcl_Interp *interp, int objc,
 
 	/* if there are only two args (command name, sprite id), they're requesting the position */
 	HAS_ARGS_2(2, 4, "sprite-id ?x y? ");
-	FETCH_PTR(1, sprite);
+	FETCH_PTR(1, OBJ_SPRITE, sprite);
 
 	if( objc == 2 )
 		{
@@ -2741,7 +3080,7 @@ static int wrap_sprite_velocity(ClientData cData, Tcl_Interp *interp, int objc,
 
 	/* if there are only two args (command name, sprite id), they're requesting the velocity */
 	HAS_ARGS_2(2, 4, "sprite-id ?x y? ");
-	FETCH_PTR(1, sprite);
+	FETCH_PTR(1, OBJ_SPRITE, sprite);
 
 	if( objc == 2 )
 		{
@@ -2769,14 +3108,242 @@ static int wrap_sprite_velocity(ClientData cData, Tcl_Interp *interp, int objc,
 	return TCL_OK;
 }
 
+/*
+ * the batched sprite commands take a Tcl list of sprites, and read or
+ * write flat lists of values, so a whole layer of sprites costs one
+ * command rather than one per sprite and field.
+ */
+
+/* get or set a pair of values, e.g. the position, for many sprites */
+static int sprite_pairs(Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[], int (*get)(sprite *, int *, int *), void (*set)(sprite *, int, int))
+{
+	Tcl_Obj **sprites, **vals, *res;
+	int i, ct, val_ct, x, y, *pairs;
+	void *s, **targets;
+
+	HAS_ARGS_2(2, 3, "sprite-list ?value-list? ");
+	if( Tcl_ListObjGetElements(interp, objv[1], &ct, &sprites) == TCL_ERROR )
+		return TCL_ERROR;
+
+	/* reading:  { x y x y .. } */
+	if( objc == 2 )
+		{
+			res = Tcl_NewListObj(0, NULL);
+			for( i=0; i < ct; i++ )
+				{
+					if( get_handle(interp, sprites[i], OBJ_SPRITE, &s) == TCL_ERROR || get(s, &x, &y) == ERR )
+						{
+							Tcl_DecrRefCount(res);
+							RET_ERROR("Invalid sprite id ");
+						}
+					APPEND_INT(res, x);
+					APPEND_INT(res, y);
+				}
+
+			Tcl_SetObjResult(interp, res);
+			return TCL_OK;
+		}
+
+	/* writing */
+	if( Tcl_ListObjGetElements(interp, objv[2], &val_ct, &vals) == TCL_ERROR )
+		return TCL_ERROR;
+	if( val_ct != ct * 2 )
+		RET_ERROR("Need two values for each sprite ");
+
+	if( ct == 0 )
+		return TCL_OK;
+
+	/* check every sprite and value before touching any, so a bad entry leaves them all as they were */
+	targets = (void **) Tcl_Alloc(ct * sizeof(void *));
+	pairs = (int *) Tcl_Alloc(ct * 2 * sizeof(int));
+	for( i=0; i < ct; i++ )
+		if( get_handle(interp, sprites[i], OBJ_SPRITE, &targets[i]) == TCL_ERROR ||
+		    Tcl_GetIntFromObj(interp, vals[i*2], &pairs[i*2]) == TCL_ERROR ||
+		    Tcl_GetIntFromObj(interp, vals[i*2+1], &pairs[i*2+1]) == TCL_ERROR )
+			{
+				Tcl_Free((char *) targets);
+				Tcl_Free((char *) pairs);
+				return TCL_ERROR;
+			}
+
+	for( i=0; i < ct; i++ )
+		set(targets[i], pairs[i*2], pairs[i*2+1]);
+
+	Tcl_Free((char *) targets);
+	Tcl_Free((char *) pairs);
+	return TCL_OK;
+}
+
+/* the positions of many sprites:  { x y x y .. } */
+static int wrap_sprite_positions(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[])
+{
+	return sprite_pairs(interp, objc, objv, sprite_get_position, sprite_set_position);
+}
+
+/* the velocities of many sprites:  { x y x y .. } */
+static int wrap_sprite_velocities(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[])
+{
+	return sprite_pairs(interp, objc, objv, sprite_get_velocity, sprite_set_velocity);
+}
+
+/* the current frames of many sprites */
+static int wrap_sprite_frames(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[])
+{
+	Tcl_Obj **sprites, **vals, *res;
+	int i, ct, val_ct, index, *indices;
+	void *s, **targets;
+
+	HAS_ARGS_2(2, 3, "sprite-list ?index-list? ");
+	if( Tcl_ListObjGetElements(interp, objv[1], &ct, &sprites) == TCL_ERROR )
+		return TCL_ERROR;
+
+	if( objc == 2 )
+		{
+			res = Tcl_NewListObj(0, NULL);
+			for( i=0; i < ct; i++ )
+				{
+					if( get_handle(interp, sprites[i], OBJ_SPRITE, &s) == TCL_ERROR || sprite_get_frame(s, &index) == ERR )
+						{
+							Tcl_DecrRefCount(res);
+							RET_ERROR("Invalid sprite id ");
+						}
+					APPEND_INT(res, index);
+				}
+
+			Tcl_SetObjResult(interp, res);
+			return TCL_OK;
+		}
+
+	if( Tcl_ListObjGetElements(interp, objv[2], &val_ct, &vals) == TCL_ERROR )
+		return TCL_ERROR;
+	if( val_ct != ct )
+		RET_ERROR("Need one frame index for each sprite ");
+
+	if( ct == 0 )
+		return TCL_OK;
+
+	/* as with sprite_pairs, nothing changes unless the whole list is good */
+	targets = (void **) Tcl_Alloc(ct * sizeof(void *));
+	indices = (int *) Tcl_Alloc(ct * sizeof(int));
+	for( i=0; i < ct; i++ )
+		if( get_handle(interp, sprites[i], OBJ_SPRITE, &targets[i]) == TCL_ERROR || Tcl_GetIntFromObj(interp, vals[i], &indices[i]) == TCL_ERROR )
+			{
+				Tcl_Free((char *) targets);
+				Tcl_Free((char *) indices);
+				return TCL_ERROR;
+			}
+
+	for( i=0; i < ct; i++ )
+		sprite_set_frame(targets[i], indices[i]);
+
+	Tcl_Free((char *) targets);
+	Tcl_Free((char *) indices);
+	return TCL_OK;
+}
+
+/* everything the main loop reads back, for many sprites:  { x y vel.x vel.y frame .. } */
+static int wrap_sprite_states(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[])
+{
+	Tcl_Obj **sprites, *res;
+	int i, ct, x, y, vx, vy, index;
+	void *s;
+
+	HAS_ARGS(2, "sprite-list ");
+	if( Tcl_ListObjGetElements(interp, objv[1], &ct, &sprites) == TCL_ERROR )
+		return TCL_ERROR;
+
+	res = Tcl_NewListObj(0, NULL);
+	for( i=0; i < ct; i++ )
+		{
+			if( get_handle(interp, sprites[i], OBJ_SPRITE, &s) == TCL_ERROR || sprite_get_position(s, &x, &y) == ERR )
+				{
+					Tcl_DecrRefCount(res);
+					RET_ERROR("Invalid sprite id ");
+				}
+			sprite_get_velocity(s, &vx, &vy);
+			sprite_get_frame(s, &index);
+
+			APPEND_INT(res, x);
+			APPEND_INT(res, y);
+			APPEND_INT(res, vx);
+			APPEND_INT(res, vy);
+			APPEND_INT(res, index);
+		}
+
+	Tcl_SetObjResult(interp, res);
+	return TCL_OK;
+}
+
+/* get or set the command br::dispatch runs for the sprite */
+static int wrap_sprite_callback(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[])
+{
+	sprite *sprite;
+	Tcl_HashEntry *entry;
+	struct sprite_callback *cb;
+	int len, is_new;
+
+	HAS_ARGS_2(2, 3, "sprite-id ?command? ");
+	FETCH_PTR(1, OBJ_SPRITE, sprite);
+
+	if( objc == 2 )
+		{
+			entry = Tcl_FindHashEntry(&callbacks, (char *) sprite);
+			if( entry )
+				{
+					cb = (struct sprite_callback *) Tcl_GetHashValue(entry);
+					Tcl_SetObjResult(interp, cb->cmd);
+				}
+			return TCL_OK;
+		}
+
+	if( Tcl_ListObjLength(interp, objv[2], &len) == TCL_ERROR )
+		return TCL_ERROR;
+	if( len >= DISPATCH_WORDS )
+		RET_ERROR("Callback command has too many words ");
+
+	/* an empty command just removes the callback */
+	forget_callback(sprite);
+	if( !len )
+		return TCL_OK;
+
+	/* keep a private copy, so the command stays a parsed list */
+	cb = (struct sprite_callback *) Tcl_Alloc(sizeof(struct sprite_callback));
+	cb->cmd = Tcl_DuplicateObj(objv[2]);
+	cb->id = new_handle(OBJ_SPRITE, sprite);
+	cb->gen = ++callback_gen;
+	Tcl_IncrRefCount(cb->cmd);
+	Tcl_IncrRefCount(cb->id);
+
+	entry = Tcl_CreateHashEntry(&callbacks, (char *) sprite, &is_new);
+	Tcl_SetHashValue(entry, cb);
+	return TCL_OK;
+}
+
+/* drop a sprite's callback, if it has one */
+static void forget_callback(void *ptr)
+{
+	Tcl_HashEntry *entry;
+	struct sprite_callback *cb;
+
+	entry = Tcl_FindHashEntry(&callbacks, (char *) ptr);
+	if( !entry )
+		return;
+
+	cb = (struct sprite_callback *) Tcl_GetHashValue(entry);
+	Tcl_DeleteHashEntry(entry);
+	Tcl_DecrRefCount(cb->cmd);
+	Tcl_DecrRefCount(cb->id);
+	Tcl_Free((char *) cb);
+}
+
 /* set a sprite frame .. */
 static int wrap_sprite_add_frame(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[])
 {
 	sprite *sprite;
 	frame *frame;
 	HAS_ARGS(3, "sprite-id frame-id ");
-	FETCH_PTR(1, sprite);
-	FETCH_PTR(2, frame);
+	FETCH_PTR(1, OBJ_SPRITE, sprite);
+	FETCH_PTR(2, OBJ_FRAME, frame);
 	RET_INT(sprite_add_frame(sprite, frame));
 }
 
@@ -2799,14 +3366,15 @@ static int wrap_sprite_add_frame_data(ClientData cData, Tcl_Interp *interp, int
 	lut l;
 
 	Tcl_Obj *list;
-	int list_len, list_val;
+	int list_val;
 
-	/* the result */
+	/* the result, and any frame made around the bytearray */
 	int res;
+	frame *frame;
 
 	/* check for some args */
 	HAS_ENOUGH_ARGS(5, "sprite-id type w h ?options ..? ");
-	FETCH_PTR(1, sprite);
+	FETCH_PTR(1, OBJ_SPRITE, sprite);
 	FETCH_STRING(2, mode);
 	FETCH_INT(3, w);
 	FETCH_INT(4, h);
@@ -2827,7 +3395,8 @@ static int wrap_sprite_add_frame_data(ClientData cData, Tcl_Interp *interp, int
 			if( !strcmp(mode, "rgba") )
 			  {
 					HAS_ARGS(6, "sprite-id type w h frame-data ");
-				  res = sprite_add_frame_data(sprite, FRAME_RGBA, w, h, data, NULL);
+				  frame = adopt_frame_data(objv[5], FRAME_RGBA, w, h);
+					res = frame ? sprite_add_frame(sprite, frame) : sprite_add_frame_data(sprite, FRAME_RGBA, w, h, data, NULL);
 			  }
 			else if( !strcmp(mode, "rgb") )
 			  {
@@ -2852,49 +3421,27 @@ static int wrap_sprite_add_frame_data(ClientData cData, Tcl_Interp *interp, int
 			else if( !strcmp(mode, "ct") )
 			  {
 					HAS_ARGS(6, "sprite-id type w h frame-data ");
-					res = sprite_add_frame_data(sprite, FRAME_CT, w, h, data, NULL);
+					frame = adopt_frame_data(objv[5], FRAME_CT, w, h);
+					res = frame ? sprite_add_frame(sprite, frame) : sprite_add_frame_data(sprite, FRAME_CT, w, h, data, NULL);
 			  }
 			else if( !strcmp(mode, "sat") )
 			  {
 					HAS_ARGS(6, "sprite-id type w h frame-data ");
-					res = sprite_add_frame_data(sprite, FRAME_SAT, w, h, data, NULL);
+					frame = adopt_frame_data(objv[5], FRAME_SAT, w, h);
+					res = frame ? sprite_add_frame(sprite, frame) : sprite_add_frame_data(sprite, FRAME_SAT, w, h, data, NULL);
 			  }
 			else if( !strcmp(mode, "displ") )
 			  {
 					HAS_ARGS(6, "sprite-id type w h displacement-data ");
-					res = sprite_add_frame_data(sprite, FRAME_DISPL, w, h, (short *)data, NULL);
+					frame = adopt_frame_data(objv[5], FRAME_DISPL, w, h);
+					res = frame ? sprite_add_frame(sprite, frame) : sprite_add_frame_data(sprite, FRAME_DISPL, w, h, (short *)data, NULL);
 			  }
 			else if( !strcmp(mode, "convo") )
 			  {
-					/*
-					 * retrieve the convolution-kernel data from the list thus:
-					 * { w h { k1 k2 k3 .. kn } divisor offset }
-					 */
+					/* a kernel, or a blur */
 					HAS_ARGS(7, "sprite-id type w h frame-data kernel ");
-					HAS_ITEMS(objv[6], 5, "Convolution kernel list must contain five elements ");
-
-					/* first fetch the kernel width and height */
-					FETCH_INT_FROM(objv[6], 0, ck.kw);
-					FETCH_INT_FROM(objv[6], 1, ck.kh);
-					FETCH_INT_FROM(objv[6], 3, ck.divisor);
-					FETCH_INT_FROM(objv[6], 4, ck.offset);
-
-					if( ck.kw > MAX_CK_SIZE || ck.kh > MAX_CK_SIZE )
-						RET_ERROR( "Convolution kernel too large ");
-
-					/* next, the kernel sublist itself */
-					Tcl_ListObjIndex(interp, objv[6], 2, &list);
-					FETCH_LEN(list, list_len);
-
-					if( list_len != ck.kw * ck.kh )
-					  RET_ERROR("Incorrect amount of kernel data provided ");
-
-					/* and retrieve the values */
-					for( i=0; i < list_len; i++ )
-					  {
-							FETCH_INT_FROM(list, i, list_val);
-						  ck.kernel[i] = (char)list_val;
-					  }
+					if( fetch_convolution(interp, objv[6], &ck) == TCL_ERROR )
+						return TCL_ERROR;
 
 					/* at last, add the convolution kernel */
 					res = sprite_add_frame_data(sprite, FRAME_CONVO, w, h, data, &ck);
@@ -2956,9 +3503,9 @@ static int wrap_sprite_add_subframe(ClientData cData, Tcl_Interp *interp, int ob
 	int index;
 	frame *frame;
 	HAS_ARGS(4, "sprite-id index frame-id ");
-	FETCH_PTR(1, sprite);
+	FETCH_PTR(1, OBJ_SPRITE, sprite);
 	FETCH_INT(2, index);
-	FETCH_PTR(3, frame);
+	FETCH_PTR(3, OBJ_FRAME, frame);
 	RET_INT(sprite_add_subframe(sprite, index, frame));
 }
 
@@ -2975,7 +3522,7 @@ static int wrap_sprite_load_program(ClientData cData, Tcl_Interp *interp, int ob
 	int res;
 
 	HAS_ARGS(3, "sprite-id mcp ");
-	FETCH_PTR(1, sprite);
+	FETCH_PTR(1, OBJ_SPRITE, sprite);
 	FETCH_STRING(2, mcp);
 
 	/* load the program */
@@ -3007,7 +3554,7 @@ static int wrap_sprite_load_program(ClientData cData, Tcl_Interp *interp, int ob
 static int wrap_string_create(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[])
 {
 	HAS_ARGS(1, NULL);
-	RET_PTR(string_create());
+	RET_PTR(OBJ_STRING, string_create());
 }
 
 /* delete a string */
@@ -3015,7 +3562,7 @@ static int wrap_string_delete(ClientData cData, Tcl_Interp *interp, int objc, Tc
 {
 	string *string;
 	HAS_ARGS(2, "string-id ");
-	FETCH_PTR(1, string);
+	FETCH_PTR(1, OBJ_STRING, string);
 	string_delete(string);
 	return TCL_OK;
 }
@@ -3028,7 +3575,7 @@ static int wrap_string_box(ClientData cData, Tcl_Interp *interp, int objc, Tcl_O
 	Tcl_Obj *res;
 
 	HAS_ARGS(2, "string-id ");
-	FETCH_PTR(1, string);
+	FETCH_PTR(1, OBJ_STRING, string);
 
 	if( string_get_box(string, &w, &h) == ERR )
 		RET_ERROR("Invalid string id ");
@@ -3050,7 +3597,7 @@ static int wrap_string_font(ClientData cData, Tcl_Interp *interp, int objc, Tcl_
 	string *string;
 	char *name;
 	HAS_ARGS(3, "string-id font-name ");
-	FETCH_PTR(1, string);
+	FETCH_PTR(1, OBJ_STRING, string);
 	FETCH_STRING(2, name);
 	string_set_font(string, name);
 	return TCL_OK;
@@ -3062,7 +3609,7 @@ static int wrap_string_position(ClientData cData, Tcl_Interp *interp, int objc,
 	string *string;
 	int x,y;
 	HAS_ARGS(4, "string-id x y ");
-	FETCH_PTR(1, string);
+	FETCH_PTR(1, OBJ_STRING, string);
 	FETCH_INT(2, x);
 	FETCH_INT(3, y);
 	string_set_position(string, x, y);
@@ -3075,7 +3622,7 @@ static int wrap_string_text(ClientData cData, Tcl_Interp *interp, int objc, Tcl_
 	string *string;
 	char *text;
 	HAS_ARGS(3, "string-id text ");
-	FETCH_PTR(1, string);
+	FETCH_PTR(1, OBJ_STRING, string);
 	FETCH_STRING(2, text);
 	string_set_text(string, text);
 	return TCL_OK;
@@ -3102,9 +3649,9 @@ static int wrap_inspect_adjacent_tiles(ClientData cData, Tcl_Interp *interp, int
 	int i;
 
 	HAS_ARGS(4, "sprite-id direction map-id ");
-	FETCH_PTR(1, sprite);
+	FETCH_PTR(1, OBJ_SPRITE, sprite);
 	FETCH_INDEXED(2, dirs, "direction", TCL_EXACT, dir_idx);
-	FETCH_PTR(3, map);
+	FETCH_PTR(3, OBJ_MAP, map);
 
 	/* call the c function */
 	inspect_adjacent_tiles(map, sprite, dir_vals[dir_idx], &res);
@@ -3140,8 +3687,8 @@ static int wrap_inspect_obscured_tiles(ClientData cData, Tcl_Interp *interp, int
 
 
 	HAS_ARGS(3, "sprite-id map-id ");
-	FETCH_PTR(1, sprite);
-	FETCH_PTR(2, map);
+	FETCH_PTR(1, OBJ_SPRITE, sprite);
+	FETCH_PTR(2, OBJ_MAP, map);
 
 	/* call the c function */
 	inspect_obscured_tiles(map, sprite, &res);
@@ -3181,12 +3728,12 @@ static int wrap_inspect_line_of_sight(ClientData cData, Tcl_Interp *interp, int
 	int xofs, yofs, dist;
 
 	HAS_ARGS(7, "sprite-id x-ofs y-ofs dist target-id map-id ");
-	FETCH_PTR(1, sprite);
+	FETCH_PTR(1, OBJ_SPRITE, sprite);
 	FETCH_INT(2, xofs);
 	FETCH_INT(3, yofs);
 	FETCH_INT(4, dist);
-	FETCH_PTR(5, target);
-	FETCH_PTR(6, map);
+	FETCH_PTR(5, OBJ_SPRITE, target);
+	FETCH_PTR(6, OBJ_MAP, map);
 	RET_INT(inspect_line_of_sight(map, sprite, xofs, yofs, dist, target));
 }
 
@@ -3203,7 +3750,7 @@ static int wrap_inspect_in_frame(ClientData cData, Tcl_Interp *interp, int objc,
 	Tcl_Obj *tcl_result;
 
 	HAS_ARGS(6, "list-id x1 y1 x2 y2 ");
-	FETCH_PTR(1, l);
+	FETCH_PTR(1, OBJ_LIST, l);
 	FETCH_INT(2, range.x1);
 	FETCH_INT(3, range.y1);
 	FETCH_INT(4, range.x2);
@@ -3217,7 +3764,7 @@ static int wrap_inspect_in_frame(ClientData cData, Tcl_Interp *interp, int objc,
 	iterator_start(iter, res);
 	while( iterator_data(iter) )
 		{
-			APPEND_PTR(tcl_result, iterator_data(iter));
+			APPEND_PTR(tcl_result, OBJ_SPRITE, iterator_data(iter));
 			iterator_next(iter);
 		}
 
@@ -3243,7 +3790,7 @@ static int wrap_inspect_near_point(ClientData cData, Tcl_Interp *interp, int obj
 	Tcl_Obj *tcl_result;
 
 	HAS_ARGS(5, "list-id x y dist ");
-	FETCH_PTR(1, l);
+	FETCH_PTR(1, OBJ_LIST, l);
 	FETCH_INT(2, x);
 	FETCH_INT(3, y);
 	FETCH_INT(4, dist);
@@ -3258,7 +3805,7 @@ static int wrap_inspect_near_point(ClientData cData, Tcl_Interp *interp, int obj
 	iterator_start(iter, res);
 	while( iterator_data(iter) )
 		{
-			APPEND_PTR(tcl_result, iterator_data(iter));
+			APPEND_PTR(tcl_result, OBJ_SPRITE, iterator_data(iter));
 			iterator_next(iter);
 		}
 
@@ -3287,8 +3834,8 @@ static int wrap_collision_map(ClientData cData, Tcl_Interp *interp, int objc, Tc
 	Tcl_Obj *tcl_result;
 
 	HAS_ARGS_2(3, 4, "sprite-id map-id ?slip? ");
-	FETCH_PTR(1, sprite);
-	FETCH_PTR(2, map);
+	FETCH_PTR(1, OBJ_SPRITE, sprite);
+	FETCH_PTR(2, OBJ_MAP, map);
 	if( objc == 4 )
 		FETCH_INT(3, slip);
 	else
@@ -3309,6 +3856,45 @@ static int wrap_collision_map(ClientData cData, Tcl_Interp *interp, int objc, Tc
 
 }
 
+/* check many sprites against a map: { mode stop.x stop.y go.x go.y .. } */
+static int wrap_collision_map_all(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[])
+{
+	Tcl_Obj **sprites, *tcl_result;
+	map *map;
+	int i, ct, slip;
+	map_collision res;
+	void *s;
+
+	HAS_ARGS_2(3, 4, "sprite-list map-id ?slip? ");
+	if( Tcl_ListObjGetElements(interp, objv[1], &ct, &sprites) == TCL_ERROR )
+		return TCL_ERROR;
+	FETCH_PTR(2, OBJ_MAP, map);
+	if( objc == 4 )
+		FETCH_INT(3, slip);
+	else
+		slip = 0;
+
+	tcl_result = Tcl_NewListObj(0, NULL);
+	for( i=0; i < ct; i++ )
+		{
+			if( get_handle(interp, sprites[i], OBJ_SPRITE, &s) == TCL_ERROR )
+				{
+					Tcl_DecrRefCount(tcl_result);
+					return TCL_ERROR;
+				}
+
+			collision_with_map(s, map, slip, &res);
+			APPEND_INT(tcl_result, res.mode);
+			APPEND_INT(tcl_result, res.stop.x);
+			APPEND_INT(tcl_result, res.stop.y);
+			APPEND_INT(tcl_result, res.go.x);
+			APPEND_INT(tcl_result, res.go.y);
+		}
+
+	Tcl_SetObjResult(interp, tcl_result);
+	return TCL_OK;
+}
+
 /* find sprite collisions: { { target mode dir.x dir.y stop.x stop.y } .. } */
 static int wrap_collision_sprites(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[])
 {
@@ -3322,8 +3908,8 @@ static int wrap_collision_sprites(ClientData cData, Tcl_Interp *interp, int objc
 	Tcl_Obj *res, *tcl_result;
 
 	HAS_ARGS(3, "sprite-id list-id ");
-	FETCH_PTR(1, sprite);
-	FETCH_PTR(2, l);
+	FETCH_PTR(1, OBJ_SPRITE, sprite);
+	FETCH_PTR(2, OBJ_LIST, l);
 
 	/* call the c function */
 	ct = collision_with_sprites(sprite, l, MAX_SPRITE_COLLISIONS, cols);
@@ -3335,7 +3921,7 @@ static int wrap_collision_sprites(ClientData cData, Tcl_Interp *interp, int objc
 			/* build the list of result vectors and the target */
 			res = Tcl_NewListObj(0, NULL);
 			APPEND_INT(res, cols[i].mode);
-			APPEND_PTR(res, cols[i].target);
+			APPEND_PTR(res, OBJ_SPRITE, cols[i].target);
 			APPEND_INT(res, cols[i].dir.x);
 			APPEND_INT(res, cols[i].dir.y);
 			APPEND_INT(res, cols[i].stop.x);
@@ -3361,7 +3947,7 @@ static int wrap_motion_list(ClientData cData, Tcl_Interp *interp, int objc, Tcl_
 	int res;
 
 	HAS_ARGS(2, "list-id ");
-	FETCH_PTR(1, l);
+	FETCH_PTR(1, OBJ_LIST, l);
 
 	/* walk a list, running each sprite's motion-control code */
 	res = motion_exec_list(l);
@@ -3392,7 +3978,7 @@ static int wrap_motion_single(ClientData cData, Tcl_Interp *interp, int objc, Tc
 	int res;
 
 	HAS_ARGS(2, "sprite-id ");
-	FETCH_PTR(1, sprite);
+	FETCH_PTR(1, OBJ_SPRITE, sprite);
 
 	/* run one sprite's motion-control code */
 	res = motion_exec_single(sprite);
@@ -3429,3 +4015,548 @@ static int wrap_clock_wait(ClientData cData, Tcl_Interp *interp, int objc, Tcl_O
 	FETCH_INT(1, fps);
 	RET_INT(clock_wait(fps));
 }
+
+/* frame-pacing statistics:  { mean p99 worst missed frames }, times in milliseconds */
+static int wrap_clock_stats(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[])
+{
+	frame_timing t;
+	Tcl_Obj *res;
+
+	HAS_ARGS(1, NULL);
+	clock_get_stats(&t);
+
+	/* and return a Tcl-list */
+	res = Tcl_NewObj();
+	APPEND_FLOAT(res, (double)t.mean / 1000);
+	APPEND_FLOAT(res, (double)t.p99 / 1000);
+	APPEND_FLOAT(res, (double)t.worst / 1000);
+	APPEND_INT(res, t.missed);
+	APPEND_INT(res, t.frames);
+	Tcl_SetObjResult(interp, res);
+	return TCL_OK;
+}
+
+/* forget the frame-pacing statistics */
+static int wrap_clock_reset_stats(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[])
+{
+	HAS_ARGS(1, NULL);
+	clock_reset_stats();
+	return TCL_OK;
+}
+
+
+
+/* switch the frame profiler on or off */
+static int wrap_stats_enabled(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[])
+{
+	int on;
+
+	HAS_ARGS_2(1, 2, "?enabled? ");
+
+	/* reading or setting? */
+	if( objc == 1 )
+		RET_INT(stats_get_enabled());
+	else
+		{
+			FETCH_BOOL(1, on);
+			stats_set_enabled(on);
+			return TCL_OK;
+		}
+
+}
+
+/* read the frame profiler figures, as a name-value list */
+static int wrap_stats_get(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[])
+{
+	/* which figures, and the names of the phases and counters */
+	const char *modes[] = { "last", "mean", "peak", NULL };
+	int mode_vals[] = { STATS_LAST, STATS_MEAN, STATS_PEAK };
+	const char *phases[] = { "bg", "map", "sort", "sprites", "strings", "present", "motion", "collision", "wait", "other" };
+	const char *counters[] = { "tiles", "sprites-drawn", "sprites-culled", "pixels", "collision-tests", "frames-fused" };
+	int mode_idx, i;
+
+	frame_stats st;
+	Tcl_Obj *res;
+
+	HAS_ARGS_2(1, 2, "?last|mean|peak? ");
+	if( objc == 2 )
+		FETCH_INDEXED(1, modes, "mode", 0, mode_idx);
+	else
+		mode_idx = 1;
+
+	stats_get(mode_vals[mode_idx], &st);
+
+	/* times are returned in milliseconds */
+	res = Tcl_NewObj();
+	APPEND_STG(res, "frames");
+	APPEND_INT(res, st.frames);
+	for( i=0; i < STATS_PHASES; i++ )
+		{
+			APPEND_STG(res, phases[i]);
+			APPEND_FLOAT(res, (double)st.time[i] / 1000);
+		}
+	for( i=0; i < STATS_COUNTERS; i++ )
+		{
+			APPEND_STG(res, counters[i]);
+			APPEND_INT(res, st.count[i]);
+		}
+
+	Tcl_SetObjResult(interp, res);
+	return TCL_OK;
+}
+
+/* clear the frame profiler */
+static int wrap_stats_reset(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[])
+{
+	HAS_ARGS(1, NULL);
+	stats_reset();
+	return TCL_OK;
+}
+
+
+
+/* decode embedded asset data:  any of base64, lz77 and bxdiv, in one pass */
+static int wrap_decode(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[])
+{
+	char *stage;
+	unsigned char *data, *res;
+	int stage_len, len, res_len;
+	int i, list_len, flags;
+
+	HAS_ARGS(3, "stages data ");
+
+	/* which stages?  they always run base64, then lz77, then bxdiv */
+	flags = 0;
+	FETCH_LEN(objv[1], list_len);
+	for( i=0; i < list_len; i++ )
+		{
+			FETCH_STRING_FROM(objv[1], i, stage, stage_len);
+
+			if( !strcmp(stage, "base64") )
+				flags |= DECODE_BASE64;
+			else if( !strcmp(stage, "lz77") )
+				flags |= DECODE_LZ77;
+			else if( !strcmp(stage, "bxdiv") )
+				flags |= DECODE_BXDIV;
+			else
+				RET_ERROR("Unknown decoding stage ");
+		}
+
+	FETCH_DATA(2, len, data);
+
+	res = decode_buffer(flags, len, data, &res_len);
+	if( !res )
+		RET_ERROR("Malformed data ");
+
+	Tcl_SetObjResult(interp, Tcl_NewByteArrayObj(res, res_len));
+	free(res);
+	return TCL_OK;
+}
+
+
+
+/* the asset types br::load understands, and how each one is loaded */
+static const char *load_types[] = { "frame", "masked-frame", "sound", "song", (char *) NULL };
+static const int load_type_ids[] = { LOAD_FRAME, LOAD_FRAME, LOAD_SOUND, LOAD_SONG };
+static const int load_type_args[] = { 0, LOAD_MASK, 0, 0 };
+
+/*
+ * run a br::load callback script, with the job id and the asset
+ * appended.  it runs from inside whatever command polled the loader,
+ * e.g. br::render display, so that command's result is kept aside and
+ * errors are left to bgerror.
+ */
+static void load_callback(int id, int type, void *result, void *data)
+{
+	struct load_script *cb = data;
+	Tcl_Interp *interp = cb->interp;
+	Tcl_InterpState state;
+	Tcl_Obj *cmd;
+
+	/* the engine's shutting down, so just let go of the script */
+	if( type == LOAD_DROPPED )
+		{
+			Tcl_DecrRefCount(cb->script);
+			Tcl_Free((char *) cb);
+			return;
+		}
+
+	cmd = Tcl_DuplicateObj(cb->script);
+	Tcl_IncrRefCount(cmd);
+	Tcl_ListObjAppendElement(interp, cmd, Tcl_NewIntObj(id));
+
+	/* frames and sounds pass back their id, songs just start playing */
+	if( !result )
+		Tcl_ListObjAppendElement(interp, cmd, Tcl_NewObj());
+	else if( type == LOAD_SONG )
+		Tcl_ListObjAppendElement(interp, cmd, Tcl_NewIntObj(1));
+	else
+		Tcl_ListObjAppendElement(interp, cmd, new_handle(type == LOAD_FRAME ? OBJ_FRAME : OBJ_SOUND, result));
+
+	state = Tcl_SaveInterpState(interp, TCL_OK);
+	if( Tcl_EvalObjEx(interp, cmd, TCL_EVAL_GLOBAL) == TCL_ERROR )
+		Tcl_BackgroundError(interp);
+	Tcl_RestoreInterpState(interp, state);
+
+	Tcl_DecrRefCount(cmd);
+	Tcl_DecrRefCount(cb->script);
+	Tcl_Free((char *) cb);
+}
+
+/* keep hold of a callback script for a load job */
+static struct load_script *load_script_new(Tcl_Interp *interp, Tcl_Obj *script)
+{
+	struct load_script *cb;
+
+	cb = (struct load_script *) Tcl_Alloc(sizeof(struct load_script));
+	cb->interp = interp;
+	cb->script = script;
+	Tcl_IncrRefCount(script);
+	return cb;
+}
+
+/* load an asset file in the background, calling back once it's loaded */
+static int wrap_load_async(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[])
+{
+	char *file;
+	int type, arg, id;
+	struct load_script *cb;
+
+	HAS_ARGS_2(4, 5, "type filename script ?delay? ");
+	FETCH_INDEXED(1, load_types, "asset type", 0, type);
+	FETCH_STRING(2, file);
+
+	/* songs can take a fade-in delay */
+	arg = load_type_args[type];
+	if( objc == 5 )
+		FETCH_INT(4, arg);
+
+	cb = load_script_new(interp, objv[3]);
+	id = load_async(load_type_ids[type], file, arg, load_callback, cb);
+	if( id == ERR )
+		{
+			Tcl_DecrRefCount(cb->script);
+			Tcl_Free((char *) cb);
+			RET_ERROR("Couldn't queue the asset ");
+		}
+
+	RET_INT(id);
+}
+
+/* load an asset from a memory buffer in the background */
+static int wrap_load_async_buffer(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[])
+{
+	unsigned char *data;
+	int len, type, arg, id;
+	struct load_script *cb;
+
+	HAS_ARGS_2(4, 5, "type data script ?delay? ");
+	FETCH_INDEXED(1, load_types, "asset type", 0, type);
+	FETCH_DATA(2, len, data);
+
+	arg = load_type_args[type];
+	if( objc == 5 )
+		FETCH_INT(4, arg);
+
+	cb = load_script_new(interp, objv[3]);
+	id = load_async_buffer(load_type_ids[type], len, data, arg, load_callback, cb);
+	if( id == ERR )
+		{
+			Tcl_DecrRefCount(cb->script);
+			Tcl_Free((char *) cb);
+			RET_ERROR("Couldn't queue the asset ");
+		}
+
+	RET_INT(id);
+}
+
+/* run the callbacks for anything loaded, without waiting for the next frame */
+static int wrap_load_poll(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[])
+{
+	HAS_ARGS(1, NULL);
+	RET_INT(load_poll());
+}
+
+
+
+/* start caching decoded assets */
+static int wrap_cache_open(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[])
+{
+	char *dir;
+
+	HAS_ARGS_2(1, 2, "?directory? ");
+	dir = NULL;
+	if( objc == 2 )
+		FETCH_STRING(1, dir);
+
+	if( cache_open(dir) == ERR )
+		RET_ERROR("Couldn't create the cache directory ");
+
+	return TCL_OK;
+}
+
+/* stop caching, once every cached asset is deleted */
+static int wrap_cache_close(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[])
+{
+	HAS_ARGS(1, NULL);
+	cache_close();
+	return TCL_OK;
+}
+
+/* load an image file as a ready-to-draw frame, through the cache */
+static int wrap_cache_frame_from_disk(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[])
+{
+	char *file;
+	int mask;
+	frame *frame;
+
+	HAS_ARGS_2(2, 3, "filename ?mask? ");
+	FETCH_STRING(1, file);
+	mask = 0;
+	if( objc == 3 )
+		FETCH_BOOL(2, mask);
+
+	frame = cache_frame_from_disk(file, mask ? CACHE_MASK : 0);
+	if( !frame )
+		RET_ERROR("Invalid image file ");
+
+	RET_PTR(OBJ_FRAME, frame);
+}
+
+/* load an image from a memory buffer, through the cache */
+static int wrap_cache_frame_from_buffer(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[])
+{
+	unsigned char *data;
+	int len, mask;
+	frame *frame;
+
+	HAS_ARGS_2(2, 3, "data ?mask? ");
+	FETCH_DATA(1, len, data);
+	mask = 0;
+	if( objc == 3 )
+		FETCH_BOOL(2, mask);
+
+	frame = cache_frame_from_buffer(len, data, mask ? CACHE_MASK : 0);
+	if( !frame )
+		RET_ERROR("Invalid image data ");
+
+	RET_PTR(OBJ_FRAME, frame);
+}
+
+/* load a sound file, through the cache */
+static int wrap_cache_sound_from_disk(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[])
+{
+	char *file;
+	HAS_ARGS(2, "filename ");
+	FETCH_STRING(1, file);
+	RET_PTR(OBJ_SOUND, cache_sound_from_disk(file));
+}
+
+/* load a sound from a memory buffer, through the cache */
+static int wrap_cache_sound_from_buffer(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[])
+{
+	unsigned char *data;
+	int len;
+	HAS_ARGS(2, "data ");
+	FETCH_DATA(1, len, data);
+	RET_PTR(OBJ_SOUND, cache_sound_from_buffer(len, data));
+}
+
+/* map an asset pack */
+static int wrap_pack_open(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[])
+{
+	char *file;
+	pack *pack;
+
+	HAS_ARGS(2, "filename ");
+	FETCH_STRING(1, file);
+
+	pack = pack_open(file);
+	if( !pack )
+		RET_ERROR("Couldn't open the asset pack ");
+
+	RET_PTR(OBJ_PACK, pack);
+}
+
+/* unmap an asset pack, once everything taken from it is deleted */
+static int wrap_pack_close(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[])
+{
+	pack *pack;
+	HAS_ARGS(2, "pack-id ");
+	FETCH_PTR(1, OBJ_PACK, pack);
+	pack_close(pack);
+	return TCL_OK;
+}
+
+/* make a frame that draws straight from the pack */
+static int wrap_pack_frame(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[])
+{
+	pack *pack;
+	char *name;
+	frame *frame;
+
+	HAS_ARGS(3, "pack-id name ");
+	FETCH_PTR(1, OBJ_PACK, pack);
+	FETCH_STRING(2, name);
+
+	frame = pack_get_frame(pack, name);
+	if( !frame )
+		RET_ERROR("No such frame in the pack ");
+
+	RET_PTR(OBJ_FRAME, frame);
+}
+
+/* get the precomputed bounding box of a frame's opaque pixels */
+static int wrap_pack_bound(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[])
+{
+	pack *pack;
+	char *name;
+	box b;
+	Tcl_Obj *res;
+
+	HAS_ARGS(3, "pack-id name ");
+	FETCH_PTR(1, OBJ_PACK, pack);
+	FETCH_STRING(2, name);
+
+	if( pack_get_bound(pack, name, &b) == ERR )
+		RET_ERROR("No such frame in the pack ");
+
+	res = Tcl_NewObj();
+	APPEND_INT(res, b.x1);
+	APPEND_INT(res, b.y1);
+	APPEND_INT(res, b.x2);
+	APPEND_INT(res, b.y2);
+	Tcl_SetObjResult(interp, res);
+	return TCL_OK;
+}
+
+/* make a sound that plays straight from the pack */
+static int wrap_pack_sound(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[])
+{
+	pack *pack;
+	char *name;
+	sound *sound;
+
+	HAS_ARGS(3, "pack-id name ");
+	FETCH_PTR(1, OBJ_PACK, pack);
+	FETCH_STRING(2, name);
+
+	sound = pack_get_sound(pack, name);
+	if( !sound )
+		RET_ERROR("No such sound in the pack ");
+
+	RET_PTR(OBJ_SOUND, sound);
+}
+
+/* add a font from the pack, under its name in the pack */
+static int wrap_pack_font(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[])
+{
+	pack *pack;
+	char *name;
+
+	HAS_ARGS(3, "pack-id name ");
+	FETCH_PTR(1, OBJ_PACK, pack);
+	FETCH_STRING(2, name);
+
+	if( pack_load_font(pack, name) == ERR )
+		RET_ERROR("No such font in the pack ");
+
+	return TCL_OK;
+}
+
+
+
+
+/*
+ * run the callback of every sprite in the list, in list order.  the
+ * sprites are noted as the pass starts, so sprites added by a callback
+ * wait for the next pass, and sprites deleted (or given a new callback)
+ * by an earlier callback in the pass are skipped.  a callback ends the
+ * pass early by returning break, or by calling br::dispatch stop.
+ */
+static int wrap_dispatch_run(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[])
+{
+	list *l;
+	iterator iter;
+	Tcl_HashEntry *entry;
+	struct sprite_callback *cb;
+	struct dispatch_entry *pass;
+	Tcl_Obj **words, *call[DISPATCH_WORDS], *cmd, *id;
+	int i, ct, word_ct, stopped, result;
+
+	HAS_ARGS(2, "list-id ");
+	FETCH_PTR(1, OBJ_LIST, l);
+
+	ct = list_length(l);
+	if( ct == ERR )
+		RET_ERROR("Invalid list id ");
+	pass = (struct dispatch_entry *) Tcl_Alloc((ct + 1) * sizeof(struct dispatch_entry));
+
+	ct = 0;
+	iterator_start(iter, l);
+	while( iterator_data(iter) )
+		{
+			entry = Tcl_FindHashEntry(&callbacks, (char *) iterator_data(iter));
+			if( entry )
+				{
+					cb = (struct sprite_callback *) Tcl_GetHashValue(entry);
+					pass[ct].sprite = iterator_data(iter);
+					pass[ct].gen = cb->gen;
+					ct++;
+				}
+			iterator_next(iter);
+		}
+
+	/* passes can nest, if a callback runs one of its own */
+	stopped = dispatch_stopped;
+	dispatch_stopped = 0;
+	result = TCL_OK;
+
+	for( i=0; i < ct && !dispatch_stopped; i++ )
+		{
+			entry = Tcl_FindHashEntry(&callbacks, (char *) pass[i].sprite);
+			if( !entry )
+				continue;
+			cb = (struct sprite_callback *) Tcl_GetHashValue(entry);
+			if( cb->gen != pass[i].gen )
+				continue;
+
+			/* the command, with the sprite id on the end */
+			Tcl_ListObjGetElements(NULL, cb->cmd, &word_ct, &words);
+			memcpy(call, words, word_ct * sizeof(Tcl_Obj *));
+			call[word_ct] = cb->id;
+
+			/* the callback may delete its own sprite, so hang on to these while it runs */
+			cmd = cb->cmd;
+			id = cb->id;
+			Tcl_IncrRefCount(cmd);
+			Tcl_IncrRefCount(id);
+			result = Tcl_EvalObjv(interp, word_ct + 1, call, TCL_EVAL_GLOBAL);
+			Tcl_DecrRefCount(cmd);
+			Tcl_DecrRefCount(id);
+
+			if( result == TCL_ERROR )
+				break;
+			if( result == TCL_BREAK )
+				{
+					result = TCL_OK;
+					break;
+				}
+			result = TCL_OK;
+		}
+
+	dispatch_stopped = stopped;
+	Tcl_Free((char *) pass);
+
+	if( result == TCL_OK )
+		Tcl_ResetResult(interp);
+	return result;
+}
+
+/* end the running dispatch pass, once the current callback returns */
+static int wrap_dispatch_stop(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[])
+{
+	HAS_ARGS(1, NULL);
+	dispatch_stopped = 1;
+	return TCL_OK;
+}
@@ -10,6 +10,9 @@
 /* how long is pointer, when converted to text? */
 #define PTR_LEN 20
 
+/* how many words a sprite callback command can have, counting the sprite id */
+#define DISPATCH_WORDS 16
+
 /* pulled from SDL_mixer.h */
 #define MIX_MAX_VOLUME 128
 
@@ -24,6 +27,15 @@ void load_routines(Tcl_Interp *);
 
 
 
+/* engine handles, as Tcl objects */
+static Tcl_Obj *new_handle(int, void *);
+static int get_handle(Tcl_Interp *, Tcl_Obj *, int, void **);
+static void forget_handle(void *);
+static void handle_deleted(int, void *);
+static void dup_handle(Tcl_Obj *, Tcl_Obj *);
+static void update_handle_string(Tcl_Obj *);
+static int set_handle_from_any(Tcl_Interp *, Tcl_Obj *);
+
 /* all our stuff for making the C and tcl interact... */
 static int wrap_graphics_open(ClientData, Tcl_Interp *, int, Tcl_Obj* CONST []);
 static int wrap_graphics_close(ClientData, Tcl_Interp *, int, Tcl_Obj* CONST []);
@@ -91,6 +103,9 @@ static int wrap_layer_camera(ClientData, Tcl_Interp *, int, Tcl_Obj *CONST []);
 static int wrap_layer_view(ClientData, Tcl_Interp *, int, Tcl_Obj *CONST []);
 
 static int wrap_frame_info(ClientData, Tcl_Interp *, int, Tcl_Obj *CONST []);
+static frame *adopt_frame_data(Tcl_Obj *, int, int, int);
+static void release_bytes(void *);
+static int fetch_convolution(Tcl_Interp *, Tcl_Obj *, convolution *);
 static int wrap_frame_create(ClientData, Tcl_Interp *, int, Tcl_Obj *CONST []);
 static int wrap_frame_delete(ClientData, Tcl_Interp *, int, Tcl_Obj *CONST []);
 static int wrap_frame_copy(ClientData, Tcl_Interp *, int, Tcl_Obj *CONST []);
@@ -131,12 +146,21 @@ static int wrap_sprite_delete(ClientData, Tcl_Interp *, int, Tcl_Obj *CONST []);
 static int wrap_sprite_frame(ClientData, Tcl_Interp *, int, Tcl_Obj *CONST []);
 static int wrap_sprite_z_hint(ClientData, Tcl_Interp *, int, Tcl_Obj *CONST []);
 static int wrap_sprite_scale(ClientData, Tcl_Interp *, int, Tcl_Obj *CONST []);
+static int wrap_sprite_filter(ClientData, Tcl_Interp *, int, Tcl_Obj *CONST []);
+static int wrap_sprite_angle(ClientData, Tcl_Interp *, int, Tcl_Obj *CONST []);
 static int wrap_sprite_collides(ClientData, Tcl_Interp *, int, Tcl_Obj *CONST []);
 static int wrap_sprite_bounding_box(ClientData, Tcl_Interp *, int, Tcl_Obj *CONST []);
 static int wrap_sprite_pixel_mask(ClientData, Tcl_Interp *, int, Tcl_Obj *CONST []);
 static int wrap_sprite_pixel_mask_from(ClientData, Tcl_Interp *, int, Tcl_Obj *CONST []);
 static int wrap_sprite_position(ClientData, Tcl_Interp *, int, Tcl_Obj *CONST []);
 static int wrap_sprite_velocity(ClientData, Tcl_Interp *, int, Tcl_Obj *CONST []);
+static int sprite_pairs(Tcl_Interp *, int, Tcl_Obj *CONST [], int (*)(sprite *, int *, int *), void (*)(sprite *, int, int));
+static int wrap_sprite_positions(ClientData, Tcl_Interp *, int, Tcl_Obj *CONST []);
+static int wrap_sprite_velocities(ClientData, Tcl_Interp *, int, Tcl_Obj *CONST []);
+static int wrap_sprite_frames(ClientData, Tcl_Interp *, int, Tcl_Obj *CONST []);
+static int wrap_sprite_states(ClientData, Tcl_Interp *, int, Tcl_Obj *CONST []);
+static int wrap_sprite_callback(ClientData, Tcl_Interp *, int, Tcl_Obj *CONST []);
+static void forget_callback(void *);
 static int wrap_sprite_add_frame(ClientData, Tcl_Interp *, int, Tcl_Obj *CONST []);
 static int wrap_sprite_add_frame_data(ClientData, Tcl_Interp *, int, Tcl_Obj *CONST []);
 static int wrap_sprite_add_subframe(ClientData, Tcl_Interp *, int, Tcl_Obj *CONST []);
@@ -156,6 +180,7 @@ static int wrap_inspect_in_frame(ClientData, Tcl_Interp *, int, Tcl_Obj *CONST [
 static int wrap_inspect_near_point(ClientData, Tcl_Interp *, int, Tcl_Obj *CONST []);
 
 static int wrap_collision_map(ClientData, Tcl_Interp *, int, Tcl_Obj *CONST []);
+static int wrap_collision_map_all(ClientData, Tcl_Interp *, int, Tcl_Obj *CONST []);
 static int wrap_collision_sprites(ClientData, Tcl_Interp *, int, Tcl_Obj *CONST []);
 
 static int wrap_motion_list(ClientData, Tcl_Interp *, int, Tcl_Obj *CONST []);
@@ -163,3 +188,53 @@ static int wrap_motion_single(ClientData, Tcl_Interp *, int, Tcl_Obj *CONST []);
 
 static int wrap_clock_ms(ClientData, Tcl_Interp *, int, Tcl_Obj *CONST []);
 static int wrap_clock_wait(ClientData, Tcl_Interp *, int, Tcl_Obj *CONST []);
+static int wrap_clock_stats(ClientData, Tcl_Interp *, int, Tcl_Obj *CONST []);
+static int wrap_clock_reset_stats(ClientData, Tcl_Interp *, int, Tcl_Obj *CONST []);
+
+static int wrap_stats_enabled(ClientData, Tcl_Interp *, int, Tcl_Obj *CONST []);
+static int wrap_stats_get(ClientData, Tcl_Interp *, int, Tcl_Obj *CONST []);
+static int wrap_stats_reset(ClientData, Tcl_Interp *, int, Tcl_Obj *CONST []);
+
+static int wrap_decode(ClientData, Tcl_Interp *, int, Tcl_Obj *CONST []);
+
+struct load_script
+{
+	Tcl_Interp *interp;
+	Tcl_Obj *script;
+};
+
+static void load_callback(int, int, void *, void *);
+static struct load_script *load_script_new(Tcl_Interp *, Tcl_Obj *);
+static int wrap_load_async(ClientData, Tcl_Interp *, int, Tcl_Obj *CONST []);
+static int wrap_load_async_buffer(ClientData, Tcl_Interp *, int, Tcl_Obj *CONST []);
+static int wrap_load_poll(ClientData, Tcl_Interp *, int, Tcl_Obj *CONST []);
+
+static int wrap_cache_open(ClientData, Tcl_Interp *, int, Tcl_Obj *CONST []);
+static int wrap_cache_close(ClientData, Tcl_Interp *, int, Tcl_Obj *CONST []);
+static int wrap_cache_frame_from_disk(ClientData, Tcl_Interp *, int, Tcl_Obj *CONST []);
+static int wrap_cache_frame_from_buffer(ClientData, Tcl_Interp *, int, Tcl_Obj *CONST []);
+static int wrap_cache_sound_from_disk(ClientData, Tcl_Interp *, int, Tcl_Obj *CONST []);
+static int wrap_cache_sound_from_buffer(ClientData, Tcl_Interp *, int, Tcl_Obj *CONST []);
+
+static int wrap_pack_open(ClientData, Tcl_Interp *, int, Tcl_Obj *CONST []);
+static int wrap_pack_close(ClientData, Tcl_Interp *, int, Tcl_Obj *CONST []);
+static int wrap_pack_frame(ClientData, Tcl_Interp *, int, Tcl_Obj *CONST []);
+static int wrap_pack_bound(ClientData, Tcl_Interp *, int, Tcl_Obj *CONST []);
+static int wrap_pack_sound(ClientData, Tcl_Interp *, int, Tcl_Obj *CONST []);
+static int wrap_pack_font(ClientData, Tcl_Interp *, int, Tcl_Obj *CONST []);
+
+struct sprite_callback
+{
+	Tcl_Obj *cmd;           /* the command prefix */
+	Tcl_Obj *id;            /* the sprite's handle, appended to the command */
+	unsigned long gen;      /* when the callback was set */
+};
+
+struct dispatch_entry
+{
+	void *sprite;
+	unsigned long gen;
+};
+
+static int wrap_dispatch_run(ClientData, Tcl_Interp *, int, Tcl_Obj *CONST []);
+static int wrap_dispatch_stop(ClientData, Tcl_Interp *, int, Tcl_Obj *CONST []);
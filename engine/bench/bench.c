@@ -0,0 +1,779 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "SDL.h"
+#include "brick.h"
+#include "bench.h"
+
+
+
+/*
+ * brick-bench:  deterministic, headless microbenchmarks of the engine's
+ * hot paths.  every benchmark prints one tab-separated line:
+ *
+ *   name  ops  ns/op  ops/s  ns/pixel
+ *
+ * where ns/pixel is "-" for benchmarks that don't move pixels.  the
+ * optional arguments are a "-s N" iteration multiplier and a list of
+ * name prefixes, e.g. "brick-bench blit.rgba collision".
+ */
+
+
+
+/* the iteration multiplier and name filters from the command line */
+static int scale = 1;
+static int filter_ct;
+static char **filters;
+
+/* the seed for the pseudo-random data:  fixed, so every run is identical */
+static unsigned int seed = 1;
+
+/* the blit target, and the positions each blitter cycles through */
+static frame *target;
+static point positions[BENCH_POSITIONS];
+
+
+
+/* the little-endian and big-endian renderers */
+static struct blitter blitters_le[] =
+{
+	{ "rgb", FRAME_RGB, rgb_frame_le, rgb_frame_le_scaled },
+	{ "rgba", FRAME_RGBA, rgba_frame_le, rgba_frame_le_scaled },
+	{ "hl", FRAME_HL, hl_frame_le, hl_frame_le_scaled },
+	{ "sl", FRAME_SL, sl_frame_le, sl_frame_le_scaled },
+	{ "br", FRAME_BR, br_frame_le, br_frame_le_scaled },
+	{ "ct", FRAME_CT, ct_frame_le, ct_frame_le_scaled },
+	{ "sat", FRAME_SAT, sat_frame_le, sat_frame_le_scaled },
+	{ "displ", FRAME_DISPL, displ_frame_le, displ_frame_le_scaled },
+	{ "convo", FRAME_CONVO, convo_frame_le, convo_frame_le_scaled },
+	{ "lut", FRAME_LUT, lut_frame_le, lut_frame_le_scaled },
+	{ "xor", FRAME_XOR, xor_frame_le, xor_frame_le_scaled },
+	{ NULL, 0, NULL, NULL }
+};
+
+static struct blitter blitters_be[] =
+{
+	{ "rgb", FRAME_RGB, rgb_frame_be, rgb_frame_be_scaled },
+	{ "rgba", FRAME_RGBA, rgba_frame_be, rgba_frame_be_scaled },
+	{ "hl", FRAME_HL, hl_frame_be, hl_frame_be_scaled },
+	{ "sl", FRAME_SL, sl_frame_be, sl_frame_be_scaled },
+	{ "br", FRAME_BR, br_frame_be, br_frame_be_scaled },
+	{ "ct", FRAME_CT, ct_frame_be, ct_frame_be_scaled },
+	{ "sat", FRAME_SAT, sat_frame_be, sat_frame_be_scaled },
+	{ "displ", FRAME_DISPL, displ_frame_be, displ_frame_be_scaled },
+	{ "convo", FRAME_CONVO, convo_frame_be, convo_frame_be_scaled },
+	{ "lut", FRAME_LUT, lut_frame_be, lut_frame_be_scaled },
+	{ "xor", FRAME_XOR, xor_frame_be, xor_frame_be_scaled },
+	{ NULL, 0, NULL, NULL }
+};
+
+
+
+
+
+
+int main(int argc, char *argv[])
+{
+	int i;
+
+	/* parse the iteration multiplier and the name filters */
+	for( i=1; i < argc; i++ )
+		{
+			if( !strcmp(argv[i], "-s") && i+1 < argc )
+				{
+					scale = atoi(argv[++i]);
+					if( scale < 1 )
+						scale = 1;
+				}
+			else
+				break;
+		}
+
+	filter_ct = argc - i;
+	filters = argv + i;
+
+
+	/* there's no display here:  use sdl's dummy video driver unless told otherwise */
+	if( !getenv("SDL_VIDEODRIVER") )
+		putenv("SDL_VIDEODRIVER=dummy");
+
+	init_brick();
+
+	/* a canvas-sized target, and the positions blitted to, partly off the edges */
+	target = frame_create(FRAME_RGB, BENCH_W, BENCH_H, NULL, NULL);
+	memset(target->data, 0x80, BENCH_W * BENCH_H * RGBA_BYTES);
+
+	for( i=0; i < BENCH_POSITIONS; i++ )
+		{
+			positions[i].x = (int)(lcg() % (BENCH_W + BENCH_FRAME)) - BENCH_FRAME / 2;
+			positions[i].y = (int)(lcg() % (BENCH_H + BENCH_FRAME)) - BENCH_FRAME / 2;
+		}
+
+
+	/* and run everything that was asked for */
+	printf("name\tops\tns/op\tops/s\tns/pixel\n");
+
+	set_pixel_order(16, 8, 0);
+	bench_blitters("le", blitters_le);
+
+	set_pixel_order(8, 16, 24);
+	bench_blitters("be", blitters_be);
+
+	set_pixel_order(16, 8, 0);
+	bench_map_collision();
+	bench_sprite_collision();
+	bench_line_of_sight();
+	bench_list_sort();
+	bench_motion();
+	bench_load();
+	bench_show_rendered();
+
+	frame_delete(target);
+	quit_brick();
+	return 0;
+
+}
+
+
+
+
+
+
+
+
+
+
+/*
+ * every frame type, unscaled, scaled up and scaled down
+ */
+static void bench_blitters(const char *order, struct blitter *b)
+{
+	char name[64];
+	long i, ops;
+	long long start, pixels;
+	frame *f;
+	dimensions span;
+
+	for( ; b->name; b++ )
+		{
+			f = bench_frame(b->type, BENCH_FRAME, BENCH_FRAME);
+
+			/* unscaled */
+			snprintf(name, sizeof(name), "blit.%s.%s", b->name, order);
+			if( selected(name) )
+				{
+					ops = 2000L * scale;
+					pixels = 0;
+
+					for( i=0; i < ops; i++ )
+						pixels += visible_area(&positions[i % BENCH_POSITIONS], f->w, f->h);
+
+					/* one untimed pass, to swizzle the frame into the current pixel order */
+					b->blit(target, f, &positions[0]);
+
+					start = clock_ns();
+					for( i=0; i < ops; i++ )
+						b->blit(target, f, &positions[i % BENCH_POSITIONS]);
+					report(name, ops, start, clock_ns(), pixels);
+				}
+
+			/* scaled up by half, and down by half */
+			for( span.w = BENCH_FRAME * 3 / 2; span.w >= BENCH_FRAME / 2; span.w = BENCH_FRAME / 2 )
+				{
+					span.h = span.w;
+					snprintf(name, sizeof(name), "blit.%s.%s.scaled-%s", b->name, order, span.w > BENCH_FRAME ? "up" : "down");
+					if( selected(name) )
+						{
+							ops = 2000L * scale;
+							pixels = 0;
+
+							for( i=0; i < ops; i++ )
+								pixels += visible_area(&positions[i % BENCH_POSITIONS], span.w, span.h);
+
+							b->blit_scaled(target, f, &positions[0], &span);
+
+							start = clock_ns();
+							for( i=0; i < ops; i++ )
+								b->blit_scaled(target, f, &positions[i % BENCH_POSITIONS], &span);
+							report(name, ops, start, clock_ns(), pixels);
+						}
+
+					if( span.w < BENCH_FRAME )
+						break;
+				}
+
+			frame_delete(f);
+		}
+
+}
+
+
+
+
+
+
+
+
+
+
+/*
+ * sprite-to-map collision, on maps of rising tile density, in box
+ * and pixel-accurate modes
+ */
+static void bench_map_collision()
+{
+	static const int density[] = { 0, 10, 30, -1 };
+	static const int modes[] = { COLLISION_BOX, COLLISION_PIXEL };
+	static const char *mode_names[] = { "box", "pixel" };
+
+	char name[64];
+	long i, ops;
+	long long start;
+	int d, m;
+	map *mp;
+	sprite *s;
+	map_collision res;
+
+	for( m=0; m < 2; m++ )
+		for( d=0; density[d] >= 0; d++ )
+			{
+				snprintf(name, sizeof(name), "collision.map.%s.%d", mode_names[m], density[d]);
+				if( !selected(name) )
+					continue;
+
+				mp = bench_map(density[d], modes[m]);
+				s = bench_sprite(0, 0, modes[m]);
+				ops = 20000L * scale;
+
+				start = clock_ns();
+				for( i=0; i < ops; i++ )
+					{
+						/* a long diagonal move from a pseudo-random spot */
+						sprite_set_position(s, positions[i % BENCH_POSITIONS].x, positions[i % BENCH_POSITIONS].y);
+						sprite_set_velocity(s, (i & 1) ? 24 : -24, (i & 2) ? 16 : -16);
+						collision_with_map(s, mp, 0, &res);
+					}
+				report(name, ops, start, clock_ns(), -1);
+
+				sprite_delete(s);
+				map_empty(mp, 1);
+				map_delete(mp);
+			}
+
+}
+
+
+
+
+/*
+ * one sprite against lists of 10, 100 and 500 others
+ */
+static void bench_sprite_collision()
+{
+	static const int counts[] = { 10, 100, 500, 0 };
+
+	char name[64];
+	long i, ops;
+	long long start;
+	int c, j;
+	list *l;
+	sprite *s, *tgt;
+	sprite_collision res[BENCH_COLLISIONS];
+
+	for( c=0; counts[c]; c++ )
+		{
+			snprintf(name, sizeof(name), "collision.sprites.%d", counts[c]);
+			if( !selected(name) )
+				continue;
+
+			l = list_create();
+			for( j=0; j < counts[c]; j++ )
+				list_add(l, bench_sprite(lcg() % BENCH_W, lcg() % BENCH_H, COLLISION_BOX));
+
+			s = bench_sprite(0, 0, COLLISION_BOX);
+			ops = 200000L * scale / counts[c];
+
+			start = clock_ns();
+			for( i=0; i < ops; i++ )
+				{
+					sprite_set_position(s, positions[i % BENCH_POSITIONS].x, positions[i % BENCH_POSITIONS].y);
+					sprite_set_velocity(s, (i & 1) ? 8 : -8, (i & 2) ? 8 : -8);
+					collision_with_sprites(s, l, BENCH_COLLISIONS, res);
+				}
+			report(name, ops, start, clock_ns(), -1);
+
+			sprite_delete(s);
+			while( (tgt = list_shift(l)) )
+				sprite_delete(tgt);
+			list_delete(l);
+		}
+
+}
+
+
+
+
+/*
+ * line-of-sight tests across a partly-filled map
+ */
+static void bench_line_of_sight()
+{
+	long i, ops;
+	long long start;
+	map *mp;
+	sprite *s, *tgt;
+
+	if( !selected("inspect.line-of-sight") )
+		return;
+
+	mp = bench_map(10, COLLISION_BOX);
+	s = bench_sprite(0, 0, COLLISION_BOX);
+	tgt = bench_sprite(BENCH_W / 2, BENCH_H / 2, COLLISION_BOX);
+	ops = 100000L * scale;
+
+	start = clock_ns();
+	for( i=0; i < ops; i++ )
+		{
+			sprite_set_position(s, positions[i % BENCH_POSITIONS].x, positions[i % BENCH_POSITIONS].y);
+			inspect_line_of_sight(mp, s, 8, 8, BENCH_W, tgt);
+		}
+	report("inspect.line-of-sight", ops, start, clock_ns(), -1);
+
+	sprite_delete(s);
+	sprite_delete(tgt);
+	map_empty(mp, 1);
+	map_delete(mp);
+
+}
+
+
+
+
+/*
+ * z-hint sorting of sprite lists, reshuffled before every sort
+ */
+static void bench_list_sort()
+{
+	static const int counts[] = { 100, 500, 0 };
+
+	char name[64];
+	long i, ops;
+	long long start, elapsed;
+	int c;
+	list *l;
+	sprite *s;
+	iterator iter;
+
+	for( c=0; counts[c]; c++ )
+		{
+			snprintf(name, sizeof(name), "list.sort.%d", counts[c]);
+			if( !selected(name) )
+				continue;
+
+			l = list_create();
+			for( i=0; i < counts[c]; i++ )
+				list_add(l, bench_sprite(0, 0, COLLISION_OFF));
+
+			ops = 200000L * scale / counts[c];
+			elapsed = 0;
+
+			/* only the sort itself is timed, not the reshuffle */
+			for( i=0; i < ops; i++ )
+				{
+					iterator_start(iter, l);
+					while( (s = iterator_data(iter)) )
+						{
+							s->z_hint = lcg() % 1000;
+							iterator_next(iter);
+						}
+
+					start = clock_ns();
+					list_sort(l, compare_by_z_hint);
+					elapsed += clock_ns() - start;
+				}
+			report(name, ops, 0, elapsed, -1);
+
+			while( (s = list_shift(l)) )
+				sprite_delete(s);
+			list_delete(l);
+		}
+
+}
+
+
+
+
+/*
+ * a list of sprites running a small motion-control program
+ */
+static void bench_motion()
+{
+	long i, ops;
+	long long start;
+	int j;
+	list *l;
+	sprite *s;
+
+	if( !selected("motion.exec-list") )
+		return;
+
+	l = list_create();
+	for( j=0; j < 500; j++ )
+		{
+			s = bench_sprite(lcg() % BENCH_W, lcg() % BENCH_H, COLLISION_OFF);
+			sprite_set_velocity(s, 1, -1);
+			sprite_load_program(s, "add xpos, xvel\nadd ypos, yvel\nstc frame, 0\n");
+			list_add(l, s);
+		}
+
+	ops = 2000L * scale;
+
+	start = clock_ns();
+	for( i=0; i < ops; i++ )
+		motion_exec_list(l);
+	report("motion.exec-list", ops, start, clock_ns(), -1);
+
+	while( (s = list_shift(l)) )
+		sprite_delete(s);
+	list_delete(l);
+
+}
+
+
+
+
+/*
+ * the work done on every frame as it's loaded:  rgb unpacking, pixel
+ * reordering, and building pixel masks and their bounds
+ */
+static void bench_load()
+{
+	static const int types[] = { FRAME_RGB, FRAME_RGBA };
+	static const char *type_names[] = { "rgb", "rgba" };
+
+	char name[64];
+	long i, ops;
+	long long start;
+	unsigned char *rgb;
+	frame *f;
+	sprite *s;
+	int t;
+
+	if( selected("load.unpack") )
+		{
+			rgb = malloc(BENCH_W * BENCH_H * RGB_BYTES);
+			for( i=0; i < BENCH_W * BENCH_H * RGB_BYTES; i++ )
+				rgb[i] = lcg() & 0xff;
+
+			f = bench_frame(FRAME_RGBA, BENCH_W, BENCH_H);
+			ops = 200L * scale;
+
+			start = clock_ns();
+			for( i=0; i < ops; i++ )
+				unpack_rgb(BENCH_W * BENCH_H, rgb, f->data);
+			report("load.unpack", ops, start, clock_ns(), (long long)ops * BENCH_W * BENCH_H);
+
+			frame_delete(f);
+			free(rgb);
+		}
+
+	if( selected("load.swizzle") )
+		{
+			f = bench_frame(FRAME_RGBA, BENCH_W, BENCH_H);
+			ops = 200L * scale;
+
+			/* flip between the two pixel orders, so every pass moves every pixel */
+			start = clock_ns();
+			for( i=0; i < ops; i++ )
+				{
+					if( i & 1 )
+						set_pixel_order(16, 8, 0);
+					else
+						set_pixel_order(8, 16, 24);
+					swizzle_pixels(f);
+				}
+			report("load.swizzle", ops, start, clock_ns(), (long long)ops * BENCH_W * BENCH_H);
+
+			set_pixel_order(16, 8, 0);
+			frame_delete(f);
+		}
+
+	for( t=0; t < 2; t++ )
+		{
+			snprintf(name, sizeof(name), "load.mask.%s", type_names[t]);
+			if( !selected(name) )
+				continue;
+
+			/* a sprite-sheet-sized frame, masked from itself, with its bounds found */
+			f = bench_frame(types[t], BENCH_W, BENCH_H);
+			s = sprite_create();
+			sprite_add_frame(s, f);
+			sprite_set_frame(s, 0);
+			ops = 200L * scale;
+
+			start = clock_ns();
+			for( i=0; i < ops; i++ )
+				sprite_set_pixel_mask_from(s, 0, f);
+			report(name, ops, start, clock_ns(), (long long)ops * BENCH_W * BENCH_H);
+
+			sprite_delete(s);
+		}
+
+}
+
+
+
+
+/*
+ * the zoom and rotation pass that copies the canvas to the screen.  this
+ * needs a video mode, so it's skipped if sdl can't open one.
+ */
+static void bench_show_rendered()
+{
+	static const char *rot_names[] = { "0", "90", "180", "270" };
+
+	char name[64];
+	long i, ops;
+	long long start;
+	int zf, rot;
+
+	for( zf=1; zf <= 3; zf++ )
+		for( rot=GRAPHICS_0; rot <= GRAPHICS_270; rot++ )
+			{
+				snprintf(name, sizeof(name), "display.zoom-%d.rot-%s", zf, rot_names[rot]);
+				if( !selected(name) )
+					continue;
+
+				if( graphics_open(BENCH_W / 2, BENCH_H / 2, zf, rot, GRAPHICS_SDL | GRAPHICS_WINDOWED) )
+					{
+						printf("%s\tskipped: no video mode\n", name);
+						continue;
+					}
+
+				ops = 500L * scale;
+
+				start = clock_ns();
+				for( i=0; i < ops; i++ )
+					show_rendered();
+				report(name, ops, start, clock_ns(), (long long)ops * (BENCH_W / 2) * (BENCH_H / 2) * zf * zf);
+
+				graphics_close();
+			}
+
+}
+
+
+
+
+
+
+
+
+
+
+/*
+ * a frame of the given type, filled with pseudo-random data of
+ * the right shape for that type
+ */
+static frame *bench_frame(int type, int w, int h)
+{
+	unsigned char *data;
+	short *displ;
+	convolution ck;
+	lut table;
+	frame *f;
+	int i;
+
+	data = malloc(w * h * RGBA_BYTES);
+	for( i=0; i < w * h * RGBA_BYTES; i++ )
+		data[i] = lcg() & 0xff;
+
+	switch( type )
+		{
+			case FRAME_DISPL:
+				/* small displacements, so most pixels land inside the target */
+				displ = (short *)data;
+				for( i=0; i < w * h * DISPL_SPAN; i++ )
+					displ[i] = (short)(lcg() % 9) - 4;
+				f = frame_create(type, w, h, data, NULL);
+				break;
+
+			case FRAME_CONVO:
+				/* a 3x3 blur */
+				memset(&ck, 0, sizeof(ck));
+				ck.kw = ck.kh = 3;
+				for( i=0; i < 9; i++ )
+					ck.kernel[i] = 1;
+				ck.divisor = 9;
+				f = frame_create(type, w, h, data, &ck);
+				break;
+
+			case FRAME_LUT:
+				/* invert every channel */
+				for( i=0; i < RGB_RANGE; i++ )
+					table.r[i] = table.g[i] = table.b[i] = RGB_MAX - i;
+				f = frame_create(type, w, h, data, &table);
+				break;
+
+			default:
+				f = frame_create(type, w, h, data, NULL);
+				break;
+		}
+
+	free(data);
+	return f;
+}
+
+
+
+
+/*
+ * a square map of 16x16 tiles, with the given percentage of them solid
+ */
+static map *bench_map(int density, int mode)
+{
+	unsigned char mask[16 * 16];
+	frame *f;
+	tile *t;
+	map *m;
+	int i;
+
+	/* a tile with a round pixel mask */
+	for( i=0; i < 16 * 16; i++ )
+		mask[i] = ((i % 16 - 8) * (i % 16 - 8) + (i / 16 - 8) * (i / 16 - 8) < 64);
+
+	f = bench_frame(FRAME_RGBA, 16, 16);
+	frame_set_mask(f, mask);
+
+	t = tile_create();
+	tile_add_frame(t, f);
+	tile_set_collides(t, mode);
+
+	/* tile 0 is empty, tile 1 is solid */
+	m = map_create();
+	map_set_tile_size(m, 16, 16);
+	map_set_size(m, BENCH_W / 16, BENCH_H / 16);
+	map_set_tile(m, 1, t);
+
+	for( i=0; i < m->w * m->h; i++ )
+		m->data[i] = ((int)(lcg() % 100) < density);
+
+	return m;
+}
+
+
+
+
+/*
+ * a 16x16 sprite at the given spot, with a round pixel mask
+ */
+static sprite *bench_sprite(int x, int y, int collides)
+{
+	unsigned char mask[16 * 16];
+	frame *f;
+	sprite *s;
+	int i;
+
+	for( i=0; i < 16 * 16; i++ )
+		mask[i] = ((i % 16 - 8) * (i % 16 - 8) + (i / 16 - 8) * (i / 16 - 8) < 64);
+
+	f = bench_frame(FRAME_RGBA, 16, 16);
+	frame_set_mask(f, mask);
+
+	s = sprite_create();
+	sprite_add_frame(s, f);
+	sprite_set_frame(s, 0);
+	sprite_set_collides(s, collides);
+	sprite_set_position(s, x, y);
+
+	return s;
+}
+
+
+
+
+/*
+ * how many pixels of a w x h rectangle at the given spot land on the target
+ */
+static int visible_area(point *pt, int w, int h)
+{
+	int x1, y1, x2, y2;
+
+	x1 = pt->x < 0 ? 0 : pt->x;
+	y1 = pt->y < 0 ? 0 : pt->y;
+	x2 = pt->x + w > BENCH_W ? BENCH_W : pt->x + w;
+	y2 = pt->y + h > BENCH_H ? BENCH_H : pt->y + h;
+
+	if( x2 <= x1 || y2 <= y1 )
+		return 0;
+
+	return (x2 - x1) * (y2 - y1);
+}
+
+
+
+
+/*
+ * a list_sort comparator, ordering by z-hint
+ */
+static int compare_by_z_hint(void *a, void *b)
+{
+	return ((sprite *)a)->z_hint - ((sprite *)b)->z_hint;
+}
+
+
+
+
+/*
+ * should the named benchmark run?  with no filters, everything runs;
+ * otherwise the name must start with one of them.
+ */
+static int selected(const char *name)
+{
+	int i;
+
+	if( !filter_ct )
+		return 1;
+
+	for( i=0; i < filter_ct; i++ )
+		if( !strncmp(name, filters[i], strlen(filters[i])) )
+			return 1;
+
+	return 0;
+}
+
+
+
+
+/*
+ * print one result line
+ */
+static void report(const char *name, long ops, long long start, long long end, long long pixels)
+{
+	double ns;
+
+	ns = (double)(end - start);
+	if( ns <= 0 )
+		ns = 1;
+
+	printf("%s\t%ld\t%.1f\t%.0f", name, ops, ns / ops, ops * 1e9 / ns);
+
+	if( pixels > 0 )
+		printf("\t%.3f\n", ns / pixels);
+	else
+		printf("\t-\n");
+
+	fflush(stdout);
+}
+
+
+
+
+/*
+ * a small linear congruential generator, so every run sees the same data
+ */
+static unsigned int lcg()
+{
+	seed = seed * 1103515245 + 12345;
+	return (seed >> 8) & 0xffffff;
+}
@@ -0,0 +1,102 @@
+/*
+ * the engine microbenchmarks
+ */
+
+/* the size of the blit target, and of the frames blitted onto it */
+#define BENCH_W 640
+#define BENCH_H 480
+#define BENCH_FRAME 64
+
+/* how many precomputed blit positions to cycle through */
+#define BENCH_POSITIONS 256
+
+/* how many results the sprite-collision benchmark will accept */
+#define BENCH_COLLISIONS 40
+
+
+struct blitter
+{
+	const char *name;
+	int type;
+	void (*blit)(frame *, frame *, point *);
+	void (*blit_scaled)(frame *, frame *, point *, dimensions *);
+};
+
+
+static void bench_blitters(const char *, struct blitter *);
+static void bench_map_collision();
+static void bench_sprite_collision();
+static void bench_line_of_sight();
+static void bench_list_sort();
+static void bench_motion();
+static void bench_load();
+static void bench_show_rendered();
+
+static frame *bench_frame(int, int, int);
+static map *bench_map(int, int);
+static sprite *bench_sprite(int, int, int);
+static int visible_area(point *, int, int);
+static int compare_by_z_hint(void *, void *);
+
+static int selected(const char *);
+static void report(const char *, long, long long, long long, long long);
+static unsigned int lcg();
+
+
+/* from pixel.c */
+extern void set_pixel_order(int, int, int);
+extern void unpack_rgb(int, const unsigned char *, unsigned char *);
+extern void swizzle_pixels(frame *);
+
+/* from pixel-le.c */
+extern void rgb_frame_le(frame *, frame *, point *);
+extern void rgba_frame_le(frame *, frame *, point *);
+extern void hl_frame_le(frame *, frame *, point *);
+extern void sl_frame_le(frame *, frame *, point *);
+extern void br_frame_le(frame *, frame *, point *);
+extern void ct_frame_le(frame *, frame *, point *);
+extern void sat_frame_le(frame *, frame *, point *);
+extern void displ_frame_le(frame *, frame *, point *);
+extern void convo_frame_le(frame *, frame *, point *);
+extern void lut_frame_le(frame *, frame *, point *);
+extern void xor_frame_le(frame *, frame *, point *);
+
+extern void rgb_frame_le_scaled(frame *, frame *, point *, dimensions *);
+extern void rgba_frame_le_scaled(frame *, frame *, point *, dimensions *);
+extern void hl_frame_le_scaled(frame *, frame *, point *, dimensions *);
+extern void sl_frame_le_scaled(frame *, frame *, point *, dimensions *);
+extern void br_frame_le_scaled(frame *, frame *, point *, dimensions *);
+extern void ct_frame_le_scaled(frame *, frame *, point *, dimensions *);
+extern void sat_frame_le_scaled(frame *, frame *, point *, dimensions *);
+extern void displ_frame_le_scaled(frame *, frame *, point *, dimensions *);
+extern void convo_frame_le_scaled(frame *, frame *, point *, dimensions *);
+extern void lut_frame_le_scaled(frame *, frame *, point *, dimensions *);
+extern void xor_frame_le_scaled(frame *, frame *, point *, dimensions *);
+
+/* from pixel-be.c */
+extern void rgb_frame_be(frame *, frame *, point *);
+extern void rgba_frame_be(frame *, frame *, point *);
+extern void hl_frame_be(frame *, frame *, point *);
+extern void sl_frame_be(frame *, frame *, point *);
+extern void br_frame_be(frame *, frame *, point *);
+extern void ct_frame_be(frame *, frame *, point *);
+extern void sat_frame_be(frame *, frame *, point *);
+extern void displ_frame_be(frame *, frame *, point *);
+extern void convo_frame_be(frame *, frame *, point *);
+extern void lut_frame_be(frame *, frame *, point *);
+extern void xor_frame_be(frame *, frame *, point *);
+
+extern void rgb_frame_be_scaled(frame *, frame *, point *, dimensions *);
+extern void rgba_frame_be_scaled(frame *, frame *, point *, dimensions *);
+extern void hl_frame_be_scaled(frame *, frame *, point *, dimensions *);
+extern void sl_frame_be_scaled(frame *, frame *, point *, dimensions *);
+extern void br_frame_be_scaled(frame *, frame *, point *, dimensions *);
+extern void ct_frame_be_scaled(frame *, frame *, point *, dimensions *);
+extern void sat_frame_be_scaled(frame *, frame *, point *, dimensions *);
+extern void displ_frame_be_scaled(frame *, frame *, point *, dimensions *);
+extern void convo_frame_be_scaled(frame *, frame *, point *, dimensions *);
+extern void lut_frame_be_scaled(frame *, frame *, point *, dimensions *);
+extern void xor_frame_be_scaled(frame *, frame *, point *, dimensions *);
+
+/* from graphics.c */
+extern void show_rendered();
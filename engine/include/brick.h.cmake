@@ -140,6 +140,7 @@ extern void layer_adjust_camera(int, int, int);
 
 extern int frame_info(frame *, int *, int *, int *);
 extern frame *frame_create(int, int, int, const void *, const void *);
+extern frame *frame_adopt(int, int, int, void *, frame_release, void *);
 extern frame *frame_copy(frame *);
 extern void frame_delete(frame *);
 extern void frame_set_offset(frame *, int, int);
@@ -151,6 +152,25 @@ extern frame *frame_effect(frame *, int, ...);
 extern frame *frame_from_disk(const char *);
 extern frame *frame_from_buffer(int, const unsigned char *);
 
+extern int load_async(int, const char *, int, load_done, void *);
+extern int load_async_buffer(int, int, const unsigned char *, int, load_done, void *);
+extern int load_poll();
+
+extern int cache_open(const char *);
+extern void cache_close();
+extern frame *cache_frame_from_disk(const char *, int);
+extern frame *cache_frame_from_buffer(int, const unsigned char *, int);
+extern sound *cache_sound_from_disk(const char *);
+extern sound *cache_sound_from_buffer(int, const unsigned char *);
+
+extern pack *pack_open(const char *);
+extern void pack_close(pack *);
+extern frame *pack_get_frame(pack *, const char *);
+extern int pack_get_bound(pack *, const char *, box *);
+extern sound *pack_get_sound(pack *, const char *);
+extern int pack_load_font(pack *, const char *);
+extern int pack_frame_bound(frame *, box *);
+
 
 extern map *map_create();
 extern void map_empty(map *, int);
@@ -190,12 +210,16 @@ extern int sprite_get_collides(sprite *, int *);
 extern int sprite_get_position(sprite *, int *, int *);
 extern int sprite_get_velocity(sprite *, int *, int *);
 extern int sprite_get_scale(sprite *, int *, int *);
+extern int sprite_get_filter(sprite *, int *);
+extern int sprite_get_angle(sprite *, int *);
 extern void sprite_set_frame(sprite *, int);
 extern void sprite_set_z_hint(sprite *, int);
 extern void sprite_set_collides(sprite *, int);
 extern void sprite_set_position(sprite *, int, int);
 extern void sprite_set_velocity(sprite *, int, int);
 extern void sprite_set_scale(sprite *, int, int);
+extern void sprite_set_filter(sprite *, int);
+extern void sprite_set_angle(sprite *, int);
 extern void sprite_set_bounding_box(sprite *, int, box *);
 extern void sprite_set_pixel_mask(sprite *, int, const unsigned char *);
 extern void sprite_set_pixel_mask_from(sprite *, int, frame *);
@@ -206,6 +230,8 @@ extern int sprite_load_program(sprite *, const char *);
 
 #define sprite_set_scalei(s, x, y) sprite_set_scale(s, (x) * 65536, (y) * 65536)
 #define sprite_set_scalef(s, x, y) sprite_set_scale(s, (int)((x) * 65536), (int)((y) * 65536))
+#define sprite_set_anglei(s, a) sprite_set_angle(s, (a) * 65536)
+#define sprite_set_anglef(s, a) sprite_set_angle(s, (int)((a) * 65536))
 
 
 
@@ -232,16 +258,29 @@ extern int motion_exec_list(list *);
 
 
 extern int clock_ms();
+extern long long clock_ns();
 extern int clock_wait(int);
+extern void clock_get_stats(frame_timing *);
+extern void clock_reset_stats();
+
+extern void stats_set_enabled(int);
+extern int stats_get_enabled();
+extern void stats_reset();
+extern void stats_get(int, frame_stats *);
 
 
 extern int event_add(int, int, event, void *);
 extern void event_message(int, int);
 
 
+extern unsigned char *decode_buffer(int, int, const unsigned char *, int *);
+
+
 extern void init_brick();
 extern void quit_brick();
 
+extern void set_delete_hook(delete_hook);
+
 
 #ifdef __cplusplus
 }
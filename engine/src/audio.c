@@ -206,7 +206,10 @@ sound *sound_load_from_buffer(int len, const unsigned char *data)
 	/* we have an rw buffer!  let's try to load the sound data */
 	s->wave = Mix_LoadWAV_RW(rw_buf, 1);
 	if( !s->wave )  /* invalid wav?  free the allocated wav struct .. */
-		free(s);
+		{
+			free(s);
+			s = NULL;
+		}
 
 	/* and return the result */
 	return s;
@@ -433,6 +436,53 @@ void song_play_from_buffer(int len, const unsigned char *data, int delay)
 
 
 
+/*
+ * play a song loaded in the background.  the song, and the buffer
+ * it's read from (if any), are taken over.
+ */
+void song_play_loaded(void *song, unsigned char *buf, int delay)
+{
+
+	if( !song )	 /* failsafe */
+		return;
+
+
+	/* no sound?  then there's nothing to do with it */
+	if( !active_audio_mode )
+		{
+			Mix_FreeMusic(song);
+			free(buf);
+			return;
+		}
+
+
+	/* stop the currently-playing song */
+	if( music )
+		{
+			Mix_HaltMusic();
+			Mix_FreeMusic(music);
+
+			if( music_buf )
+				free(music_buf);
+
+		}
+
+	music = song;
+	music_buf = buf;
+	Mix_FadeInMusic(music,-1,delay);  /* 1 means looping */
+
+}
+
+
+
+
+
+
+
+
+
+
+
 /*
  * stop currently-playing song
  */
@@ -18,6 +18,7 @@ void sound_adjust_pan(int, int);
 
 void song_play_from_disk(const char *, int);
 void song_play_from_buffer(int, const unsigned char *, int);
+void song_play_loaded(void *, unsigned char *, int);
 void song_stop(int);
 void song_pause();
 void song_resume();
@@ -0,0 +1,502 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "SDL.h"
+#include "SDL_mixer.h"
+#include "common.h"
+#include "cache.h"
+
+
+
+/*
+ * decoded frames and sounds are kept on disk as single-entry asset
+ * packs, named by a hash of the data they were decoded from and
+ * everything else that decides the result.  a repeat load maps the
+ * pack, and the asset is used straight from the mapping.  each pack is
+ * mapped once, and kept in a table by its name until the cache is
+ * closed, so loading the same asset again shares the mapping.
+ */
+static char cache_dir[CACHE_PATH_LEN];
+static int cache_ready;
+static struct cache_entry *cache_packs;
+static int cache_ct, cache_slots;
+
+
+
+
+/*
+ * start caching decoded assets in the given directory.  if it's null,
+ * $XDG_CACHE_HOME/brick (or ~/.cache/brick) is used.
+ */
+int cache_open(const char *dir)
+{
+	const char *base;
+	int len;
+
+	/* already open?  start over, leaving what's been loaded alone */
+	cache_close();
+
+	if( dir )
+		len = snprintf(cache_dir, CACHE_PATH_LEN, "%s/v%d", dir, CACHE_VERSION);
+	else if( (base = getenv("XDG_CACHE_HOME")) && *base )
+		len = snprintf(cache_dir, CACHE_PATH_LEN, "%s/brick/v%d", base, CACHE_VERSION);
+	else if( (base = getenv("HOME")) && *base )
+		len = snprintf(cache_dir, CACHE_PATH_LEN, "%s/.cache/brick/v%d", base, CACHE_VERSION);
+	else
+		return ERR;
+
+	/* leave room for the entry names */
+	if( len >= CACHE_PATH_LEN - 64 || make_dirs(cache_dir) )
+		return ERR;
+
+	cache_slots = CACHE_SLOTS;
+	cache_packs = ck_calloc(cache_slots, sizeof(*cache_packs));
+	cache_ct = 0;
+	cache_ready = 1;
+	return 0;
+
+}
+
+
+
+
+/*
+ * stop caching, and close every cached pack.  frames and sounds
+ * taken from them keep their packs mapped, so they're still good.
+ */
+void cache_close()
+{
+	int i;
+
+	if( !cache_ready )
+		return;
+
+	for( i=0; i < cache_slots; i++ )
+		if( cache_packs[i].p )
+			pack_close(cache_packs[i].p);
+
+	free(cache_packs);
+	cache_packs = NULL;
+	cache_ready = 0;
+}
+
+
+
+
+
+
+
+
+/*
+ * load an image file as a frame ready to draw:  already in the
+ * display's pixel order and, with CACHE_MASK, with its pixel mask
+ * set from its transparency.  with the cache open, this is done once
+ * per image, and later loads come straight from the cache.
+ */
+frame *cache_frame_from_disk(const char *file, int flags)
+{
+	unsigned char *data;
+	frame *fr;
+	int len;
+
+	data = map_file(file, &len);
+	if( !data )
+		return NULL;
+
+	fr = cache_frame_from_buffer(len, data, flags);
+	munmap(data, len);
+	return fr;
+
+}
+
+
+
+
+/*
+ * load an image in a memory buffer, as with cache_frame_from_disk()
+ */
+frame *cache_frame_from_buffer(int len, const unsigned char *data, int flags)
+{
+	char path[CACHE_PATH_LEN];
+	unsigned long long key, hash;
+	int named;
+	frame *fr;
+	pack *p;
+
+	/* failsafe */
+	if( !data || len <= 0 )
+		return NULL;
+
+	/* the result depends on the display's pixel order, as well as the data */
+	key = (unsigned long long)CACHE_OP_FRAME << 56 | (unsigned long long)(flags & 0xff) << 48;
+	key |= system_pixel.rshift << 24 | system_pixel.gshift << 16 | system_pixel.bshift << 8 | system_pixel.ashift;
+
+	named = cache_path(path, CACHE_OP_FRAME, len, data, key, &hash) == 0;
+	if( named && (p = cache_fetch(path, hash, key)) )
+		{
+			fr = pack_get_frame(p, "frame");
+			if( fr )
+				return fr;
+		}
+
+	/* not cached:  do the work, then keep the result */
+	fr = frame_from_buffer(len, data);
+	if( !fr )
+		return NULL;
+
+	swizzle_pixels(fr);
+	if( flags & CACHE_MASK )
+		frame_set_mask_from(fr, fr);
+
+	if( named )
+		cache_store(path, fr, NULL);
+
+	return fr;
+
+}
+
+
+
+
+/*
+ * load a sound file, decoded to the mixer's format once and cached
+ */
+sound *cache_sound_from_disk(const char *file)
+{
+	unsigned char *data;
+	sound *s;
+	int len;
+
+	data = map_file(file, &len);
+	if( !data )
+		return NULL;
+
+	s = cache_sound_from_buffer(len, data);
+	munmap(data, len);
+	return s;
+
+}
+
+
+
+
+/*
+ * load a sound in a memory buffer, as with cache_sound_from_disk()
+ */
+sound *cache_sound_from_buffer(int len, const unsigned char *data)
+{
+	char path[CACHE_PATH_LEN];
+	unsigned long long key, hash;
+	Uint16 format;
+	int freq, channels, named;
+	sound *s;
+	pack *p;
+
+	/* failsafe */
+	if( !data || len <= 0 )
+		return NULL;
+
+	/* the decoded samples depend on the mixer's output format */
+	if( !Mix_QuerySpec(&freq, &format, &channels) )
+		return sound_load_from_buffer(len, data);
+
+	key = (unsigned long long)CACHE_OP_SOUND << 56 | (unsigned long long)channels << 48;
+	key |= (unsigned long long)format << 32 | (unsigned int)freq;
+
+	named = cache_path(path, CACHE_OP_SOUND, len, data, key, &hash) == 0;
+	if( named && (p = cache_fetch(path, hash, key)) )
+		{
+			s = pack_get_sound(p, "sound");
+			if( s )
+				return s;
+		}
+
+	s = sound_load_from_buffer(len, data);
+	if( s && named )
+		cache_store(path, NULL, s);
+
+	return s;
+
+}
+
+
+
+
+
+
+
+
+
+
+/*
+ * create a directory and any missing parents
+ */
+static int make_dirs(char *path)
+{
+	char *c;
+
+	for( c = path + 1; *c; c++ )
+		if( *c == '/' )
+			{
+				*c = '\0';
+				if( mkdir(path, 0755) && errno != EEXIST )
+					{
+						*c = '/';
+						return ERR;
+					}
+				*c = '/';
+			}
+
+	if( mkdir(path, 0755) && errno != EEXIST )
+		return ERR;
+
+	return 0;
+}
+
+
+
+
+/*
+ * a 64-bit hash of a buffer, taken a word at a time
+ */
+static unsigned long long hash_buffer(int len, const unsigned char *data, unsigned long long seed)
+{
+	unsigned long long h, w;
+	int i;
+
+	h = seed ^ ((unsigned long long)len * 0x9e3779b97f4a7c15ULL);
+
+	for( i=0; i + 8 <= len; i += 8 )
+		{
+			memcpy(&w, data + i, 8);
+			w *= 0xff51afd7ed558ccdULL;
+			w ^= w >> 32;
+			h = (h ^ w) * 0xc4ceb9fe1a85ec53ULL;
+			h ^= h >> 29;
+		}
+
+	/* the last few bytes */
+	for( w = 0; i < len; i++ )
+		w = (w << 8) | data[i];
+	h = (h ^ w) * 0xc4ceb9fe1a85ec53ULL;
+
+	/* and mix the result well */
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+	return h;
+}
+
+
+
+
+/*
+ * name the cache entry for the given data and key, passing back the
+ * hash it's named by
+ */
+static int cache_path(char *path, int op, int len, const unsigned char *data, unsigned long long key, unsigned long long *hash)
+{
+	if( !cache_ready )
+		return ERR;
+
+	*hash = hash_buffer(len, data, key);
+	if( snprintf(path, CACHE_PATH_LEN, "%s/%c%016llx%016llx.pack", cache_dir, op == CACHE_OP_FRAME ? 'f' : 's', \
+		*hash, key) >= CACHE_PATH_LEN )
+		return ERR;
+
+	return 0;
+}
+
+
+
+
+/*
+ * write an entry to the cache.  it's written under a temporary name
+ * first, so another process never maps half of it.
+ */
+static void cache_store(const char *path, frame *fr, sound *s)
+{
+	char tmp[CACHE_PATH_LEN];
+	Mix_Chunk *chunk;
+	box bound;
+	int res;
+
+	if( snprintf(tmp, CACHE_PATH_LEN, "%s.%d", path, (int)getpid()) >= CACHE_PATH_LEN )
+		return;
+
+	if( fr )
+		{
+			mask_bound(fr, &bound);
+			res = pack_save_frame(tmp, fr, &bound);
+		}
+	else
+		{
+			chunk = s->wave;
+			res = pack_save_sound(tmp, chunk->alen, chunk->abuf);
+		}
+
+	if( res == 0 && rename(tmp, path) )
+		remove(tmp);
+
+}
+
+
+
+
+/*
+ * the pack for a cache entry, mapping it the first time it's asked
+ * for, if there is one
+ */
+static pack *cache_fetch(const char *path, unsigned long long hash, unsigned long long key)
+{
+	struct cache_entry *e;
+	pack *p;
+
+	e = find_entry(hash, key);
+	if( e->p )
+		return e->p;
+
+	p = pack_open(path);
+	if( !p )
+		return NULL;
+
+	/* keep the table at most half full, so probes stay short */
+	if( (cache_ct + 1) * 2 > cache_slots )
+		{
+			grow_cache();
+			e = find_entry(hash, key);
+		}
+
+	e->hash = hash;
+	e->key = key;
+	e->p = p;
+	cache_ct++;
+
+	return p;
+}
+
+
+
+
+/*
+ * find the table slot holding a cache entry, or the empty slot where
+ * it would go.  the hash is already well mixed, so it's used as it is.
+ */
+static struct cache_entry *find_entry(unsigned long long hash, unsigned long long key)
+{
+	unsigned int i;
+
+	for( i = hash & (cache_slots - 1); cache_packs[i].p; i = (i + 1) & (cache_slots - 1) )
+		if( cache_packs[i].hash == hash && cache_packs[i].key == key )
+			break;
+
+	return &cache_packs[i];
+}
+
+
+
+
+/*
+ * double the size of the table of mapped packs
+ */
+static void grow_cache()
+{
+	struct cache_entry *old, *e;
+	int i, old_slots;
+
+	old = cache_packs;
+	old_slots = cache_slots;
+
+	cache_slots *= 2;
+	cache_packs = ck_calloc(cache_slots, sizeof(*cache_packs));
+
+	for( i=0; i < old_slots; i++ )
+		if( old[i].p )
+			{
+				e = find_entry(old[i].hash, old[i].key);
+				*e = old[i];
+			}
+
+	free(old);
+}
+
+
+
+
+/*
+ * the bounding box of a frame's pixel mask, or an empty box
+ */
+static void mask_bound(frame *fr, box *bound)
+{
+	unsigned char *m;
+	int x, y;
+
+	bound->x1 = fr->w;
+	bound->y1 = fr->h;
+	bound->x2 = bound->y2 = 0;
+
+	if( !fr->mask )
+		{
+			bound->x1 = bound->y1 = 0;
+			return;
+		}
+
+	for( y=0; y < fr->h; y++ )
+		for( x=0, m = fr->mask + y * fr->stride; x < fr->w; x++, m++ )
+			if( *m )
+				{
+					if( x < bound->x1 )
+						bound->x1 = x;
+					if( y < bound->y1 )
+						bound->y1 = y;
+					if( x >= bound->x2 )
+						bound->x2 = x + 1;
+					if( y >= bound->y2 )
+						bound->y2 = y + 1;
+				}
+
+	/* nothing set? */
+	if( !bound->x2 )
+		bound->x1 = bound->y1 = 0;
+
+}
+
+
+
+
+/*
+ * map a whole file, read-only
+ */
+static unsigned char *map_file(const char *file, int *len)
+{
+	struct stat st;
+	void *map;
+	int fd;
+
+	/* failsafe */
+	if( !file )
+		return NULL;
+
+	fd = open(file, O_RDONLY);
+	if( fd < 0 )
+		return NULL;
+
+	if( fstat(fd, &st) || st.st_size <= 0 || st.st_size > 0x7fffffff )
+		{
+			close(fd);
+			return NULL;
+		}
+
+	map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if( map == MAP_FAILED )
+		return NULL;
+
+	*len = st.st_size;
+	return map;
+}
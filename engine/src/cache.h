@@ -0,0 +1,66 @@
+/*
+ * the on-disk cache of decoded assets
+ */
+
+/*
+ * the version of what's cached.  it's part of the cache directory's
+ * name, so bumping it (whenever the frame or pack layout changes)
+ * leaves every old entry behind.
+ */
+#define CACHE_VERSION 1
+
+/* the longest cache path handled */
+#define CACHE_PATH_LEN 1024
+
+/* what produced a cache entry, as part of its key */
+#define CACHE_OP_FRAME 1
+#define CACHE_OP_SOUND 2
+
+/* the first size of the table of mapped packs, a power of two */
+#define CACHE_SLOTS 64
+
+struct cache_entry
+{
+	unsigned long long hash, key;   /* what the entry's named by, */
+	pack *p;                        /* and its pack, if the slot's in use */
+};
+
+int cache_open(const char *);
+void cache_close();
+frame *cache_frame_from_disk(const char *, int);
+frame *cache_frame_from_buffer(int, const unsigned char *, int);
+sound *cache_sound_from_disk(const char *);
+sound *cache_sound_from_buffer(int, const unsigned char *);
+
+static int make_dirs(char *);
+static unsigned long long hash_buffer(int, const unsigned char *, unsigned long long);
+static int cache_path(char *, int, int, const unsigned char *, unsigned long long, unsigned long long *);
+static void cache_store(const char *, frame *, sound *);
+static pack *cache_fetch(const char *, unsigned long long, unsigned long long);
+static struct cache_entry *find_entry(unsigned long long, unsigned long long);
+static void grow_cache();
+static void mask_bound(frame *, box *);
+static unsigned char *map_file(const char *, int *);
+
+
+/* from pack.c */
+extern pack *pack_open(const char *);
+extern void pack_close(pack *);
+extern frame *pack_get_frame(pack *, const char *);
+extern sound *pack_get_sound(pack *, const char *);
+extern int pack_save_frame(const char *, frame *, box *);
+extern int pack_save_sound(const char *, int, const unsigned char *);
+
+/* from frame.c */
+extern frame *frame_from_buffer(int, const unsigned char *);
+extern int frame_set_mask_from(frame *, frame *);
+
+/* from audio.c */
+extern sound *sound_load_from_buffer(int, const unsigned char *);
+
+/* from pixel.c */
+extern void swizzle_pixels(frame *);
+extern pixel_fmt system_pixel;
+
+/* from misc.c */
+extern void *ck_calloc(int, size_t);
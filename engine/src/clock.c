@@ -1,10 +1,21 @@
 #include <stdio.h>
+#include <time.h>
 #include "SDL.h"
 #include "common.h"
 #include "clock.h"
 
 
 
+/* the frame-pacing state:  deadlines are always base + n * (1s / fps), so they never drift */
+static int pace_fps = 0;
+static long long pace_base, pace_n;
+
+/* a ring of recent frame times, in nanoseconds, and the deadline counters */
+static long long frame_times[CLOCK_HISTORY];
+static int frame_pos, frame_len;
+static long long frame_last, frame_total;
+static int frames_missed, frames_counted;
+
 
 
 
@@ -19,45 +30,191 @@ int clock_ms()
 
 
 
+/*
+ * return a monotonic timestamp in nanoseconds; only differences between
+ * two timestamps are meaningful
+ */
+long long clock_ns()
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (long long)ts.tv_sec * NS_PER_SEC + ts.tv_nsec;
+}
+
+
+
+
 /*
  * keep time
  */
 int clock_wait(int fps)
 {
-	int pf;      /* how many ticks should we take per-frame? */
-	int diff;    /* how much time has passed? */
+	long long now;       /* the current time */
+	long long period;    /* how many nanoseconds should each frame get? */
+	long long deadline;  /* when should this frame end? */
+	long long late;      /* how far past the deadline are we? */
+	int skip;
 
-	/* record of SDL tick at last call, to gauge how much time has been spent */
-	static int ticks = 0;
+	if( fps <= 0 )
+		return 0;
 
-	/* how many milliseconds should this frame get? */
-	pf = 1000 / fps;
+	now = clock_ns();
 
-	/* and how much has it had? */
-	diff = SDL_GetTicks() - ticks;
+	/*
+	 * on the first call, or when the frame rate changes, restart
+	 * the deadline grid at the current time.
+	 */
+	if( fps != pace_fps )
+		{
+			pace_fps = fps;
+			pace_base = now;
+			pace_n = 0;
+			frame_last = now;
+			return 0;
+		}
 
 	/*
-	 * if less time has elapsed than the frame needed, delay for the
-	 * difference
+	 * the deadline is computed from the frame count rather than
+	 * accumulated, so 60 fps really is 60 fps, not 1000/16.
 	 */
-	if( diff < pf )
+	period = NS_PER_SEC / fps;
+	pace_n++;
+	deadline = pace_base + pace_n * NS_PER_SEC / fps;
+
+	if( now < deadline )
 		{
-			SDL_Delay(pf - diff);
+			/* sleep off most of the remainder, then spin out the rest */
+			clock_sleep_until(deadline);
+			record_frame(clock_ns(), 0);
 
-			/* save the new ticks */
-			ticks = SDL_GetTicks();
+			if( stats_active )
+				stats_time[STATS_WAIT] += clock_ns() - now;
 			return 0;
-
 		}
 	else
 		{
 			/*
-			 * no .. so save the current ticks and return
-			 * the # of frames that must be skipped
+			 * we've missed the deadline .. skip ahead on the grid so we
+			 * don't try to catch up by running frames back-to-back, and
+			 * return the # of frames that must be skipped
 			 */
-			ticks = SDL_GetTicks();
-			return diff / pf;
+			late = now - deadline;
+			skip = (int)(late / period);
+			pace_n += skip;
+
+			record_frame(now, 1);
+			return skip + 1;
+		}
+
+}
+
+
+
+
+/*
+ * retrieve the frame-time statistics gathered by clock_wait()
+ */
+void clock_get_stats(frame_timing *res)
+{
+	long long sorted[CLOCK_HISTORY];
+	int i;
+
+	res->frames = frames_counted;
+	res->missed = frames_missed;
+
+	/* nothing recorded yet? */
+	if( !frame_len )
+		{
+			res->mean = res->p99 = res->worst = 0;
+			return;
+		}
+
+	/* mean over the sampled window, in microseconds */
+	res->mean = (int)(frame_total / frame_len / 1000);
+
+	/* sort a copy of the window to find the 99th percentile and the worst */
+	for( i=0; i < frame_len; i++ )
+		sorted[i] = frame_times[i];
+	qsort(sorted, frame_len, sizeof(long long), compare_ns);
+
+	res->p99 = (int)(sorted[(frame_len * 99 + 99) / 100 - 1] / 1000);
+	res->worst = (int)(sorted[frame_len - 1] / 1000);
+}
 
+
+
+
+/*
+ * forget all the frame-time statistics
+ */
+void clock_reset_stats()
+{
+	frame_pos = frame_len = 0;
+	frame_total = 0;
+	frames_missed = frames_counted = 0;
+}
+
+
+
+
+/*
+ * wait until the given monotonic timestamp.  the scheduler's wakeup
+ * is only accurate to a millisecond or so, so sleep until just short
+ * of the deadline and busy-wait through the rest.
+ */
+static void clock_sleep_until(long long deadline)
+{
+	long long remain;
+	struct timespec ts;
+
+	remain = deadline - clock_ns() - CLOCK_SPIN_NS;
+	if( remain > 0 )
+		{
+			ts.tv_sec = remain / NS_PER_SEC;
+			ts.tv_nsec = remain % NS_PER_SEC;
+			nanosleep(&ts, NULL);
 		}
 
+	while( clock_ns() < deadline )
+		;
+}
+
+
+
+
+/*
+ * add the time since the last frame to the statistics window
+ */
+static void record_frame(long long now, int missed)
+{
+	long long elapsed;
+
+	elapsed = now - frame_last;
+	frame_last = now;
+
+	/* drop the oldest sample once the window is full */
+	if( frame_len == CLOCK_HISTORY )
+		frame_total -= frame_times[frame_pos];
+	else
+		frame_len++;
+
+	frame_times[frame_pos] = elapsed;
+	frame_total += elapsed;
+	frame_pos = (frame_pos + 1) % CLOCK_HISTORY;
+
+	frames_counted++;
+	frames_missed += missed;
+}
+
+
+
+
+/*
+ * a qsort comparator for nanosecond counts
+ */
+static int compare_ns(const void *a, const void *b)
+{
+	long long x = *(const long long *)a, y = *(const long long *)b;
+	return (x > y) - (x < y);
 }
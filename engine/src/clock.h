@@ -2,5 +2,26 @@
  * some function prototypes
  */
 
+/* nanoseconds per second */
+#define NS_PER_SEC 1000000000LL
+
+/* how long before a deadline clock_wait() stops sleeping and starts spinning */
+#define CLOCK_SPIN_NS 1500000LL
+
+/* how many frame times are kept for the statistics */
+#define CLOCK_HISTORY 256
+
 int clock_ms();
+long long clock_ns();
 int clock_wait(int);
+void clock_get_stats(frame_timing *);
+void clock_reset_stats();
+
+static void clock_sleep_until(long long);
+static void record_frame(long long, int);
+static int compare_ns(const void *, const void *);
+
+
+/* from stats.c */
+extern int stats_active;
+extern long long stats_time[];
@@ -11,6 +11,22 @@
  * and store the result in *res ..
  */
 void collision_with_map(sprite *s, map *m, int slip, map_collision *res)
+{
+	long long t;
+
+	STATS_START(t);
+	trace_map_collision(s, m, slip, res);
+	STATS_STOP(STATS_COLLISION, t);
+}
+
+
+
+
+/*
+ * trace the sprite's motion across the map, one step at a time,
+ * until it hits something
+ */
+static void trace_map_collision(sprite *s, map *m, int slip, map_collision *res)
 {
 	point ofs;               /* the offset for the sprite as we trace its motion */
 	point mot;               /* motion-adders, most useful with slip engaged */
@@ -363,12 +379,14 @@ static int map_sprite_test(map *map, sprite *s, int xofs, int yofs)
 	box clip, sbox, tbox;
 	vector clip_adj;
 
-	/* pointers into the map and to the current sprite frame */
+	/* pointers into the map and to the current sprite frame, and to a copy of it at its scaled size */
 	tile *t;
-	frame *f;
+	frame *f, *sf;
 	dimensions span, tspan;
 
 
+	STATS_COUNT(STATS_COLLISION_TESTS, 1);
+
 	/* set the range for the sprite bounding box, for the simple bounds test */
 	range.x1 = s->bc.x1 + xofs;
 	range.y1 = s->bc.y1 + yofs;
@@ -421,6 +439,19 @@ static int map_sprite_test(map *map, sprite *s, int xofs, int yofs)
 	/* set the initial conditions for sprite and tile frame bounds, for pixel-accurate collisions */
 	sbox = s->bc;
 
+	/*
+	 * a pixel-accurate sprite frame is tested as it's drawn, through a
+	 * copy of it scaled or turned if need be, or otherwise scaled as it's
+	 * tested
+	 */
+	f = s->frames[s->cur_frame].stack[0];
+	sf = f;
+	if( s->collides == COLLISION_PIXEL )
+		{
+			release_scaled_frames();
+			sf = test_frame(s, f, &span);
+		}
+
 	tbox.x1 = range.x1 * map->tw;
 	tbox.y1 = range.y1 * map->th;
 	tbox.x2 = tbox.x1 + map->tw;
@@ -443,7 +474,6 @@ static int map_sprite_test(map *map, sprite *s, int xofs, int yofs)
 						{
 
 							t = map->tiles[ *(map->data + loc.x + loc.y * map->w) ];
-							f = s->frames[s->cur_frame].stack[0];
 
 							if( t )
 								{
@@ -458,30 +488,26 @@ static int map_sprite_test(map *map, sprite *s, int xofs, int yofs)
 									else if( t->collides == COLLISION_BOX && s->collides == COLLISION_PIXEL )
 										{
 
-											/* is the sprite scaled in either direction? */
-											if( s->scale.x != fp_set(1) || s->scale.y != fp_set(1) )
+											/* is the sprite scaled or turned, with no copy to test? */
+											if( !sf )
 												{
-													/* calculate the new frame span */
-													span.w = fp_int(f->w * s->scale.x);
-													span.h = fp_int(f->h * s->scale.y);
-
-													if( pixel_region_test_scaled( f, &span, clip ) )
+													/* a turned sprite that can't be tested turned collides by its bounds */
+													if( s->turn || pixel_region_test_scaled( f, &span, clip ) )
 														return 1;
 
 												}
-											else if( pixel_region_test( f, clip ) )
+											else if( pixel_region_test( sf, clip ) )
 												return 1;
 
 										}
 									else if( t->collides == COLLISION_PIXEL && s->collides == COLLISION_PIXEL )
 										{
 
-											/* is the sprite scaled in either direction? */
-											if( s->scale.x != fp_set(1) || s->scale.y != fp_set(1) )
+											/* is the sprite scaled or turned, with no copy to test? */
+											if( !sf )
 												{
-													/* calculate the new frame span */
-													span.w = fp_int(f->w * s->scale.x);
-													span.h = fp_int(f->h * s->scale.y);
+													if( s->turn )
+														return 1;
 
 													/* tiles cannot be resized, so the tile span is fixed to the actual tile size */
 													tspan.w = t->frames[t->cur_frame]->w;
@@ -491,7 +517,7 @@ static int map_sprite_test(map *map, sprite *s, int xofs, int yofs)
 														return 1;
 
 												}
-											else if( pixel_intersect_test( f, sbox, t->frames[t->cur_frame], tbox) )
+											else if( pixel_intersect_test( sf, sbox, t->frames[t->cur_frame], tbox) )
 												return 1;
 
 
@@ -562,6 +588,8 @@ int collision_with_sprites(sprite *s, list *l, int limit, sprite_collision *res)
 	/* how many results? */
 	int resct;
 
+	long long t;
+
 	/* fetch the pointer and verify */
 	if( !s || !l )
 		return 0;
@@ -572,6 +600,7 @@ int collision_with_sprites(sprite *s, list *l, int limit, sprite_collision *res)
 
 
 	/* now, start walking the list .. */
+	STATS_START(t);
 	iterator_start(iter, l);
 	resct = 0;
 
@@ -601,6 +630,7 @@ int collision_with_sprites(sprite *s, list *l, int limit, sprite_collision *res)
 
 
 	/* ok!  return the results .. */
+	STATS_STOP(STATS_COLLISION, t);
 	return resct;
 
 }
@@ -848,8 +878,11 @@ static int sprite_sprite_test(sprite *s, int xofs, int yofs, sprite *tgt)
 {
 	box sbox,tbox;      /* the sprite's and target's ranges */
 	frame *sfr, *tfr;   /* the colliding sprite frames */
+	frame *ssf, *tsf;   /* and copies of them at their scaled sizes */
 	dimensions sspan, tspan;
 
+	STATS_COUNT(STATS_COLLISION_TESTS, 1);
+
 	/* make a local copy of the origin sprite's bounds cache and adjust by the given offset */
 	sbox = s->bc;
 	sbox.x1 += xofs;
@@ -868,6 +901,8 @@ static int sprite_sprite_test(sprite *s, int xofs, int yofs, sprite *tgt)
 
 			sfr = s->frames[s->cur_frame].stack[0];
 			tfr = tgt->frames[tgt->cur_frame].stack[0];
+			release_scaled_frames();
+
 			/*
 			 * perform the correct test, of the three possible combinations
 			 * of collision tests
@@ -881,18 +916,15 @@ static int sprite_sprite_test(sprite *s, int xofs, int yofs, sprite *tgt)
 					tbox.x2 -= sbox.x1 + xofs;
 					tbox.y2 -= sbox.y1 + yofs;
 
-					/* is the sprite scaled in either direction? */
-					if( s->scale.x != fp_set(1) || s->scale.y != fp_set(1) )
-						{
-							/* calculate the new frame span */
-							sspan.w = fp_int(sfr->w * s->scale.x);
-							sspan.h = fp_int(sfr->h * s->scale.y);
+					/* test the frame as it's drawn, or scaled as it's tested if there's no copy of it to be had */
+					if( (ssf = test_frame(s, sfr, &sspan)) )
+						return pixel_region_test( ssf, tbox );
 
-							return( pixel_region_test_scaled( sfr, &sspan, tbox ) );
+					/* a turned sprite that can't be tested turned collides by its bounds */
+					if( s->turn )
+						return 1;
 
-						}
-					else
-						return pixel_region_test( sfr, tbox );
+					return( pixel_region_test_scaled( sfr, &sspan, tbox ) );
 
 				}
 			else if( s->collides == COLLISION_BOX && tgt->collides == COLLISION_PIXEL )
@@ -902,38 +934,28 @@ static int sprite_sprite_test(sprite *s, int xofs, int yofs, sprite *tgt)
 					sbox.x2 -= tbox.x1 - xofs;
 					sbox.y2 -= tbox.y1 - yofs;
 
-					/* is the sprite scaled in either direction? */
-					if( tgt->scale.x != fp_set(1) || tgt->scale.y != fp_set(1) )
-						{
-							/* calculate the new frame span */
-							tspan.w = fp_int(tfr->w * tgt->scale.x);
-							tspan.h = fp_int(tfr->h * tgt->scale.y);
+					if( (tsf = test_frame(tgt, tfr, &tspan)) )
+						return pixel_region_test( tsf, sbox );
 
-							return( pixel_region_test_scaled( tfr, &tspan, sbox ) );
+					if( tgt->turn )
+						return 1;
 
-						}
-					else
-						return pixel_region_test( tfr, sbox );
+					return( pixel_region_test_scaled( tfr, &tspan, sbox ) );
 
 				}
 			else
 				{
 
-					/* is either sprite scaled in either direction? */
-					if( s->scale.x != fp_set(1) || s->scale.y != fp_set(1) || tgt->scale.x != fp_set(1) || tgt->scale.y != fp_set(1) )
-						{
-							/* calculate the new frame spans */
-							sspan.w = fp_int(sfr->w * s->scale.x);
-							sspan.h = fp_int(sfr->h * s->scale.y);
-
-							tspan.w = fp_int(tfr->w * tgt->scale.x);
-							tspan.h = fp_int(tfr->h * tgt->scale.y);
+					/* a frame drawn as it is is its own copy, so both need one to be tested as they are */
+					ssf = test_frame(s, sfr, &sspan);
+					tsf = test_frame(tgt, tfr, &tspan);
+					if( ssf && tsf )
+						return pixel_intersect_test( ssf, sbox, tsf, tbox );
 
-							return( pixel_intersect_test_scaled( sfr, &sspan, sbox, tfr, &tspan, tbox ) );
+					if( s->turn || tgt->turn )
+						return 1;
 
-						}
-					else
-						return pixel_intersect_test( sfr, sbox, tfr, tbox );
+					return( pixel_intersect_test_scaled( sfr, &sspan, sbox, tfr, &tspan, tbox ) );
 
 				}
 
@@ -953,6 +975,33 @@ static int sprite_sprite_test(sprite *s, int xofs, int yofs, sprite *tgt)
 
 
 
+/*
+ * the frame to test a sprite frame through, as it's drawn:  the frame
+ * itself, or a copy of it scaled or turned.  returns NULL if there's
+ * no copy to be had, leaving the span it's drawn over to scale it by.
+ */
+static frame *test_frame(sprite *s, frame *f, dimensions *span)
+{
+	span->w = fp_int(f->w * s->scale.x);
+	span->h = fp_int(f->h * s->scale.y);
+
+	if( s->turn )
+		return rotated_frame(f, span, s->turn);
+
+	return scaled_frame(f, span);
+}
+
+
+
+
+
+
+
+
+
+
+
+
 /*
  * expand each sprite + motion out into a great big box and check for overlap
  */
@@ -1032,14 +1081,14 @@ static int pixel_region_test(frame *fr, box rect)
 
 
 	/* set up the pointer into the pixel data and check each pixel for 1 */
-	ptr = fr->mask + rect.x1 + rect.y1 * fr->w;
+	ptr = fr->mask + rect.x1 + rect.y1 * fr->stride;
 	while( rect.y1 < rect.y2 )
 		{
 			/* scan the line for set pixels */
 			if( pixel_region_line(rect.x2 - rect.x1, ptr) )
 				return 1;
 
-			ptr += fr->w;
+			ptr += fr->stride;
 			rect.y1++;
 
 		}
@@ -1087,7 +1136,7 @@ static int pixel_region_test_scaled(frame *fr, dimensions *span, box rect)
 	scan.y = fp_frac(rect.y1 * inc.y);
 
 	/* set up the pointer into the pixel data and check each pixel for 1 */
-	ptr = fr->mask + fp_int(rect.x1 * inc.x) + fp_int(rect.y1 * inc.y) * fr->w;
+	ptr = fr->mask + fp_int(rect.x1 * inc.x) + fp_int(rect.y1 * inc.y) * fr->stride;
 	while( rect.y1 < rect.y2 )
 		{
 			/* scan the scaled line for set pixels */
@@ -1098,7 +1147,7 @@ static int pixel_region_test_scaled(frame *fr, dimensions *span, box rect)
 			scan.y += inc.y;
 			if( scan.y >= fp_set(1) )
 				{
-					ptr += fp_int(scan.y) * fr->w;
+					ptr += fp_int(scan.y) * fr->stride;
 					scan.y = fp_frac(scan.y);
 				}
 
@@ -1180,8 +1229,8 @@ static int pixel_intersect_test(frame *sfr, box sbox, frame *tfr, box tbox)
 	ibox.y2 = min(sbox.y2, tbox.y2);
 
 	/* now assign the pointers into the pixel mask */
-	sptr = sfr->mask + sfr->w * (ibox.y1 - sbox.y1) + (ibox.x1 - sbox.x1);
-	tptr = tfr->mask + tfr->w * (ibox.y1 - tbox.y1) + (ibox.x1 - tbox.x1);
+	sptr = sfr->mask + sfr->stride * (ibox.y1 - sbox.y1) + (ibox.x1 - sbox.x1);
+	tptr = tfr->mask + tfr->stride * (ibox.y1 - tbox.y1) + (ibox.x1 - tbox.x1);
 
 	/* and check for overlapping pixels */
 	while( ibox.y1 <= ibox.y2 )
@@ -1190,8 +1239,8 @@ static int pixel_intersect_test(frame *sfr, box sbox, frame *tfr, box tbox)
 			if( pixel_intersect_line(ibox.x2 - ibox.x1 + 1, sptr, tptr) )
 				return 1;
 
-			sptr += sfr->w;
-			tptr += tfr->w;
+			sptr += sfr->stride;
+			tptr += tfr->stride;
 			ibox.y1++;
 		}
 
@@ -1239,8 +1288,8 @@ static int pixel_intersect_test_scaled(frame *sfr, dimensions *sspan, box sbox,
 	tscan.y = fp_frac((ibox.y1 - tbox.y1) * tinc.y);
 
 	/* now assign the pointers into the pixel mask */
-	sptr = sfr->mask + sfr->w * fp_int((ibox.y1 - sbox.y1) * sinc.y) + fp_int((ibox.x1 - sbox.x1) * sinc.x);
-	tptr = tfr->mask + tfr->w * fp_int((ibox.y1 - tbox.y1) * tinc.y) + fp_int((ibox.x1 - tbox.x1) * tinc.x);
+	sptr = sfr->mask + sfr->stride * fp_int((ibox.y1 - sbox.y1) * sinc.y) + fp_int((ibox.x1 - sbox.x1) * sinc.x);
+	tptr = tfr->mask + tfr->stride * fp_int((ibox.y1 - tbox.y1) * tinc.y) + fp_int((ibox.x1 - tbox.x1) * tinc.x);
 
 	/* and check for overlapping pixels */
 	while( ibox.y1 <= ibox.y2 )
@@ -1253,14 +1302,14 @@ static int pixel_intersect_test_scaled(frame *sfr, dimensions *sspan, box sbox,
 			sscan.y += sinc.y;
 			if( sscan.y >= fp_set(1) )
 				{
-					sptr += fp_int(sscan.y) * sfr->w;
+					sptr += fp_int(sscan.y) * sfr->stride;
 					sscan.y = fp_frac(sscan.y);
 				}
 
 			tscan.y += tinc.y;
 			if( tscan.y >= fp_set(1) )
 				{
-					tptr += fp_int(tscan.y) * tfr->w;
+					tptr += fp_int(tscan.y) * tfr->stride;
 					tscan.y = fp_frac(tscan.y);
 				}
 
@@ -11,11 +11,13 @@ int collision_with_sprites(sprite *, list *, int, sprite_collision *);
 
 
 /* the rest are for internal computations */
+static void trace_map_collision(sprite *, map *, int, map_collision *);
 static int map_sprite_test(map *, sprite *, int, int);
 
 static void sprite_collision_with_result(sprite *, sprite *, sprite_collision *);
 static int sprite_sweep_test(sprite *, sprite *);
 static int sprite_sprite_test(sprite *, int, int, sprite *);
+static frame *test_frame(sprite *, frame *, dimensions *);
 
 static int pixel_region_test(frame *, box);
 static int pixel_region_test_scaled(frame *, dimensions *, box);
@@ -27,3 +29,17 @@ static int pixel_region_line_scaled(int, int, int, unsigned char *);
 
 static int pixel_intersect_line(int, unsigned char *, unsigned char *);
 static int pixel_intersect_line_scaled(int, int, int, unsigned char *, int, int, unsigned char *);
+
+
+/* from scaled.c */
+extern frame *scaled_frame(frame *, dimensions *);
+extern frame *rotated_frame(frame *, dimensions *, int);
+extern void release_scaled_frames();
+
+/* from stats.c */
+extern int stats_active;
+extern long long stats_time[];
+extern int stats_count[];
+
+/* from clock.c */
+extern long long clock_ns();
@@ -0,0 +1,541 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "SDL.h"
+#include "common.h"
+#include "convolve.h"
+
+#ifdef WITH_SIMD
+#include <mmintrin.h>
+#endif
+
+
+
+/*
+ * convolution doesn't care about the pixel order, so both orders'
+ * convolution blitters clip the frame and hand it over to here.
+ *
+ * a kernel that's the product of a column and a row runs as two
+ * one-dimensional passes, a row pass into a buffer of sums and a
+ * column pass out of it; any other kernel visits only its non-zero
+ * taps.  blurs ignore the kernel, and use running sums, so they cost
+ * the same whatever their radius.  in every case the rows are split
+ * among the worker threads.
+ */
+static int *convo_sums;
+static int convo_sums_size;
+
+static unsigned char *blur_buf;
+static int blur_buf_size;
+
+
+
+/*
+ * multiply-accumulate the four components of a pixel, into either
+ * four ints or, with SIMD, two mmx registers of two ints each
+ */
+#ifdef WITH_SIMD
+
+#define SIMD_ADJ _mm_empty()
+#define MAC_DECLARE __m64 acc01, acc23, px, kx, lo, hi
+#define MAC_ZERO do { acc01 = acc23 = _mm_setzero_si64(); } while(0)
+
+#define MAC(p, k) \
+	do \
+		{ \
+			px = _mm_unpacklo_pi8(_mm_cvtsi32_si64(*(int32_t *)(p)), _mm_setzero_si64()); \
+			kx = _mm_set1_pi16(k); \
+			lo = _mm_mullo_pi16(px, kx); \
+			hi = _mm_mulhi_pi16(px, kx); \
+			acc01 = _mm_add_pi32(acc01, _mm_unpacklo_pi16(lo, hi)); \
+			acc23 = _mm_add_pi32(acc23, _mm_unpackhi_pi16(lo, hi)); \
+		} \
+	while(0)
+
+#define MAC_STORE(ac) \
+	do \
+		{ \
+			(ac)[0] = _mm_cvtsi64_si32(acc01); \
+			(ac)[1] = _mm_cvtsi64_si32(_mm_srli_si64(acc01, 32)); \
+			(ac)[2] = _mm_cvtsi64_si32(acc23); \
+			(ac)[3] = _mm_cvtsi64_si32(_mm_srli_si64(acc23, 32)); \
+		} \
+	while(0)
+
+#else
+
+#define SIMD_ADJ
+#define MAC_DECLARE int acc[4]
+#define MAC_ZERO do { acc[0] = acc[1] = acc[2] = acc[3] = 0; } while(0)
+
+#define MAC(p, k) \
+	do \
+		{ \
+			acc[0] += *(p)     * (k); \
+			acc[1] += *((p)+1) * (k); \
+			acc[2] += *((p)+2) * (k); \
+			acc[3] += *((p)+3) * (k); \
+		} \
+	while(0)
+
+#define MAC_STORE(ac) \
+	do \
+		{ \
+			(ac)[0] = acc[0]; \
+			(ac)[1] = acc[1]; \
+			(ac)[2] = acc[2]; \
+			(ac)[3] = acc[3]; \
+		} \
+	while(0)
+
+#endif
+
+
+/* apply the divisor and offset, and pin the result to 0..255 */
+#define CONVO_RESULT(tgt, ac, job) \
+	do \
+		{ \
+			int c_, v_; \
+			for( c_=0; c_ < RGBA_BYTES; c_++ ) \
+				{ \
+					v_ = libdivide_s32_do((ac)[c_], &(job)->div) + (job)->convo->offset; \
+					(tgt)[c_] = v_ < 0 ? 0 : v_ > RGB_MAX ? RGB_MAX : v_; \
+				} \
+		} \
+	while(0)
+
+
+
+
+
+/*
+ * run a convolution frame over the clipped area of the target.  the
+ * clipped area includes the kernel's reach beyond the frame, given
+ * in kofs.
+ */
+void convolve(frame *dest, frame *f, struct clip *cres, box *kofs)
+{
+	struct convo_job job;
+	convolution *convo;
+	unsigned char *src, *tgt;
+	int i, j, size;
+
+	convo = f->aux;
+
+	/* blurs are a different beast altogether */
+	if( convo->mode != CONVO_KERNEL )
+		{
+			blur(dest, f, cres);
+			return;
+		}
+
+	/* the area read, and the smaller area written */
+	job.src = (unsigned char *)dest->data + (cres->dx + dest->w * cres->dy) * RGBA_BYTES;
+	job.pitch = dest->w;
+	job.mask = (unsigned char *)f->data + cres->sx + f->stride * cres->sy;
+	job.mask_pitch = f->stride;
+	job.ow = cres->dw - convo->kw + 1;
+	job.oh = cres->dh - convo->kh + 1;
+	job.convo = convo;
+	job.kofs = *kofs;
+	job.div = libdivide_s32_gen(convo->divisor);
+
+	/* the results go on the scratchpad, as the target is still being read */
+	adjust_scratchpad(job.ow, job.oh);
+	job.out = scratchpad;
+
+	if( separable(convo, job.row, job.col) )
+		{
+			/* the row pass covers every row read, the column pass every row written */
+			size = cres->dh * job.ow * RGBA_BYTES;
+			if( size > convo_sums_size )
+				{
+					convo_sums = ck_realloc(convo_sums, size * sizeof(int));
+					convo_sums_size = size;
+				}
+			job.sums = convo_sums;
+
+			workers_run(cres->dh, job.ow * convo->kw, convo_rows, &job);
+			workers_run(job.oh, job.ow * convo->kh, convo_cols, &job);
+		}
+	else
+		{
+			/* note the kernel's non-zero taps, and where they reach */
+			job.taps = 0;
+			for( i=0; i < convo->kh; i++ )
+				for( j=0; j < convo->kw; j++ )
+					if( convo->kernel[i * convo->kw + j] )
+						{
+							job.tap_ofs[job.taps] = (j + i * job.pitch) * RGBA_BYTES;
+							job.tap_k[job.taps] = convo->kernel[i * convo->kw + j];
+							job.taps++;
+						}
+
+			workers_run(job.oh, job.ow * job.taps, convo_direct, &job);
+		}
+
+
+	/* copy the scratchpad back onto the target */
+	src = scratchpad;
+	tgt = job.src + (kofs->x1 + dest->w * kofs->y1) * RGBA_BYTES;
+
+	for( i=0; i < job.oh; i++ )
+		{
+			memcpy(tgt, src, job.ow * RGBA_BYTES);
+			src += job.ow * RGBA_BYTES;
+			tgt += dest->w * RGBA_BYTES;
+		}
+
+}
+
+
+
+
+
+/*
+ * is the kernel a column times a row?  if so, find them in whole
+ * numbers, so the two passes add up to exactly what the kernel
+ * would.  the row is the first non-zero row of the kernel, divided
+ * through by its common factor, and every other row must be a whole
+ * multiple of it.
+ */
+static int separable(convolution *convo, int *row, int *col)
+{
+	int i, j, k, r0, j0, a, b, t;
+	char *kernel;
+
+	kernel = convo->kernel;
+
+	/* small kernels gain nothing from splitting */
+	if( convo->kw * convo->kh <= convo->kw + convo->kh )
+		return 0;
+
+	/* find the first non-zero entry */
+	for( k=0; k < convo->kw * convo->kh && !kernel[k]; k++ )
+		;
+	if( k == convo->kw * convo->kh )
+		return 0;
+
+	r0 = k / convo->kw;
+	j0 = k % convo->kw;
+
+	/* take that row, over the greatest common divisor of its entries */
+	a = 0;
+	for( j=0; j < convo->kw; j++ )
+		{
+			b = abs(kernel[r0 * convo->kw + j]);
+			while( b )
+				{
+					t = a % b;
+					a = b;
+					b = t;
+				}
+		}
+
+	for( j=0; j < convo->kw; j++ )
+		row[j] = kernel[r0 * convo->kw + j] / a;
+
+	/* and check that each row is a multiple of it */
+	for( i=0; i < convo->kh; i++ )
+		{
+			if( kernel[i * convo->kw + j0] % row[j0] )
+				return 0;
+
+			col[i] = kernel[i * convo->kw + j0] / row[j0];
+			for( j=0; j < convo->kw; j++ )
+				if( kernel[i * convo->kw + j] != col[i] * row[j] )
+					return 0;
+		}
+
+	return 1;
+
+}
+
+
+
+
+
+/*
+ * a band of rows of an unseparable kernel
+ */
+static void convo_direct(void *data, int y1, int y2)
+{
+	struct convo_job *job;
+	unsigned char *src, *mask, *tgt;
+	int x, y, t, center;
+	int ac[4];
+	MAC_DECLARE;
+
+	job = data;
+	center = (job->kofs.x1 + job->pitch * job->kofs.y1) * RGBA_BYTES;
+
+	for( y=y1; y < y2; y++ )
+		{
+			src = job->src + y * job->pitch * RGBA_BYTES;
+			mask = job->mask + y * job->mask_pitch;
+			tgt = job->out + y * job->ow * RGBA_BYTES;
+
+			for( x=0; x < job->ow; x++ )
+				{
+					/* if the pixel mask is set for this pixel, operate .. */
+					if( mask[x] )
+						{
+							MAC_ZERO;
+							for( t=0; t < job->taps; t++ )
+								MAC(src + job->tap_ofs[t], job->tap_k[t]);
+							MAC_STORE(ac);
+							CONVO_RESULT(tgt, ac, job);
+						}
+
+					/* .. otherwise copy the pixel under the kernel's center */
+					else
+						*(int32_t *)tgt = *(int32_t *)(src + center);
+
+					src += RGBA_BYTES;
+					tgt += RGBA_BYTES;
+				}
+		}
+
+	SIMD_ADJ;
+
+}
+
+
+
+
+
+/*
+ * a band of rows of the row pass of a separable kernel:  each row of
+ * the area read is run through the kernel's row, into the sums
+ */
+static void convo_rows(void *data, int y1, int y2)
+{
+	struct convo_job *job;
+	unsigned char *src;
+	int *sum;
+	int x, y, l;
+	MAC_DECLARE;
+
+	job = data;
+
+	for( y=y1; y < y2; y++ )
+		{
+			src = job->src + y * job->pitch * RGBA_BYTES;
+			sum = job->sums + y * job->ow * RGBA_BYTES;
+
+			for( x=0; x < job->ow; x++ )
+				{
+					MAC_ZERO;
+					for( l=0; l < job->convo->kw; l++ )
+						MAC(src + l * RGBA_BYTES, job->row[l]);
+					MAC_STORE(sum);
+
+					src += RGBA_BYTES;
+					sum += RGBA_BYTES;
+				}
+		}
+
+	SIMD_ADJ;
+
+}
+
+
+
+
+
+/*
+ * a band of rows of the column pass:  the sums are run down the
+ * kernel's column, for the pixels the mask lets through
+ */
+static void convo_cols(void *data, int y1, int y2)
+{
+	struct convo_job *job;
+	unsigned char *src, *mask, *tgt;
+	int *sum;
+	int x, y, k, center, stride;
+	int ac[4];
+
+	job = data;
+	center = (job->kofs.x1 + job->pitch * job->kofs.y1) * RGBA_BYTES;
+	stride = job->ow * RGBA_BYTES;
+
+	for( y=y1; y < y2; y++ )
+		{
+			src = job->src + y * job->pitch * RGBA_BYTES;
+			mask = job->mask + y * job->mask_pitch;
+			tgt = job->out + y * stride;
+			sum = job->sums + y * stride;
+
+			for( x=0; x < job->ow; x++ )
+				{
+					if( mask[x] )
+						{
+							ac[0] = ac[1] = ac[2] = ac[3] = 0;
+							for( k=0; k < job->convo->kh; k++ )
+								{
+									ac[0] += sum[k * stride]     * job->col[k];
+									ac[1] += sum[k * stride + 1] * job->col[k];
+									ac[2] += sum[k * stride + 2] * job->col[k];
+									ac[3] += sum[k * stride + 3] * job->col[k];
+								}
+							CONVO_RESULT(tgt, ac, job);
+						}
+					else
+						*(int32_t *)tgt = *(int32_t *)(src + center);
+
+					src += RGBA_BYTES;
+					sum += RGBA_BYTES;
+					tgt += RGBA_BYTES;
+				}
+		}
+
+}
+
+
+
+
+
+/*
+ * blur the clipped area under a blur frame, and let the blurred pixels
+ * through wherever its mask is set.  a box blur takes the mean of the
+ * square of pixels around each one, a row pass and then a column pass,
+ * with pixels past the edge of the area taken from the edge.  a
+ * gaussian blur is a few box blurs, one after another.
+ */
+static void blur(frame *dest, frame *f, struct clip *cres)
+{
+	struct convo_job job;
+	unsigned char *src, *mask, *tgt;
+	int i, x, y, size;
+
+	job.convo = f->aux;
+	job.pitch = dest->w;
+	job.ow = cres->dw;
+	job.oh = cres->dh;
+	job.radius = min(max(job.convo->radius, 1), MAX_BLUR_RADIUS);
+	job.span = 2 * job.radius + 1;
+	job.recip = ((1 << 16) + job.span / 2) / job.span;
+
+	/* blur a copy of the area, with the scratchpad in between passes */
+	size = job.ow * job.oh * RGBA_BYTES;
+	if( size > blur_buf_size )
+		{
+			blur_buf = ck_realloc(blur_buf, size);
+			blur_buf_size = size;
+		}
+	adjust_scratchpad(job.ow, job.oh);
+
+	src = (unsigned char *)dest->data + (cres->dx + dest->w * cres->dy) * RGBA_BYTES;
+	for( y=0; y < job.oh; y++ )
+		memcpy(blur_buf + y * job.ow * RGBA_BYTES, src + y * dest->w * RGBA_BYTES, job.ow * RGBA_BYTES);
+
+	for( i=0; i < (job.convo->mode == CONVO_GAUSSIAN ? GAUSSIAN_PASSES : 1); i++ )
+		{
+			job.src = blur_buf;
+			job.out = scratchpad;
+			workers_run(job.oh, job.ow * RGBA_BYTES, blur_rows, &job);
+
+			job.src = scratchpad;
+			job.out = blur_buf;
+			workers_run(job.oh, job.ow * RGBA_BYTES, blur_cols, &job);
+		}
+
+	/* and put back the blurred pixels the mask lets through */
+	for( y=0; y < job.oh; y++ )
+		{
+			mask = (unsigned char *)f->data + cres->sx + f->stride * (cres->sy + y);
+			tgt = src + y * dest->w * RGBA_BYTES;
+			for( x=0; x < job.ow; x++ )
+				if( mask[x] )
+					*(int32_t *)(tgt + x * RGBA_BYTES) = *(int32_t *)(blur_buf + (x + y * job.ow) * RGBA_BYTES);
+		}
+
+}
+
+
+
+
+
+/*
+ * a band of rows of a box blur's row pass.  the running sum for each
+ * component adds the pixel entering the window and drops the one
+ * leaving it.
+ */
+static void blur_rows(void *data, int y1, int y2)
+{
+	struct convo_job *job;
+	unsigned char *src, *tgt;
+	int x, y, c, k, last, sum;
+
+	job = data;
+	last = job->ow - 1;
+
+	for( y=y1; y < y2; y++ )
+		{
+			src = job->src + y * job->ow * RGBA_BYTES;
+			tgt = job->out + y * job->ow * RGBA_BYTES;
+
+			for( c=0; c < RGBA_BYTES; c++ )
+				{
+					/* the window around the first pixel, reaching past the left edge */
+					sum = (job->radius + 1) * src[c];
+					for( k=1; k <= job->radius; k++ )
+						sum += src[min(k, last) * RGBA_BYTES + c];
+
+					for( x=0; x <= last; x++ )
+						{
+							tgt[x * RGBA_BYTES + c] = (sum * job->recip + (1 << 15)) >> 16;
+							sum += src[min(x + job->radius + 1, last) * RGBA_BYTES + c];
+							sum -= src[max(x - job->radius, 0) * RGBA_BYTES + c];
+						}
+				}
+		}
+
+}
+
+
+
+
+
+/*
+ * a band of rows of a box blur's column pass.  the running sums are
+ * kept for a whole row at a time, so the rows are read in order.
+ */
+static void blur_cols(void *data, int y1, int y2)
+{
+	struct convo_job *job;
+	unsigned char *add, *drop, *tgt;
+	int *sums;
+	int i, y, k, last, stride;
+
+	job = data;
+	last = job->oh - 1;
+	stride = job->ow * RGBA_BYTES;
+	sums = ck_malloc(stride * sizeof(int));
+
+	/* the window around the band's first row */
+	for( i=0; i < stride; i++ )
+		sums[i] = 0;
+	for( k = -job->radius; k <= job->radius; k++ )
+		{
+			add = job->src + min(max(y1 + k, 0), last) * stride;
+			for( i=0; i < stride; i++ )
+				sums[i] += add[i];
+		}
+
+	for( y=y1; y < y2; y++ )
+		{
+			tgt = job->out + y * stride;
+			for( i=0; i < stride; i++ )
+				tgt[i] = (sums[i] * job->recip + (1 << 15)) >> 16;
+
+			/* slide the window down a row */
+			add = job->src + min(y + job->radius + 1, last) * stride;
+			drop = job->src + max(y - job->radius, 0) * stride;
+			for( i=0; i < stride; i++ )
+				sums[i] += add[i] - drop[i];
+		}
+
+	free(sums);
+
+}
@@ -0,0 +1,55 @@
+/*
+ * convolution and blurring, for both pixel orders
+ */
+
+/* a gaussian blur is approximated by this many box blurs */
+#define GAUSSIAN_PASSES 3
+
+struct convo_job
+{
+	unsigned char *src;      /* the top left of the area read, in the target frame */
+	int pitch;               /* the target frame's row pitch, in pixels */
+	unsigned char *mask;     /* the convolution frame's pixel mask, at the same spot */
+	int mask_pitch;
+	unsigned char *out;      /* the results, ow pixels to a row */
+	int ow, oh;
+	convolution *convo;
+	box kofs;
+	struct libdivide_s32_t div;
+
+	/* the kernel's non-zero taps, as byte offsets from the top left of the kernel */
+	int taps;
+	int tap_ofs[MAX_CK_SIZE*MAX_CK_SIZE], tap_k[MAX_CK_SIZE*MAX_CK_SIZE];
+
+	/* for a separable kernel, its row and column, and the row pass's sums */
+	int row[MAX_CK_SIZE], col[MAX_CK_SIZE];
+	int *sums;
+
+	/* for blurs, the blur's width, and its reciprocal in 16.16 fixed point */
+	int radius, span, recip;
+};
+
+
+
+void convolve(frame *, frame *, struct clip *, box *);
+
+static int separable(convolution *, int *, int *);
+static void convo_direct(void *, int, int);
+static void convo_rows(void *, int, int);
+static void convo_cols(void *, int, int);
+
+static void blur(frame *, frame *, struct clip *);
+static void blur_rows(void *, int, int);
+static void blur_cols(void *, int, int);
+
+
+/* from pixel.c */
+extern unsigned char *scratchpad;
+extern void adjust_scratchpad(int, int);
+
+/* from worker.c */
+extern void workers_run(int, int, void (*)(void *, int, int), void *);
+
+/* from misc.c */
+extern void *ck_malloc(size_t);
+extern void *ck_realloc(void *, size_t);
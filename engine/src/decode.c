@@ -0,0 +1,257 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "common.h"
+#include "decode.h"
+
+
+
+/* base64 character values:  -1 is padding, -2 is anything to be skipped */
+static const signed char base64_values[256] =
+{
+	-2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2,
+	-2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2,
+	-2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, 62, -2, -2, -2, 63,
+	52, 53, 54, 55, 56, 57, 58, 59, 60, 61, -2, -2, -2, -1, -2, -2,
+	-2,  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14,
+	15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, -2, -2, -2, -2, -2,
+	-2, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+	41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, -2, -2, -2, -2, -2,
+	-2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2,
+	-2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2,
+	-2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2,
+	-2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2,
+	-2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2,
+	-2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2,
+	-2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2,
+	-2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2
+};
+
+
+
+
+
+/*
+ * decode embedded asset data in a single pass.  the flags pick the
+ * stages, which always run in this order:
+ * - DECODE_BASE64 decodes base64 text, skipping whitespace and stopping at padding.
+ * - DECODE_LZ77 expands lz77 data, as written by lzbetool.
+ * - DECODE_BXDIV strips the bxdiv header and repeats every byte by its divisor.
+ *
+ * the result is allocated, and its length stored in *out_len.  on
+ * malformed input NULL is returned.
+ */
+unsigned char *decode_buffer(int flags, int len, const unsigned char *in, int *out_len)
+{
+	struct decoder d;
+	int c;
+
+	/* failsafe */
+	if( !in || len < 0 || !out_len )
+		return NULL;
+
+	memset(&d, 0, sizeof(d));
+	d.in = in;
+	d.in_len = len;
+	d.flags = flags;
+	d.divisor = 1;
+
+	/* base64 shrinks by a quarter, the rest only grows:  start at the input size */
+	d.out_size = len > 16 ? len : 16;
+	d.out = ck_malloc(d.out_size);
+
+	/* run the input through the stages */
+	if( flags & DECODE_LZ77 )
+		c = expand_lz77(&d);
+	else
+		{
+			while( (c = next_byte(&d)) >= 0 )
+				if( put_byte(&d, c) == ERR )
+					break;
+		}
+
+	/* a stage failed, or the bxdiv header never finished? */
+	if( c == ERR || ((flags & DECODE_BXDIV) && d.lz_len < BXDIV_HEADER) )
+		{
+			free(d.out);
+			return NULL;
+		}
+
+	*out_len = d.out_len;
+	return d.out;
+
+}
+
+
+
+
+
+
+
+/*
+ * expand the lz77 stream.  a byte other than the escapes is a literal;
+ * escape 1 is followed either by an escaped literal escape byte, or by
+ * a one-byte length and offset; escape 2 by a two-byte big-endian
+ * length and offset.  returns 0 at the end of the input, or ERR.
+ */
+static int expand_lz77(struct decoder *d)
+{
+	int c, length, offset, b1, b2;
+
+	while( (c = next_byte(d)) >= 0 )
+		{
+			if( c == LZ_ESCAPE1 )
+				{
+					if( (c = next_byte(d)) < 0 )
+						return ERR;
+
+					/* an escaped escape is a literal */
+					if( c == LZ_ESCAPE1 || c == LZ_ESCAPE2 )
+						{
+							if( put_byte(d, c) == ERR )
+								return ERR;
+							continue;
+						}
+
+					length = c;
+					if( (offset = next_byte(d)) < 0 )
+						return ERR;
+				}
+			else if( c == LZ_ESCAPE2 )
+				{
+					if( (b1 = next_byte(d)) < 0 || (b2 = next_byte(d)) < 0 )
+						return ERR;
+					length = (b1 << 8) | b2;
+
+					if( (b1 = next_byte(d)) < 0 || (b2 = next_byte(d)) < 0 )
+						return ERR;
+					offset = (b1 << 8) | b2;
+				}
+			else
+				{
+					if( put_byte(d, c) == ERR )
+						return ERR;
+					continue;
+				}
+
+			/* a back-reference must point into what's already been produced */
+			if( offset <= 0 || offset > d->lz_len )
+				return ERR;
+
+			/* copy a byte at a time, since the copy may overlap itself */
+			while( length-- > 0 )
+				if( put_byte(d, history(d, offset)) == ERR )
+					return ERR;
+
+		}
+
+	return 0;
+
+}
+
+
+
+
+/*
+ * fetch the next input byte, through the base64 stage if it's enabled.
+ * returns -1 at the end of the input.
+ */
+static int next_byte(struct decoder *d)
+{
+	int v;
+
+	if( !(d->flags & DECODE_BASE64) )
+		return d->in_pos < d->in_len ? d->in[d->in_pos++] : -1;
+
+	/* pull in six bits at a time until there's a whole byte */
+	while( d->nbits < 8 )
+		{
+			if( d->in_pos >= d->in_len )
+				return -1;
+
+			v = base64_values[d->in[d->in_pos++]];
+
+			/* padding ends the data; anything else that isn't base64 is skipped */
+			if( v == -1 )
+				{
+					d->in_pos = d->in_len;
+					return -1;
+				}
+			else if( v < 0 )
+				continue;
+
+			d->bits = (d->bits << 6) | v;
+			d->nbits += 6;
+		}
+
+	d->nbits -= 8;
+	return (d->bits >> d->nbits) & 0xff;
+}
+
+
+
+
+/*
+ * store one decoded byte, through the bxdiv stage if it's enabled
+ */
+static int put_byte(struct decoder *d, int c)
+{
+	int i;
+
+	if( d->flags & DECODE_BXDIV )
+		{
+			/* still reading the header? */
+			if( d->lz_len < BXDIV_HEADER )
+				{
+					d->head[d->lz_len++] = c;
+
+					if( d->lz_len == BXDIV_HEADER )
+						{
+							if( memcmp(d->head, BXDIV_MAGIC, strlen(BXDIV_MAGIC)) )
+								return ERR;
+
+							/* divisors below 2 leave the data as it is */
+							d->divisor = d->head[BXDIV_HEADER - 1];
+							if( d->divisor < 2 )
+								d->divisor = 1;
+						}
+
+					return 0;
+				}
+		}
+
+	/* make room, doubling as we go */
+	if( d->out_len + d->divisor > d->out_size )
+		{
+			while( d->out_len + d->divisor > d->out_size )
+				d->out_size *= 2;
+			d->out = ck_realloc(d->out, d->out_size);
+		}
+
+	for( i=0; i < d->divisor; i++ )
+		d->out[d->out_len++] = c;
+
+	d->lz_len++;
+	return 0;
+}
+
+
+
+
+/*
+ * find the byte that was produced the given # of bytes ago, before
+ * any bxdiv repetition.  the caller has already checked the range.
+ */
+static int history(struct decoder *d, int back)
+{
+	int pos;
+
+	pos = d->lz_len - back;
+
+	if( !(d->flags & DECODE_BXDIV) )
+		return d->out[pos];
+	else if( pos < BXDIV_HEADER )
+		return d->head[pos];
+	else
+		return d->out[(pos - BXDIV_HEADER) * d->divisor];
+}
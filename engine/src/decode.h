@@ -0,0 +1,42 @@
+/*
+ * decoders for embedded asset data
+ */
+
+/* a bxdiv stream starts with "bxdiv", a six-digit revision, and the divisor */
+#define BXDIV_MAGIC "bxdiv"
+#define BXDIV_HEADER 12
+
+/* the lz77 escape bytes */
+#define LZ_ESCAPE1 1
+#define LZ_ESCAPE2 2
+
+struct decoder
+{
+	/* the input, and the base64 bit accumulator */
+	const unsigned char *in;
+	int in_len, in_pos;
+	int flags;
+	unsigned int bits;
+	int nbits;
+
+	/* the output buffer */
+	unsigned char *out;
+	int out_len, out_size;
+
+	/* the bxdiv header, the divisor, and the # of bytes lz77 has produced */
+	unsigned char head[BXDIV_HEADER];
+	int divisor;
+	int lz_len;
+};
+
+unsigned char *decode_buffer(int, int, const unsigned char *, int *);
+
+static int next_byte(struct decoder *);
+static int put_byte(struct decoder *, int);
+static int history(struct decoder *, int);
+static int expand_lz77(struct decoder *);
+
+
+/* from misc.c */
+extern void *ck_malloc(size_t);
+extern void *ck_realloc(void *, size_t);
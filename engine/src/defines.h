@@ -16,6 +16,9 @@
 /* maximum convolution-kernel size */
 #define MAX_CK_SIZE 7
 
+/* the largest blur radius */
+#define MAX_BLUR_RADIUS 64
+
 /* how many joysticks?  axes, hats, and buttons perjoystick? */
 #define MAX_JOY 8
 #define MAX_AXES 8
@@ -66,6 +69,21 @@
 
 #define FRAME_EFFECT_DROP_SHADOW 1
 
+/* convolution modes:  the kernel, or a blur of the given radius that ignores it */
+#define CONVO_KERNEL 0
+#define CONVO_BOX 1
+#define CONVO_GAUSSIAN 2
+
+/* frame data that belongs to something else, and mustn't be freed or resized */
+#define FRAME_SHARED_DATA 1
+#define FRAME_SHARED_MASK 2
+
+/* a frame that was deleted while views into it were still alive */
+#define FRAME_DELETED 4
+
+/* a frame (or a view of it) that has had copies kept in the scaled cache */
+#define FRAME_SCALED 8
+
 
 /* animation modes */
 #define ANIMATE_OFF 0
@@ -112,6 +130,59 @@
 #define EVENT_PAUSE 2
 #define EVENT_SKIP1 3
 
+/* the kinds of engine object, as the delete hook is told them (sounds are never deleted) */
+#define OBJ_FRAME 1
+#define OBJ_SPRITE 2
+#define OBJ_TILE 3
+#define OBJ_MAP 4
+#define OBJ_LIST 5
+#define OBJ_STRING 6
+#define OBJ_PACK 7
+#define OBJ_SOUND 8
+
+/* background-loading constants */
+#define LOAD_FRAME 1
+#define LOAD_SOUND 2
+#define LOAD_SONG 3
+#define LOAD_DROPPED 4
+
+#define LOAD_MASK 1
+
+/* decoded-asset cache flags */
+#define CACHE_MASK 1
+
+/* profiler phases, timed per frame */
+#define STATS_BG 0
+#define STATS_MAP 1
+#define STATS_SORT 2
+#define STATS_SPRITES 3
+#define STATS_STRINGS 4
+#define STATS_PRESENT 5
+#define STATS_MOTION 6
+#define STATS_COLLISION 7
+#define STATS_WAIT 8
+#define STATS_OTHER 9
+#define STATS_PHASES 10
+
+/* profiler counters, totalled per frame */
+#define STATS_TILES 0
+#define STATS_SPRITES_DRAWN 1
+#define STATS_SPRITES_CULLED 2
+#define STATS_PIXELS 3
+#define STATS_COLLISION_TESTS 4
+#define STATS_FRAMES_FUSED 5
+#define STATS_COUNTERS 6
+
+/* which figures to read back from the profiler */
+#define STATS_LAST 0
+#define STATS_MEAN 1
+#define STATS_PEAK 2
+
+/* asset decoding stages, applied in this order */
+#define DECODE_BASE64 1
+#define DECODE_LZ77 2
+#define DECODE_BXDIV 4
+
 /* graphics-related defines. */
 #define RGB_BITS 24
 #define RGB_BYTES 3
@@ -0,0 +1,247 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "SDL.h"
+#include "common.h"
+#include "displace.h"
+
+
+
+/*
+ * displacement doesn't care about the pixel order either, so both
+ * orders' displacement blitters clip the frame and hand it over to
+ * here.
+ *
+ * each pixel is fetched from its own spot plus its offset, or left as
+ * it is if that's outside the target.  since the pixels are read from
+ * the same frame they're written to, the results normally go to the
+ * scratchpad, a band of rows per worker thread, and are copied back
+ * afterwards.  but a frame whose offsets all point ahead, in the order
+ * the pixels are visited, only ever reads pixels that are still
+ * untouched, and is drawn straight onto the target instead.
+ */
+static struct displ_column *displ_cols;
+static int displ_cols_size;
+
+
+
+
+/*
+ * find the range of a displacement frame's offsets, which the frame
+ * keeps so the blitters needn't look at every offset to pick a method
+ */
+box *displ_range(short *dis, int w, int h)
+{
+	box *range;
+	int i;
+
+	range = ck_malloc(sizeof(box));
+	range->x1 = range->x2 = dis[0];
+	range->y1 = range->y2 = dis[1];
+
+	for( i=0; i < w * h; i++, dis += DISPL_SPAN )
+		{
+			range->x1 = min(range->x1, dis[0]);
+			range->x2 = max(range->x2, dis[0]);
+			range->y1 = min(range->y1, dis[1]);
+			range->y2 = max(range->y2, dis[1]);
+		}
+
+	return range;
+}
+
+
+
+
+/*
+ * displace the clipped area of the target by an unscaled frame
+ */
+void displace(frame *dest, frame *f, struct clip *cres)
+{
+	struct displ_job job;
+
+	job.cres = *cres;
+	job.dis = (short *)f->data + (cres->sx + f->stride * cres->sy) * DISPL_SPAN;
+	job.dis_pitch = f->stride * DISPL_SPAN;
+
+	run_displace(dest, f, &job, displ_rows);
+}
+
+
+
+
+/*
+ * displace the clipped area of the target by a frame stretched over
+ * the given span.  the offsets in between the frame's own are blended
+ * from the nearest four, so a small frame can cover a large area.
+ */
+void displace_scaled(frame *dest, frame *f, struct clip *cres, dimensions *span)
+{
+	struct displ_job job;
+	long long u;
+	int j, incx;
+
+	/* one column of blending for every column drawn */
+	if( cres->dw > displ_cols_size )
+		{
+			displ_cols_size = cres->dw;
+			displ_cols = ck_realloc(displ_cols, displ_cols_size * sizeof(struct displ_column));
+		}
+
+	/* the frame's pixel centres line up with those of the span */
+	incx = fp_set(f->w) / span->w;
+	for( j=0; j < cres->dw; j++ )
+		{
+			u = (long long)(cres->sx + j) * incx + incx / 2 - fp_set(1) / 2;
+			u = max(u, 0);
+
+			displ_cols[j].x0 = min((int)fp_int(u), f->w - 1);
+			displ_cols[j].x1 = min(displ_cols[j].x0 + 1, f->w - 1);
+			displ_cols[j].wx = (int)fp_frac(u) >> 8;
+
+			displ_cols[j].x0 *= DISPL_SPAN;
+			displ_cols[j].x1 *= DISPL_SPAN;
+		}
+
+	/* and the same for the rows, one at a time */
+	job.incy = fp_set(f->h) / span->h;
+	job.fy = cres->sy * job.incy + job.incy / 2 - fp_set(1) / 2;
+	job.fh = f->h;
+
+	job.cres = *cres;
+	job.cols = displ_cols;
+	job.dis = f->data;
+	job.dis_pitch = f->stride * DISPL_SPAN;
+
+	run_displace(dest, f, &job, displ_rows_scaled);
+}
+
+
+
+
+/*
+ * draw the rows straight onto the target if the frame's offsets allow,
+ * or else share them among the workers and copy the results back
+ */
+static void run_displace(frame *dest, frame *f, struct displ_job *job, void (*fn)(void *, int, int))
+{
+	box *range;
+	unsigned char *src, *tgt;
+	int i;
+
+	job->canvas = dest->data;
+	job->cw = dest->w;
+	job->ch = dest->h;
+
+	/* every offset points further down, or along the same row to the right? */
+	range = f->aux;
+	if( range && (range->y1 > 0 || (range->y1 == 0 && range->x1 >= 0)) )
+		{
+			job->out = job->canvas + job->cres.dx + job->cw * job->cres.dy;
+			job->out_pitch = job->cw;
+			fn(job, 0, job->cres.dh);
+			return;
+		}
+
+	adjust_scratchpad(job->cres.dw, job->cres.dh);
+	job->out = (uint32_t *)scratchpad;
+	job->out_pitch = job->cres.dw;
+
+	workers_run(job->cres.dh, job->cres.dw, fn, job);
+
+	/* copy the scratchpad back onto the canvas */
+	src = scratchpad;
+	tgt = dest->data + (job->cres.dx + dest->w * job->cres.dy) * RGBA_BYTES;
+
+	for( i=0; i < job->cres.dh; i++ )
+		{
+			memcpy( tgt, src, job->cres.dw * RGBA_BYTES );
+			src += job->cres.dw * RGBA_BYTES;
+			tgt += dest->w * RGBA_BYTES;
+		}
+
+}
+
+
+
+
+/*
+ * displace rows y1 to y2 of the clipped area
+ */
+static void displ_rows(void *data, int y1, int y2)
+{
+	struct displ_job *job = data;
+	uint32_t *out;
+	short *dis;
+	int i, j, x, y, here;
+
+	for( i=y1; i < y2; i++ )
+		{
+			y = job->cres.dy + i;
+			x = job->cres.dx;
+			here = x + job->cw * y;
+			dis = job->dis + i * job->dis_pitch;
+			out = job->out + i * job->out_pitch;
+
+			for( j=0; j < job->cres.dw; j++, x++, here++, dis += DISPL_SPAN )
+				{
+					/* a pixel displaced from outside the target stays as it is */
+					if( (unsigned)(x + dis[0]) < (unsigned)job->cw && (unsigned)(y + dis[1]) < (unsigned)job->ch )
+						out[j] = job->canvas[here + dis[0] + job->cw * dis[1]];
+					else
+						out[j] = job->canvas[here];
+				}
+		}
+
+}
+
+
+
+
+/*
+ * displace rows y1 to y2 of the clipped area, blending each pixel's
+ * offset from those of the four nearest in the frame.  the blend
+ * weights are out of 256 on each axis, so the sums keep 16 bits of
+ * fraction.
+ */
+static void displ_rows_scaled(void *data, int y1, int y2)
+{
+	struct displ_job *job = data;
+	struct displ_column *col;
+	uint32_t *out;
+	short *r0, *r1;
+	int i, j, x, y, here, v, wy;
+	int top, bot, ox, oy;
+
+	for( i=y1; i < y2; i++ )
+		{
+			/* the two frame rows this one falls between */
+			v = max(job->fy + i * job->incy, 0);
+			r0 = job->dis + min(fp_int(v), job->fh - 1) * job->dis_pitch;
+			r1 = job->dis + min(fp_int(v) + 1, job->fh - 1) * job->dis_pitch;
+			wy = fp_frac(v) >> 8;
+
+			y = job->cres.dy + i;
+			x = job->cres.dx;
+			here = x + job->cw * y;
+			out = job->out + i * job->out_pitch;
+
+			for( j=0, col = job->cols; j < job->cres.dw; j++, x++, here++, col++ )
+				{
+					top = r0[col->x0] * (256 - col->wx) + r0[col->x1] * col->wx;
+					bot = r1[col->x0] * (256 - col->wx) + r1[col->x1] * col->wx;
+					ox = (top * (256 - wy) + bot * wy + 0x7fff) >> 16;
+
+					top = r0[col->x0 + 1] * (256 - col->wx) + r0[col->x1 + 1] * col->wx;
+					bot = r1[col->x0 + 1] * (256 - col->wx) + r1[col->x1 + 1] * col->wx;
+					oy = (top * (256 - wy) + bot * wy + 0x7fff) >> 16;
+
+					/* a pixel displaced from outside the target stays as it is */
+					if( (unsigned)(x + ox) < (unsigned)job->cw && (unsigned)(y + oy) < (unsigned)job->ch )
+						out[j] = job->canvas[here + ox + job->cw * oy];
+					else
+						out[j] = job->canvas[here];
+				}
+		}
+
+}
@@ -0,0 +1,49 @@
+/*
+ * pixel displacement, for both pixel orders
+ */
+
+struct displ_job
+{
+	uint32_t *canvas;        /* the target frame's pixels, read from */
+	int cw, ch;              /* and its size, which is also its row pitch */
+	struct clip cres;
+	uint32_t *out;           /* where each row's results go */
+	int out_pitch;
+
+	/* the displacement data, at the top left of the clipped area */
+	short *dis;
+	int dis_pitch;
+
+	/* when scaled, the map rows' fixed-point positions, and the columns' interpolation */
+	int fy, incy, fh;
+	struct displ_column *cols;
+};
+
+/* an output column's place between two columns of a scaled displacement map */
+struct displ_column
+{
+	int x0, x1;    /* the two columns' offsets into a map row, in shorts */
+	int wx;        /* the weight of the second, out of 256 */
+};
+
+
+
+void displace(frame *, frame *, struct clip *);
+void displace_scaled(frame *, frame *, struct clip *, dimensions *);
+box *displ_range(short *, int, int);
+
+static void run_displace(frame *, frame *, struct displ_job *, void (*)(void *, int, int));
+static void displ_rows(void *, int, int);
+static void displ_rows_scaled(void *, int, int);
+
+
+/* from pixel.c */
+extern unsigned char *scratchpad;
+extern void adjust_scratchpad(int, int);
+
+/* from worker.c */
+extern void workers_run(int, int, void (*)(void *, int, int), void *);
+
+/* from misc.c */
+extern void *ck_malloc(size_t);
+extern void *ck_realloc(void *, size_t);
@@ -7,21 +7,52 @@
 
 
 
-/* a list of messages to pass to events */
-static list *event_msgs;
-static SDL_mutex *event_msgs_lock;
+/*
+ * every event lives in a fixed table of slots, found by its id, and
+ * the slots waiting to run sit in a min-heap ordered by their next
+ * deadline.  a single scheduler thread sleeps until the earliest one
+ * is due.  the lock guards the heap and the free slots; messages
+ * bypass it entirely, through each slot's mailbox.
+ */
+static struct event_schedule sched_table[EVENT_SLOTS];
+static int sched_free[EVENT_SLOTS], sched_free_ct;
+
+static struct event_schedule **sched_heap;
+static int sched_len, sched_size;
+static int sched_quit;
+
+static SDL_mutex *sched_lock;
+static SDL_cond *sched_wake;
+static SDL_Thread *sched_thread;
 
 
 
 
 /*
- * prepare the container and mutex for event signals
+ * prepare the event heap and start the scheduler thread
  */
 void init_events()
 {
+	int i;
+
 	DEBUG( "Initializing event manager...");
-	event_msgs = list_create();
-	event_msgs_lock = SDL_CreateMutex();
+
+	/* every slot starts out free, and unused */
+	for( i=0; i < EVENT_SLOTS; i++ )
+		{
+			sched_table[i].id = 0;
+			sched_table[i].gen = 0;
+			sched_free[i] = EVENT_SLOTS - 1 - i;
+		}
+	sched_free_ct = EVENT_SLOTS;
+
+	sched_heap = NULL;
+	sched_len = sched_size = 0;
+	sched_quit = 0;
+
+	sched_lock = SDL_CreateMutex();
+	sched_wake = SDL_CreateCond();
+	sched_thread = SDL_CreateThread(event_loop, NULL);
 	DEBUGF;
 }
 
@@ -30,10 +61,26 @@ void init_events()
 
 void quit_events()
 {
+	int i;
+
 	DEBUG( "Quitting event manager...");
-	SDL_DestroyMutex(event_msgs_lock);
-	list_delete(event_msgs);
-	event_msgs = NULL;
+
+	/* tell the scheduler to stop, and wait for it to finish any running event */
+	SDL_mutexP(sched_lock);
+	sched_quit = 1;
+	SDL_CondSignal(sched_wake);
+	SDL_mutexV(sched_lock);
+	SDL_WaitThread(sched_thread, NULL);
+
+	/* anything still scheduled is simply dropped */
+	for( i=0; i < sched_len; i++ )
+		retire(sched_heap[i]);
+	free(sched_heap);
+	sched_heap = NULL;
+	sched_len = sched_size = 0;
+
+	SDL_DestroyCond(sched_wake);
+	SDL_DestroyMutex(sched_lock);
 	DEBUGF;
 }
 
@@ -53,22 +100,54 @@ void quit_events()
  * - the void ptr (can be null) is passed into the event each
  *   time it's called
  *
- * each scheduled event runs in its own thread.
+ * every event is run from the one scheduler thread, so a slow
+ * event will hold up the others.  the id returned is what
+ * event_message() takes.
  */
 int event_add(int delay, int ct, event ev, void *evdata)
 {
 	/* the event scheduling data */
 	struct event_schedule *my_ev;
+	int slot, id;
+
+	SDL_mutexP(sched_lock);
+
+	/* failsafe - are all the slots in use? */
+	if( !sched_free_ct )
+		{
+			SDL_mutexV(sched_lock);
+			return ERR;
+		}
+
+	/*
+	 * take a free slot.  the id carries the slot's generation in its high bits,
+	 * so a message sent to a finished event can't reach the slot's next event.
+	 */
+	slot = sched_free[--sched_free_ct];
+	my_ev = &sched_table[slot];
+	my_ev->gen = (my_ev->gen + 1) & EVENT_GEN_MASK;
+	if( !my_ev->gen )
+		my_ev->gen = 1;
+	id = (my_ev->gen << EVENT_SLOT_BITS) | slot;
 
 	/* load up the struct */
-	my_ev = ck_malloc(sizeof(struct event_schedule));
-	my_ev->delay = delay;
+	my_ev->delay = delay < 0 ? 0 : delay;
 	my_ev->ct = ct;
 	my_ev->ev = ev;
 	my_ev->data = evdata;
+	my_ev->status = EVENT_GO;
+	my_ev->mail = 0;
+	my_ev->id = id;
+
+	/* the first run is one delay from now */
+	my_ev->deadline = clock_ns() + (long long)my_ev->delay * NS_PER_MS;
 
-	/* and spin the event off into a new thread! */
-	return SDL_GetThreadID(SDL_CreateThread(event_loop, my_ev));
+	/* schedule it, and wake the scheduler in case this is now the earliest event */
+	heap_push(my_ev);
+	SDL_CondSignal(sched_wake);
+	SDL_mutexV(sched_lock);
+
+	return id;
 
 }
 
@@ -78,23 +157,28 @@ int event_add(int delay, int ct, event ev, void *evdata)
 
 
 /*
- * send a message (e.g. halt, continue ..) to an event
+ * send a message (e.g. halt, continue ..) to an event.  it takes
+ * effect the next time the event comes due; if several messages
+ * arrive in between, the last one wins.
+ *
+ * this takes no lock:  the id leads straight to the event's slot,
+ * and the message is swapped into the slot's mailbox.
  */
 void event_message(int id, int msg)
 {
-	struct event_msg *e;
+	struct event_schedule *e;
 
-	/* prepare the message struct */
-	e = ck_malloc(sizeof(struct event_msg));
-	e->id = id;
-	e->msg = msg;
+	/* failsafe */
+	if( id <= 0 )
+		return;
 
-	/* lock the message queue for writing */
-	SDL_mutexP(event_msgs_lock);
-	list_add(event_msgs, e);
+	/* a quick check that the event is still around .. */
+	e = &sched_table[id & (EVENT_SLOTS - 1)];
+	if( e->id != id )
+		return;
 
-	/* and done! */
-	SDL_mutexV(event_msgs_lock);
+	/* .. and the scheduler double-checks the id when it opens the mailbox */
+	__sync_lock_test_and_set(&e->mail, ((long long)id << 32) | (unsigned int)msg);
 
 }
 
@@ -107,98 +191,67 @@ void event_message(int id, int msg)
 
 
 /*
- * a container/scheduler for the specific event .. this is what
- * is spawned into separate threads.
+ * the scheduler thread:  sleep until the earliest event is due, run
+ * it, and put it back in the heap with its next deadline.
  */
 static int event_loop(void *data)
 {
 	/* to the event scheduler information */
 	struct event_schedule *my_ev;
+	long long now, remain, mail;
+	int status;
 
-	/* current event thread id and event scheduling status */
-	int my_id, status;
-	int len;
 
-	/* list-walking within the event schedule loop */
-	iterator iter;
-	struct event_msg *my_msg;
+	SDL_mutexP(sched_lock);
 
+	while( !sched_quit )
+		{
+			/* nothing scheduled?  sleep until something is */
+			if( !sched_len )
+				{
+					SDL_CondWait(sched_wake, sched_lock);
+					continue;
+				}
 
-	/* grab the event schedule and set an initial status .. */
-	my_ev = data;
-	status = EVENT_GO;
+			/* not due yet?  sleep until it is, or until a new event is added */
+			now = clock_ns();
+			remain = sched_heap[0]->deadline - now;
+			if( remain > 0 )
+				{
+					SDL_CondWaitTimeout(sched_wake, sched_lock, (Uint32)((remain + NS_PER_MS - 1) / NS_PER_MS));
+					continue;
+				}
 
-	/* and save the thread ID, so we don't need to look it up later. */
-	my_id = SDL_ThreadID();
+			my_ev = heap_pop();
 
+			/* empty the mailbox:  the latest message addressed to this event sets its status */
+			mail = __sync_lock_test_and_set(&my_ev->mail, 0);
+			if( mail && (int)(mail >> 32) == my_ev->id )
+				my_ev->status = (int)(mail & 0xffffffff);
 
-	while( 1 )
-		{
 			/*
 			 * the order of operations is:
-			 * - sleep until the event is ready to fire
-			 * - check for messages specific to this event
-			 * - if there is a message, act on it.
+			 * - check the status messages have left for this event, and act on it.
 			 * - run the event.
-			 * - if it's an infinitely-recurring event, sleep.
-			 * - if it has a finite lifetime, decrement its counter and exit if it's finished running.
+			 * - if it has a finite lifetime, decrement its counter and drop it if it's finished running.
+			 * - otherwise, put it back on the heap for its next run.
 			 */
-			SDL_Delay(my_ev->delay);
-
-
-			/* lock access to the list */
-			SDL_mutexP(event_msgs_lock);
-
-			/* any messages waiting? */
-			len = list_length(event_msgs);
-			if( len == ERR )
-				/*
-				 * if the list itself no longer exists, then the event manager has shut down
-				 * and we ought to exit immediately.
-				 */
-				status = EVENT_STOP;
-			else if( len > 0 )
-				{
-
-					/* there is possibly an event waiting for us */
-					iterator_start(iter, event_msgs);
-					while( (my_msg = iterator_data(iter)) )
-						{
-							/* is this message to this thread? */
-							if( my_id == my_msg->id )
-								{
-									/* yes, save the status .. */
-									status = my_msg->msg;
-
-									/* .. and remove the message */
-									list_remove(event_msgs, my_msg, LIST_HEAD);
-									free(my_msg);
-
-								}
-
-							/* next message .. */
-							iterator_next(iter);
-
-						}
-
-				}
-
-			/* remove the list lock */
-			SDL_mutexV(event_msgs_lock);
-
-
-			/* is there an event message that changes execution? */
+			status = my_ev->status;
 			switch(status)
 				{
 					case EVENT_GO:
-						my_ev->ev(my_ev->data);    /* fire the event! */
+						/* fire the event!  the lock is dropped so it can add events of its own */
+						SDL_mutexV(sched_lock);
+						my_ev->ev(my_ev->data);
+						SDL_mutexP(sched_lock);
 						break;
 
 					case EVENT_PAUSE:            /* don't run the event, and don't count down its lifetime */
+						reschedule(my_ev, now);
 						continue;
 
 					case EVENT_SKIP1:
-						status = EVENT_GO;         /* consume one event cycle without doing anything */
+						my_ev->status = EVENT_GO;  /* consume one event cycle without doing anything */
 						break;
 
 					case EVENT_STOP:
@@ -210,20 +263,111 @@ static int event_loop(void *data)
 
 
 			/*
-			 * if the event lifetime is zero, quit the event loop now.  if it's
+			 * if the event lifetime is zero, drop it now.  if it's
 			 * greater than zero, decrement it and continue.  if it's less than
 			 * zero, do nothing to the lifetime because it's an indefinite event.
 			 */
 			if( !my_ev->ct )
-				break;
+				{
+					retire(my_ev);
+					continue;
+				}
 			else if( my_ev->ct > 0 )
 				my_ev->ct--;
 
+			reschedule(my_ev, now);
 
 		}
 
-	/* and, done */
-	free(my_ev);
+	SDL_mutexV(sched_lock);
 	return 0;
 
 }
+
+
+
+
+/*
+ * give a finished event's slot back
+ */
+static void retire(struct event_schedule *e)
+{
+	sched_free[sched_free_ct++] = e - sched_table;
+	e->id = 0;
+}
+
+
+
+
+/*
+ * put an event back on the heap, one delay after its last deadline.
+ * deadlines advance on a fixed grid so a recurring event doesn't
+ * drift, but an event that has fallen behind isn't run back-to-back
+ * to catch up.
+ */
+static void reschedule(struct event_schedule *e, long long now)
+{
+	e->deadline += (long long)e->delay * NS_PER_MS;
+	if( e->deadline < now )
+		e->deadline = now;
+
+	heap_push(e);
+}
+
+
+
+
+/*
+ * add an event to the heap, keeping the earliest deadline at the top
+ */
+static void heap_push(struct event_schedule *e)
+{
+	int i, parent;
+
+	if( sched_len == sched_size )
+		{
+			sched_size = sched_size ? sched_size * 2 : 16;
+			sched_heap = ck_realloc(sched_heap, sched_size * sizeof(struct event_schedule *));
+		}
+
+	/* sift the new entry up from the bottom */
+	for( i = sched_len++; i > 0; i = parent )
+		{
+			parent = (i - 1) / 2;
+			if( sched_heap[parent]->deadline <= e->deadline )
+				break;
+			sched_heap[i] = sched_heap[parent];
+		}
+
+	sched_heap[i] = e;
+}
+
+
+
+
+/*
+ * remove and return the event with the earliest deadline
+ */
+static struct event_schedule *heap_pop()
+{
+	struct event_schedule *top, *last;
+	int i, child;
+
+	top = sched_heap[0];
+	last = sched_heap[--sched_len];
+
+	/* sift the last entry down from the top */
+	for( i=0; (child = 2 * i + 1) < sched_len; i = child )
+		{
+			if( child + 1 < sched_len && sched_heap[child + 1]->deadline < sched_heap[child]->deadline )
+				child++;
+			if( last->deadline <= sched_heap[child]->deadline )
+				break;
+			sched_heap[i] = sched_heap[child];
+		}
+
+	if( sched_len )
+		sched_heap[i] = last;
+
+	return top;
+}
@@ -2,20 +2,30 @@
  * a timed-events scheduler
  */
 
+/* nanoseconds per millisecond, for converting event delays */
+#define NS_PER_MS 1000000LL
+
+/*
+ * how many events can be scheduled at once.  an event id is the slot
+ * number in the low bits and the slot's generation above them.
+ */
+#define EVENT_SLOT_BITS 10
+#define EVENT_SLOTS (1 << EVENT_SLOT_BITS)
+#define EVENT_GEN_MASK ((1 << (31 - EVENT_SLOT_BITS)) - 1)
+
 struct event_schedule
 {
+	volatile int id;         /* zero while the slot is free */
+	int gen;                 /* bumped every time the slot is reused */
 	int delay;
 	int ct;
+	int status;              /* the last message acted on */
+	volatile long long mail; /* the latest message:  id in the high word, message in the low */
+	long long deadline;      /* when it next runs, from clock_ns() */
 	event ev;
 	void *data;
 };
 
-struct event_msg
-{
-	int id;
-	int msg;
-};
-
 
 
 void init_events();
@@ -25,14 +35,15 @@ int event_add(int, int, event, void *);
 void event_message(int, int);
 
 static int event_loop(void *);
+static void retire(struct event_schedule *);
+static void reschedule(struct event_schedule *, long long);
+static void heap_push(struct event_schedule *);
+static struct event_schedule *heap_pop();
 
 
-/* from list.c */
-extern list *list_create();
-extern void list_add(list *, void *);
-extern int list_length(list *);
-extern void list_remove(list *, void *, int);
+/* from clock.c */
+extern long long clock_ns();
 
 
 /* from misc.h */
-extern void *ck_malloc(size_t);
+extern void *ck_realloc(void *, size_t);
@@ -7,15 +7,21 @@
 
 
 
-/* all fonts loaded into the system */
-static list *fonts;
+/*
+ * all fonts known to the system, in an open-addressed table keyed by
+ * name.  a font is interned the first time its name is seen, whether
+ * it's being loaded or a string is asking for it, and its entry stays
+ * put from then on, so strings can hold on to it.
+ */
+static font **fonts;
+static int font_slots, font_ct;
 
 
 
 
 
 /*
- * let's start our font list with our "default" font
+ * let's start our font table with our "default" font
  */
 void init_fonts()
 {
@@ -368,9 +374,13 @@ void init_fonts()
 			1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
 			1, 1, 1, 1, 1, 1, 1, 1 };
 
-	/* initialize font list */
-	DEBUG("Initializing font list...");
-	fonts = list_create();
+	/* initialize font table */
+	DEBUG("Initializing font table...");
+	if( !fonts )
+		{
+			font_slots = FONT_SLOTS;
+			fonts = ck_calloc(font_slots, sizeof(*fonts));
+		}
 	DEBUGF;
 
 
@@ -381,7 +391,7 @@ void init_fonts()
 		*(int32_t *)(buf + i * RGBA_BYTES) = font[i] ? 0xffffffff : 0xff000000;
 
 
-	/* add the default 8x8 font to the fontlist */
+	/* add the default 8x8 font to the font table */
 	DEBUG("Adding default font...");
 	font_add("default", 8, 8, buf, NULL);
 	DEBUGF;
@@ -395,34 +405,34 @@ void init_fonts()
 
 
 /*
- * delete the fonts in the font list and free the list itself
+ * delete the fonts in the font table and free the table itself
  */
 void quit_fonts()
 {
-	iterator iter;
 	font *f;
-	int i;
+	int i, j;
 
 
-	DEBUG("Freeing font list...");
+	DEBUG("Freeing font table...");
 
-	/* start off with the font list .. */
-	iterator_start(iter, fonts);
-	while( (f = iterator_data(iter)) )
+	for( i=0; i < font_slots; i++ )
 		{
+			f = fonts[i];
+			if( !f )
+				continue;
+
 			/* free the font characters */
-			for( i=0; i < FONT_CT; i++ )
-				frame_delete(f->chars[i]);
+			for( j=0; j < FONT_CT; j++ )
+				frame_delete(f->chars[j]);
 
 			/* and the font itself */
 			free(f);
-
-			iterator_next(iter);
 		}
 
-	/* and now, free the list itself */
-	list_delete(fonts);
+	/* and now, free the table itself */
+	free(fonts);
 	fonts = NULL;
+	font_slots = font_ct = 0;
 
 	DEBUGF;
 
@@ -439,27 +449,24 @@ void quit_fonts()
 
 
 /*
- * add a font to the master list
+ * add a font to the font table
  */
 void font_add(const char *name, int w, int h, const unsigned char *data, int *widths)
 {
-	/* the font data, the new font .. */
+	/* the font data, the new font's characters .. */
 	frame *fr;
-	font *f;
+	frame *chars[FONT_CT];
 
 	/* failsafe */
 	if( !name || !data )
 		return;
 
-	/* copy the characters into the font definition */
+	/* slice out the characters, and add the font */
 	fr = frame_create(FRAME_RGBA, w * FONT_CT, h, data, NULL);
-	f = prepare_font(fr, widths);
-
-	/* now add this new font to the font list */
-	strncpy(f->name, name, 49);
-	list_add(fonts, f);
+	prepare_font(fr, widths, chars);
+	font_add_slices(name, chars);
 
-	/* and free the scratchpad frame */
+	/* and let go of the scratchpad frame, which lives on in the characters */
 	frame_delete(fr);
 
 }
@@ -476,26 +483,23 @@ void font_add(const char *name, int w, int h, const unsigned char *data, int *wi
  */
 void font_from_disk(const char *name, const char *file, int *widths)
 {
-	/* the new font */
-	font *f;
+	/* the new font's characters */
+	frame *chars[FONT_CT];
 	frame *fr;
 
 	/* failsafe */
 	if( !name || !file )
 		return;
 
-	/* copy the characters into the font definition */
+	/* slice out the characters, and add the font */
 	fr = frame_from_disk(file);
 	if( !fr )
 		return;
 
-	f = prepare_font(fr, widths);
-
-	/* now add this new font to the font list */
-	strncpy(f->name, name, 49);
-	list_add(fonts, f);
+	prepare_font(fr, widths, chars);
+	font_add_slices(name, chars);
 
-	/* and free the scratchpad frame */
+	/* and let go of the scratchpad frame, which lives on in the characters */
 	frame_delete(fr);
 
 }
@@ -513,26 +517,23 @@ void font_from_disk(const char *name, const char *file, int *widths)
  */
 void font_from_buffer(const char *name, int len, const unsigned char *data, int *widths)
 {
-	/* the new font */
-	font *f;
+	/* the new font's characters */
+	frame *chars[FONT_CT];
 	frame *fr;
 
 	/* failsafe */
 	if( !name )
 		return;
 
-	/* copy the characters into the font definition */
+	/* slice out the characters, and add the font */
 	fr = frame_from_buffer(len, data);
 	if( !fr )
 		return;
 
-	f = prepare_font(fr, widths);
+	prepare_font(fr, widths, chars);
+	font_add_slices(name, chars);
 
-	/* now add this new font to the font list */
-	strncpy(f->name, name, 49);
-	list_add(fonts, f);
-
-	/* and free the scratchpad frame */
+	/* and let go of the scratchpad frame, which lives on in the characters */
 	frame_delete(fr);
 
 }
@@ -546,31 +547,126 @@ void font_from_buffer(const char *name, int len, const unsigned char *data, int
 
 
 /*
- * retrieve a font by its name
+ * add a font whose characters have already been sliced out.  a font
+ * added under a name already in use replaces the old font's
+ * characters, and strings using that name pick up the new ones.
+ */
+void font_add_slices(const char *name, frame **chars)
+{
+	font *f;
+	int i;
+
+	/* failsafe */
+	if( !name || !chars )
+		return;
+
+	f = font_intern(name);
+	for( i=0; i < FONT_CT; i++ )
+		{
+			frame_delete(f->chars[i]);
+			f->chars[i] = chars[i];
+		}
+
+	/* let strings drawn with the old characters know they've changed */
+	f->gen++;
+
+}
+
+
+
+
+
+
+
+
+
+/*
+ * retrieve a font by its name, if it's been loaded
  */
 font *get_font_by_name(const char *name)
 {
-	/* to scan the fonts */
-	iterator iter;
 	font *f;
 
 	/* failsafe */
-	if( !name )
+	if( !name || !fonts )
 		return NULL;
 
+	f = *find_slot(name);
+	return f && f->gen ? f : NULL;
+
+}
+
+
+
 
-	/* first, retrieve the font list .. */
-	iterator_start(iter, fonts);
-	while( (f = iterator_data(iter)) )
+
+
+
+
+
+/*
+ * get the font entry for a name, adding an empty one if the name's
+ * new.  an empty font has no characters until one is loaded under its
+ * name.
+ */
+font *font_intern(const char *name)
+{
+	font **slot;
+
+	/* the table is made on first use, in case strings are set up before the fonts are */
+	if( !fonts )
 		{
-			if( !strcmp(f->name, name) )
-				return f;
+			font_slots = FONT_SLOTS;
+			fonts = ck_calloc(font_slots, sizeof(*fonts));
+		}
+
+	slot = find_slot(name);
+	if( *slot )
+		return *slot;
 
-			iterator_next(iter);
+	/* keep the table at most half full, so probes stay short */
+	if( (font_ct + 1) * 2 > font_slots )
+		{
+			grow_fonts();
+			slot = find_slot(name);
 		}
 
-	/* nothing found? */
-	return NULL;
+	*slot = ck_calloc(1, sizeof(font));
+	strncpy((*slot)->name, name, 49);
+	font_ct++;
+
+	return *slot;
+
+}
+
+
+
+
+
+
+
+
+
+/*
+ * find the table slot holding a font name, or the empty slot where it
+ * would go
+ */
+static font **find_slot(const char *name)
+{
+	unsigned int h;
+	const char *c;
+
+	/* an fnv-1a hash of the name, as far as names are kept */
+	h = 2166136261u;
+	for( c = name; *c && c - name < 49; c++ )
+		h = (h ^ (unsigned char)*c) * 16777619u;
+
+	/* and probe linearly from there */
+	for( h &= font_slots - 1; fonts[h]; h = (h + 1) & (font_slots - 1) )
+		if( !strncmp(fonts[h]->name, name, 49) )
+			break;
+
+	return &fonts[h];
 
 }
 
@@ -580,25 +676,52 @@ font *get_font_by_name(const char *name)
 
 
 
+
+
+/*
+ * double the size of the font table
+ */
+static void grow_fonts()
+{
+	font **old;
+	int i, old_slots;
+
+	old = fonts;
+	old_slots = font_slots;
+
+	font_slots *= 2;
+	fonts = ck_calloc(font_slots, sizeof(*fonts));
+
+	for( i=0; i < old_slots; i++ )
+		if( old[i] )
+			*find_slot(old[i]->name) = old[i];
+
+	free(old);
+
+}
+
+
+
+
+
+
+
+
+
 /*
  * the internal processing of a font
  */
-static font *prepare_font(frame *fr, int *widths)
+static void prepare_font(frame *fr, int *widths, frame **chars)
 {
-	/* the new font */
 	int i, w, xofs;
-	font *f;
 
-	/* allocate the new font definition */
-	f = ck_malloc(sizeof(font));
-
-	/* copy the characters into the font definition */
+	/* slice out the characters, as views of the font's sheet */
 	if( widths )
 		{
 			/* if we've got a set of widths, use those to slice out chars of the desired widths */
 			for( i=0, xofs = 0; i < FONT_CT; i++ )
 				{
-					f->chars[i] = frame_slice(fr, xofs, 0, *(widths+i), fr->h);
+					chars[i] = frame_slice(fr, xofs, 0, *(widths+i), fr->h);
 					xofs += *(widths+i);
 				}
 
@@ -609,11 +732,8 @@ static font *prepare_font(frame *fr, int *widths)
 			w = fr->w / FONT_CT;
 
 			for( i=0; i < FONT_CT; i++ )
-				f->chars[i] = frame_slice(fr, w*i, 0, w, fr->h);
+				chars[i] = frame_slice(fr, w*i, 0, w, fr->h);
 
 		}
 
-	/* and done */
-	return f;
-
 }
@@ -1,26 +1,30 @@
 
 /*
- * string.h
+ * font.h
  */
 
+/* the starting size of the font table; always a power of two */
+#define FONT_SLOTS 16
+
 void init_fonts();
 void quit_fonts();
 
 void font_add(const char *, int, int, const unsigned char *, int *);
 void font_from_disk(const char *, const char *, int *);
 void font_from_buffer(const char *, int, const unsigned char *, int *);
+void font_add_slices(const char *, frame **);
 
 font *get_font_by_name(const char *);
-static font *prepare_font(frame *, int *);
+font *font_intern(const char *);
+
+static font **find_slot(const char *);
+static void grow_fonts();
+static void prepare_font(frame *, int *, frame **);
 
 /* from frame.c */
 frame *frame_from_disk(const char *);
 frame *frame_from_buffer(int, const unsigned char *);
 
-/* from list.c */
-extern list *list_create();
-extern void list_add(list *, void *);
-
 /* from frame.c */
 extern frame *frame_create(int, int, int, const void *, const void *);
 extern frame *frame_slice(frame *, int, int, int, int);
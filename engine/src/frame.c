@@ -67,7 +67,7 @@ frame *frame_create(int type, int w, int h, const void *data, const void *aux)
 				 * allocate the surface.  if some data has been
 				 * supplied, unpack and copy in the surface
 				 */
-				f->data = ck_malloc(w * h * RGBA_BYTES);
+				f->data = alloc_pixels(NULL, w * h * RGBA_BYTES);
 				if( data )
 					memcpy(f->data, data, w * h * RGBA_BYTES);
 				break;
@@ -78,7 +78,7 @@ frame *frame_create(int type, int w, int h, const void *data, const void *aux)
 				 * allocate the surface.  if some data has been
 				 * supplied, unpack and copy in the surface
 				 */
-				f->data = ck_malloc(w * h * RGBA_BYTES);
+				f->data = alloc_pixels(NULL, w * h * RGBA_BYTES);
 				if( data )
 					unpack_rgb(w * h, data, f->data);
 				break;
@@ -89,7 +89,7 @@ frame *frame_create(int type, int w, int h, const void *data, const void *aux)
 			case FRAME_BR:
 			case FRAME_XOR:
 				/* allocate the memory for the user data and copy */
-				f->data = ck_malloc(w * h * RGBA_BYTES);
+				f->data = alloc_pixels(NULL, w * h * RGBA_BYTES);
 				if( data )
 					unpack_rgb(w * h, data, f->data);
 				break;
@@ -98,7 +98,7 @@ frame *frame_create(int type, int w, int h, const void *data, const void *aux)
 			case FRAME_CT:
 			case FRAME_SAT:
 				/* allocate the memory for the user data and copy */
-				f->data = ck_malloc(w * h);
+				f->data = alloc_pixels(NULL, w * h);
 				if( data )
 					memcpy( f->data, data, w * h);
 				break;
@@ -106,15 +106,18 @@ frame *frame_create(int type, int w, int h, const void *data, const void *aux)
 
 			case FRAME_DISPL:
 				/* allocate and copy displacement data for this sprite frame */
-				f->data = ck_malloc(w * h * DISPL_SPAN * sizeof(short));
+				f->data = alloc_pixels(NULL, w * h * DISPL_SPAN * sizeof(short));
 				if( data )
-					memcpy(f->data, data, w * h * DISPL_SPAN * sizeof(short));
+					{
+						memcpy(f->data, data, w * h * DISPL_SPAN * sizeof(short));
+						f->aux = displ_range(f->data, w, h);
+					}
 				break;
 
 
 			case FRAME_CONVO:
 				/* allocate the memory for the user data and copy */
-				f->data = ck_malloc(w * h);
+				f->data = alloc_pixels(NULL, w * h);
 				f->aux = ck_malloc(sizeof(convolution));
 
 				if( data && aux )
@@ -127,7 +130,7 @@ frame *frame_create(int type, int w, int h, const void *data, const void *aux)
 
 			case FRAME_LUT:
 				/* allocate the memory for the bitmask and copy */
-				f->data = ck_malloc(w * h);
+				f->data = alloc_pixels(NULL, w * h);
 				f->aux = ck_malloc(sizeof(lut));
 
 				if( data && aux )
@@ -152,6 +155,7 @@ frame *frame_create(int type, int w, int h, const void *data, const void *aux)
 	f->tag = type;
 	f->w = w;
 	f->h = h;
+	f->stride = w;
 
 	f->pixel.rshift = 0;
 	f->pixel.gshift = 8;
@@ -177,6 +181,59 @@ frame *frame_create(int type, int w, int h, const void *data, const void *aux)
 
 
 
+/*
+ * make a frame around data that belongs to someone else, without
+ * copying it.  the frame may rewrite the data in place (e.g. to put
+ * the pixels in the display's order), but never frees or resizes it;
+ * once the frame is deleted, release (if given) is called with the
+ * owner.  only the types whose data is kept just as it's supplied can
+ * be adopted.
+ */
+frame *frame_adopt(int type, int w, int h, void *data, frame_release release, void *owner)
+{
+	frame *f;
+
+	/* failsafe */
+	if( !data || w <= 0 || h <= 0 )
+		return NULL;
+
+	switch(type)
+		{
+			case FRAME_RGBA:
+			case FRAME_CT:
+			case FRAME_SAT:
+			case FRAME_DISPL:
+				break;
+
+			default:
+				return NULL;
+		}
+
+	/* an empty frame, with the data slotted in */
+	f = frame_create(FRAME_NONE, w, h, NULL, NULL);
+	f->tag = type;
+	f->data = data;
+	f->shared = FRAME_SHARED_DATA;
+	f->release = release;
+	f->owner = owner;
+
+	if( type == FRAME_DISPL )
+		f->aux = displ_range(data, w, h);
+
+	return f;
+
+}
+
+
+
+
+
+
+
+
+
+
+
 /*
  * duplicate a frame
  */
@@ -195,6 +252,7 @@ frame *frame_copy(frame *fr)
 	new->tag = fr->tag;
 	new->w = fr->w;
 	new->h = fr->h;
+	new->stride = fr->w;
 	new->pixel = fr->pixel;
 
 	/* and copy it .. */
@@ -209,30 +267,37 @@ frame *frame_copy(frame *fr)
 			case FRAME_SL:
 			case FRAME_BR:
 			case FRAME_XOR:
-				/* allocate the rgb data area and copy it over */
-				new->data = ck_malloc(fr->w * fr->h * RGBA_BYTES);
-				memcpy(new->data, fr->data, fr->w * fr->h * RGBA_BYTES);
+				/* allocate the rgb data area and copy it over, packing a view's rows together */
+				new->data = alloc_pixels(NULL, fr->w * fr->h * RGBA_BYTES);
+				copy_rows(new->data, fr->data, fr->w * RGBA_BYTES, fr->h, fr->stride * RGBA_BYTES);
 				break;
 
 
 			case FRAME_CT:
 			case FRAME_SAT:
 				/* allocate the rgb data area and copy it over */
-				new->data = ck_malloc(fr->w * fr->h);
+				new->data = alloc_pixels(NULL, fr->w * fr->h);
 				memcpy(new->data, fr->data, fr->w * fr->h);
 				break;
 
 
 			case FRAME_DISPL:
 				/* allocate and copy the displacement data */
-				new->data = ck_malloc(fr->w * fr->h * DISPL_SPAN * sizeof(short));
+				new->data = alloc_pixels(NULL, fr->w * fr->h * DISPL_SPAN * sizeof(short));
 				memcpy(new->data, fr->data, fr->w * fr->h * DISPL_SPAN * sizeof(short) );
+
+				/* and the range of the offsets, if it's known */
+				if( fr->aux )
+					{
+						new->aux = ck_malloc(sizeof(box));
+						memcpy(new->aux, fr->aux, sizeof(box));
+					}
 				break;
 
 
 			case FRAME_CONVO:
 				/* allocate memory for pixel mask, kernel, and scratchpad surface */
-				new->data = ck_malloc(fr->w * fr->h);
+				new->data = alloc_pixels(NULL, fr->w * fr->h);
 				new->aux = ck_malloc(sizeof(convolution));
 
 				/* and copy */
@@ -243,7 +308,7 @@ frame *frame_copy(frame *fr)
 
 			case FRAME_LUT:
 				/* allocate the bit mask and table memory */
-				new->data = ck_malloc(fr->w * fr->h);
+				new->data = alloc_pixels(NULL, fr->w * fr->h);
 				new->aux = ck_malloc(sizeof(lut));
 
 				/* and copy */
@@ -258,7 +323,7 @@ frame *frame_copy(frame *fr)
 	if( fr->mask )
 		{
 			new->mask = ck_malloc(fr->w * fr->h);
-			memcpy(new->mask, fr->mask, fr->w * fr->h);
+			copy_rows(new->mask, fr->mask, fr->w, fr->h, fr->stride);
 		}
 	else
 		new->mask = NULL;
@@ -280,12 +345,27 @@ frame *frame_copy(frame *fr)
  */
 void frame_delete(frame *fr)
 {
+	frame *parent;
+
 	/* failsafe */
 	if( !fr )
 		return;
 
-	/* free the data structures used by this frame type */
-	switch(fr->tag)
+	object_deleted(OBJ_FRAME, fr);
+
+	/* views still point into this frame, so the last of them will finish the job */
+	if( fr->refs )
+		{
+			fr->shared |= FRAME_DELETED;
+			return;
+		}
+
+	/* a displacement frame's range is its own, even when its offsets are borrowed */
+	if( fr->tag == FRAME_DISPL )
+		free(fr->aux);
+
+	/* free the data structures used by this frame type, unless they're borrowed */
+	switch( (fr->shared & FRAME_SHARED_DATA) ? FRAME_NONE : fr->tag )
 		{
 			case FRAME_NONE:
 				break;
@@ -298,22 +378,43 @@ void frame_delete(frame *fr)
 			case FRAME_SAT:
 			case FRAME_DISPL:
 			case FRAME_XOR:
-				free(fr->data);
+				ck_free_aligned(fr->data);
 				break;
 			case FRAME_CONVO:
 			case FRAME_LUT:
-				free(fr->data);
+				ck_free_aligned(fr->data);
 				free(fr->aux);
 				break;
 		}
 
 	/* and any pixel mask that may be set */
-	if( fr->mask )
+	if( fr->mask && !(fr->shared & FRAME_SHARED_MASK) )
 		free(fr->mask);
+	free_old_masks(fr);
+
+	/* and the scaling tables, and any copies kept at the sizes it's drawn */
+	free_span_tables(fr);
+	drop_scaled_frames(fr);
+
+	/* hand adopted data back */
+	if( fr->release )
+		fr->release(fr->owner);
 
 	/* and last, delete the frame */
+	parent = fr->parent;
 	free(fr);
 
+	/* and let go of the parent, if this was the last view keeping it (or its old masks) around */
+	if( parent && !--parent->refs )
+		{
+			free_old_masks(parent);
+			if( parent->shared & FRAME_DELETED )
+				{
+					parent->shared &= ~FRAME_DELETED;
+					frame_delete(parent);
+				}
+		}
+
 }
 
 
@@ -351,8 +452,27 @@ int frame_set_mask(frame *fr, const unsigned char *data)
 	if( !fr || !data)
 		return ERR;
 
-	/* now, allocate the memory and copy the data .. note the use of realloc */
-	fr->mask = ck_realloc(fr->mask, fr->w * fr->h);
+	/* copies kept at the sizes it's drawn have the old mask */
+	drop_scaled_frames(fr);
+
+	/* a mask of a view's own is laid out at its own width, so the view's pixels are copied out too */
+	if( fr->stride != fr->w )
+		own_rows(fr);
+
+	/* a borrowed mask is left alone, and replaced with one of our own */
+	if( fr->shared & FRAME_SHARED_MASK )
+		{
+			fr->mask = NULL;
+			fr->shared &= ~FRAME_SHARED_MASK;
+		}
+
+	/* views keep the mask they were made with, as a copy would have */
+	if( fr->refs )
+		retire_mask(fr);
+
+	/* now, allocate the memory and copy the data */
+	if( !fr->mask )
+		fr->mask = ck_malloc(fr->w * fr->h);
 	memcpy(fr->mask, data, fr->w * fr->h);
 
 	/* all ok */
@@ -373,44 +493,51 @@ int frame_set_mask(frame *fr, const unsigned char *data)
  */
 int frame_set_mask_from(frame *fr, frame *src)
 {
-	/* .. variables for the desaturation and pixel determination */
-	int i;
-	unsigned char *rgb, *mask;
+	/* the row being masked */
+	int y;
+
+	/* a pack frame's box, if it's one */
+	box bound;
 
 	/* failsafe */
 	if( !fr || !src || (src->tag != FRAME_RGB && src->tag != FRAME_RGBA) )
 		return ERR;
 
-	/* now, allocate the memory and set the pixel mask */
-	fr->mask = ck_realloc(fr->mask, fr->w * fr->h);
+	/*
+	 * a pack's masks are made from its own frames' transparency, so there's nothing to do.
+	 * views share both too, but their parent's mask may have come from anywhere
+	 */
+	if( fr == src && fr->tag == FRAME_RGBA && fr->mask && \
+		 (fr->shared & (FRAME_SHARED_DATA | FRAME_SHARED_MASK)) == (FRAME_SHARED_DATA | FRAME_SHARED_MASK) && \
+		 pack_frame_bound(fr, &bound) == 0 )
+		return 0;
 
+	drop_scaled_frames(fr);
 
-	/* for alpha frames, use alpha >= 128 as a "hot" pixel */
-	if( src->tag == FRAME_RGBA )
-		{
-			/* check the transparency of each original pixel */
-			rgb = src->data;
-			mask = fr->mask;
-			for( i=0; i < fr->w * fr->h; i++ )
-				{
-					*mask = *(rgb + (fr->pixel.ashift>>3)) >= A_MID ? 1 : 0;
-					rgb += RGBA_BYTES;
-					mask++;
-				}
-		}
-	else
+	/* as in frame_set_mask(), a view gets its pixels copied out before it gets a mask of its own */
+	if( fr->stride != fr->w )
+		own_rows(fr);
+
+	/* a borrowed mask is left alone, and replaced with one of our own */
+	if( fr->shared & FRAME_SHARED_MASK )
 		{
-			/* check the desaturated value of each original pixel */
-			rgb = src->data;
-			mask = fr->mask;
-			for( i=0; i < fr->w * fr->h; i++ )
-				{
-					*mask = desaturate_pixel(rgb, fr->pixel) >= A_MID ? 1 : 0;
-					rgb += RGBA_BYTES;
-					mask++;
-				}
+			fr->mask = NULL;
+			fr->shared &= ~FRAME_SHARED_MASK;
 		}
 
+	/* as in frame_set_mask(), views keep the mask they were made with */
+	if( fr->refs )
+		retire_mask(fr);
+
+	/* now, allocate the memory and set the pixel mask */
+	if( !fr->mask )
+		fr->mask = ck_malloc(fr->w * fr->h);
+
+
+	/* for alpha frames, use alpha >= 128 as a "hot" pixel, and otherwise the desaturated value */
+	for( y=0; y < fr->h; y++ )
+		mask_from_pixels(fr->w, (unsigned char *)src->data + y * src->stride * RGBA_BYTES, fr->mask + y * fr->w, fr->pixel, src->tag == FRAME_RGBA);
+
 	/* all ok */
 	return 0;
 
@@ -425,18 +552,12 @@ int frame_set_mask_from(frame *fr, frame *src)
 
 /*
  * create a new frame from a selection of the given frame ..
- * note that frame slicing only works on RGB frames.
+ * note that frame slicing only works on RGB frames.  the slice
+ * is a view, which shares the frame's pixels and pixel mask
+ * rather than copying them.
  */
 frame *frame_slice(frame *fr, int x, int y, int w, int h)
 {
-	/* .. variables for the data copy */
-	int i;
-	unsigned char *src, *dest;
-
-	/* the necessary frame pointers */
-	frame *new;
-
-
 	/* failsafe */
 	if( !fr || (fr->tag != FRAME_RGB && fr->tag != FRAME_RGBA) )
 		return NULL;
@@ -462,45 +583,156 @@ frame *frame_slice(frame *fr, int x, int y, int w, int h)
 	if( y+h >= fr->h )
 		h = fr->h - y;
 
+	/* ok, done! */
+	return frame_view(fr, x, y, w, h);
 
-	/* allocate the new frame */
-	new = frame_create(fr->tag, w, h, NULL, NULL);
+}
 
-	/* copy the data */
-	src = fr->data + (x + fr->w * y) * RGBA_BYTES;
-	dest = new->data;
-	for( i=0; i < h; i++ )
-		{
-			memcpy(dest, src, w * RGBA_BYTES);
-			src += fr->w * RGBA_BYTES;
-			dest += w * RGBA_BYTES;
-		}
 
 
-	/* if there is a pixel mask, create a slice of it as well */
+
+
+/*
+ * make a frame of part of a frame, pointing into its data and mask
+ * with the frame's stride.  a view keeps its parent alive until the
+ * view is deleted.
+ */
+static frame *frame_view(frame *fr, int x, int y, int w, int h)
+{
+	frame *new, *parent;
+
+	/* views of views share the original parent's data, unless the mask is the view's own */
+	parent = (fr->parent && (fr->shared & FRAME_SHARED_DATA) && (!fr->mask || (fr->shared & FRAME_SHARED_MASK))) ? fr->parent : fr;
+
+	new = frame_create(FRAME_NONE, w, h, NULL, NULL);
+	new->tag = fr->tag;
+	new->pixel = fr->pixel;
+	new->stride = fr->stride;
+	new->data = (unsigned char *)fr->data + (x + fr->stride * y) * RGBA_BYTES;
+	new->shared = FRAME_SHARED_DATA;
+
 	if( fr->mask )
 		{
-			/* by allocating the mask buffer .. */
-			new->mask = ck_malloc(w * h);
+			new->mask = fr->mask + x + fr->stride * y;
+			new->shared |= FRAME_SHARED_MASK;
+		}
 
-			/* and copying out the slice */
-			src = fr->mask + x + fr->w * y;
-			dest = new->mask;
-			for( i=0; i < h; i++ )
-				{
-					memcpy(dest, src, w);
-					src += fr->w;
-					dest += w;
-				}
+	new->parent = parent;
+	parent->refs++;
+
+	return new;
+
+}
+
+
+
+
+
+/*
+ * give a view its own packed copy of its pixels, and of its mask if
+ * it has one, so that it no longer depends on its parent's layout.
+ */
+static void own_rows(frame *fr)
+{
+	unsigned char *buf;
+
+	if( fr->shared & FRAME_SHARED_DATA )
+		{
+			buf = alloc_pixels(NULL, fr->w * fr->h * RGBA_BYTES);
+			copy_rows(buf, fr->data, fr->w * RGBA_BYTES, fr->h, fr->stride * RGBA_BYTES);
+			fr->data = buf;
+			fr->shared &= ~FRAME_SHARED_DATA;
+		}
 
+	if( fr->mask && (fr->shared & FRAME_SHARED_MASK) && fr->stride != fr->w )
+		{
+			buf = ck_malloc(fr->w * fr->h);
+			copy_rows(buf, fr->mask, fr->w, fr->h, fr->stride);
+			fr->mask = buf;
+			fr->shared &= ~FRAME_SHARED_MASK;
 		}
 
-	/* and copy the pixel format */
-	new->pixel = fr->pixel;
+	fr->stride = fr->w;
+}
+
+
 
-	/* ok, done! */
-	return new;
 
+
+/*
+ * put a frame's mask aside for its views, which go on using it, and
+ * leave the frame without one.  it's freed once the views are gone.
+ */
+static void retire_mask(frame *fr)
+{
+	if( !fr->mask )
+		return;
+
+	if( !fr->old_masks )
+		fr->old_masks = list_create();
+	list_add(fr->old_masks, fr->mask);
+	fr->mask = NULL;
+}
+
+
+
+
+/*
+ * free the masks a frame's views were using, now they're gone
+ */
+static void free_old_masks(frame *fr)
+{
+	if( !fr->old_masks )
+		return;
+
+	while( fr->old_masks->head )
+		free(list_shift(fr->old_masks));
+
+	list_delete(fr->old_masks);
+	fr->old_masks = NULL;
+}
+
+
+
+
+
+/*
+ * allocate a frame's pixel buffer, aligned and with its padding zeroed,
+ * keeping the first size bytes of the old buffer if one is given
+ */
+static void *alloc_pixels(void *orig, size_t size)
+{
+	unsigned char *m;
+
+	if( !size )
+		return orig;
+
+	m = ck_realloc_aligned(orig, size, size + PIXEL_PAD);
+	memset(m + size, 0, PIXEL_PAD);
+
+	return m;
+}
+
+
+
+
+/*
+ * copy rows of len bytes, pitch bytes apart, into a packed buffer
+ */
+static void copy_rows(unsigned char *dest, const unsigned char *src, int len, int h, int pitch)
+{
+	if( len == pitch )
+		{
+			memcpy(dest, src, len * h);
+			return;
+		}
+
+	while( h-- )
+		{
+			memcpy(dest, src, len);
+			dest += len;
+			src += pitch;
+		}
 }
 
 
@@ -525,6 +757,15 @@ frame *frame_convert(frame *fr, int type, const void *aux)
 	if( !fr || (fr->tag != FRAME_RGB && fr->tag != FRAME_RGBA) || type == FRAME_DISPL )
 		return NULL;
 
+	/* views would be left looking at the converted data */
+	if( fr->refs )
+		return NULL;
+
+	/* conversion happens in place, so borrowed data gets copied first, and any scaled copies are stale */
+	if( fr->shared & FRAME_SHARED_DATA )
+		own_rows(fr);
+	drop_scaled_frames(fr);
+
 
 	switch(type)
 		{
@@ -615,7 +856,7 @@ frame *frame_convert(frame *fr, int type, const void *aux)
 					}
 
 				/* update the frame tag and done! */
-				fr->data = ck_realloc(fr->data, fr->w * fr->h);
+				fr->data = alloc_pixels(fr->data, fr->w * fr->h);
 				fr->tag = type;
 				break;
 
@@ -650,7 +891,7 @@ frame *frame_convert(frame *fr, int type, const void *aux)
 
 
 				/* now prepare the auxiliary and scratchpad data */
-				fr->data = ck_realloc(fr->data, fr->w * fr->h);
+				fr->data = alloc_pixels(fr->data, fr->w * fr->h);
 				fr->aux = ck_malloc(sizeof(convolution));
 
 				/* copy the convolution definition */
@@ -690,7 +931,7 @@ frame *frame_convert(frame *fr, int type, const void *aux)
 					}
 
 				/* now prepare the auxiliary data */
-				fr->data = ck_realloc(fr->data, fr->w * fr->h);
+				fr->data = alloc_pixels(fr->data, fr->w * fr->h);
 				fr->aux = ck_malloc(sizeof(lut));
 
 				/* copy in the lookup table */
@@ -809,6 +1050,7 @@ frame *frame_effect(frame *fr, int type, ...)
 					cf_kern.kernel[i] = 1;
 				cf_kern.divisor = blur * blur;
 				cf_kern.offset = 0;
+				cf_kern.mode = CONVO_KERNEL;
 
 				/* and create the frame */
 				cf = frame_create(FRAME_CONVO, new->w, new->h, cf_buf, &cf_kern);
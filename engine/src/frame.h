@@ -3,6 +3,7 @@
  */
 int frame_info(frame *, int *, int *, int *);
 frame *frame_create(int, int, int, const void *, const void *);
+frame *frame_adopt(int, int, int, void *, frame_release, void *);
 frame *frame_copy(frame *);
 void frame_delete(frame *);
 void frame_set_offset(frame *, int, int);
@@ -16,6 +17,12 @@ frame *frame_from_disk(const char *);
 frame *frame_from_buffer(int, const unsigned char *);
 
 static frame *img_unpack(SDL_Surface *);
+static frame *frame_view(frame *, int, int, int, int);
+static void own_rows(frame *);
+static void retire_mask(frame *);
+static void free_old_masks(frame *);
+static void *alloc_pixels(void *, size_t);
+static void copy_rows(unsigned char *, const unsigned char *, int, int, int);
 
 /* from misc.c */
 extern void fatal(char *,int);
@@ -27,8 +34,28 @@ extern renderer system_frame;
 
 extern void unpack_rgb(int, const unsigned char *, unsigned char *);
 extern unsigned char desaturate_pixel(const unsigned char *, pixel_fmt);
+extern void mask_from_pixels(int, const unsigned char *, unsigned char *, pixel_fmt, int);
+extern void free_span_tables(frame *);
+
+/* from list.c */
+extern list *list_create();
+extern void list_delete(list *);
+extern void list_add(list *, void *);
+extern void *list_shift(list *);
+
+/* from scaled.c */
+extern void drop_scaled_frames(frame *);
+
+/* from pack.c */
+extern int pack_frame_bound(frame *, box *);
+
+/* from displace.c */
+extern box *displ_range(short *, int, int);
 
 /* from misc.c */
 extern void *ck_calloc(int, size_t);
 extern void *ck_malloc(size_t);
 extern void *ck_realloc(void *, size_t);
+extern void *ck_realloc_aligned(void *, size_t, size_t);
+extern void ck_free_aligned(void *);
+extern void object_deleted(int, void *);
@@ -24,6 +24,8 @@ void init_brick()
 	init_io();
 	init_fonts();
 	init_events();
+	init_loader();
+	init_workers();
 
 	/* set a default pixel order */
 	set_pixel_order(16, 8, 0);
@@ -38,11 +40,16 @@ void quit_brick()
 	/* always disable the input grab */
 	io_grab(0);
 
+	/* let the loader threads finish up before anything they use goes away */
+	quit_loader();
+	cache_close();
+
 	/* and shut down the graphics and sound output */
 	audio_close();
 	graphics_close();
 
 	/* and unwind the startup process */
+	quit_workers();
 	quit_events();
 	quit_fonts();
 	quit_layers();
@@ -13,6 +13,8 @@ extern void init_layers();
 extern void init_fonts();
 extern void init_io();
 extern void init_events();
+extern void init_loader();
+extern void init_workers();
 
 extern void io_grab(int);
 extern void audio_close();
@@ -21,5 +23,8 @@ extern void graphics_close();
 extern void quit_layers();
 extern void quit_fonts();
 extern void quit_events();
+extern void quit_loader();
+extern void quit_workers();
+extern void cache_close();
 
 extern void set_pixel_order(int, int, int);
@@ -389,7 +389,7 @@ static int cast_ray(point *a, point *b, map *map)
 						/* now, if ck is set to pixel-accurate, test the pixel within the current tile */
 						if( ck == COLLISION_PIXEL )
 							if( ray_t.x < fr->w && ray_t.y < fr->h )
-								 if( *( fr->mask + ray_t.x + ray_t.y * fr->w ) )
+								 if( *( fr->mask + ray_t.x + ray_t.y * fr->stride ) )
 									return 0;
 
 				  }
@@ -481,7 +481,7 @@ static int cast_ray(point *a, point *b, map *map)
 					/* now, if ck is set to pixel-accurate, test the pixel within the current tile */
 					if( ck == COLLISION_PIXEL )
 						if( ray_t.x < fr->w && ray_t.y < fr->h )
-							if( *( fr->mask + ray_t.x + ray_t.y * fr->w ) )
+							if( *( fr->mask + ray_t.x + ray_t.y * fr->stride ) )
 								return 0;
 
 				}
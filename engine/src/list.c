@@ -24,6 +24,8 @@ void list_delete(list *l)
 	if( !l )
 		return;
 
+	object_deleted(OBJ_LIST, l);
+
 	/* free the list and id */
 	list_empty(l);
 	free(l);
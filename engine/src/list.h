@@ -22,3 +22,4 @@ void list_sort(list *, int (*)(void *, void *));
 extern void *ck_malloc(size_t);
 extern void *ck_calloc(int, size_t);
 extern void fatal(char *, int);
+extern void object_deleted(int, void *);
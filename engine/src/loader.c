@@ -0,0 +1,373 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "SDL.h"
+#include "SDL_thread.h"
+#include "SDL_mutex.h"
+#include "SDL_mixer.h"
+#include "common.h"
+#include "loader.h"
+
+
+
+/*
+ * load jobs wait in a queue for the worker threads, which do all of
+ * the decoding and unpacking, then go on a second queue of finished
+ * jobs.  load_poll() empties that one from the main thread, so the
+ * completion callbacks never run on a worker.  the workers are only
+ * started once the first job is queued.
+ */
+static struct load_job *load_head, *load_tail;
+static struct load_job *done_head, *done_tail;
+static int load_next_id;
+static int load_quit;
+
+static SDL_mutex *load_lock;
+static SDL_cond *load_wake;
+static SDL_Thread *load_threads[LOAD_THREADS];
+static int load_running;
+
+
+
+
+/*
+ * prepare the job queues
+ */
+void init_loader()
+{
+	DEBUG( "Initializing asset loader...");
+
+	load_head = load_tail = NULL;
+	done_head = done_tail = NULL;
+	load_next_id = 0;
+	load_quit = 0;
+	load_running = 0;
+
+	load_lock = SDL_CreateMutex();
+	load_wake = SDL_CreateCond();
+	DEBUGF;
+}
+
+
+
+
+void quit_loader()
+{
+	struct load_job *job, *next;
+	int i;
+
+	DEBUG( "Quitting asset loader...");
+
+	/* stop the workers, letting them finish whatever they're loading */
+	SDL_mutexP(load_lock);
+	load_quit = 1;
+	SDL_CondBroadcast(load_wake);
+	SDL_mutexV(load_lock);
+
+	for( i=0; i < load_running; i++ )
+		SDL_WaitThread(load_threads[i], NULL);
+	load_running = 0;
+
+	/* anything unclaimed is dropped, calling back only so its data can be let go of */
+	for( job = load_head; job; job = next )
+		{
+			next = job->next;
+			if( job->done )
+				job->done(job->id, LOAD_DROPPED, NULL, job->data);
+			load_job_free(job, 1);
+		}
+
+	for( job = done_head; job; job = next )
+		{
+			next = job->next;
+			if( job->done )
+				job->done(job->id, LOAD_DROPPED, NULL, job->data);
+			load_job_free(job, 1);
+		}
+
+	load_head = load_tail = NULL;
+	done_head = done_tail = NULL;
+
+	SDL_DestroyCond(load_wake);
+	SDL_DestroyMutex(load_lock);
+	DEBUGF;
+}
+
+
+
+
+
+
+
+
+/*
+ * queue a file to be loaded in the background:
+ * - the type is LOAD_FRAME, LOAD_SOUND or LOAD_SONG.
+ * - for frames, an arg of LOAD_MASK also sets the pixel mask
+ *   from the frame's transparency.  for songs, the arg is the
+ *   fade-in delay, as with song_play_from_disk().
+ * - once it's loaded, the done function is called from
+ *   load_poll() with the job id, the type, the frame or sound
+ *   (or NULL, if it couldn't be loaded) and the data pointer.
+ *   a job still waiting when the loader quits is called back
+ *   from there instead, with LOAD_DROPPED as its type.
+ *
+ * frames come back already in the display's pixel order.  songs
+ * start playing just before the callback.  returns the job id.
+ */
+int load_async(int type, const char *file, int arg, load_done done, void *data)
+{
+	struct load_job *job;
+
+	/* failsafe */
+	if( !file || type < LOAD_FRAME || type > LOAD_SONG )
+		return ERR;
+
+	job = ck_calloc(1, sizeof(struct load_job));
+	job->type = type;
+	job->arg = arg;
+	job->done = done;
+	job->data = data;
+
+	job->file = ck_malloc(strlen(file) + 1);
+	strcpy(job->file, file);
+
+	return queue_job(job);
+
+}
+
+
+
+
+/*
+ * queue a memory buffer to be loaded in the background, as with
+ * load_async().  the buffer is copied, so it can be freed straight away.
+ */
+int load_async_buffer(int type, int len, const unsigned char *buf, int arg, load_done done, void *data)
+{
+	struct load_job *job;
+
+	/* failsafe */
+	if( !buf || len <= 0 || type < LOAD_FRAME || type > LOAD_SONG )
+		return ERR;
+
+	job = ck_calloc(1, sizeof(struct load_job));
+	job->type = type;
+	job->arg = arg;
+	job->done = done;
+	job->data = data;
+
+	job->len = len;
+	job->buf = ck_malloc(len);
+	memcpy(job->buf, buf, len);
+
+	return queue_job(job);
+
+}
+
+
+
+
+/*
+ * hand over every finished job:  songs are started, and the callbacks
+ * run.  render_display() calls this once a frame.  returns the number
+ * of jobs finished.
+ */
+int load_poll()
+{
+	struct load_job *job, *next;
+	int ct;
+
+	/* nothing ever queued? */
+	if( !load_running )
+		return 0;
+
+	/* take the whole list, so the callbacks run without the lock */
+	SDL_mutexP(load_lock);
+	job = done_head;
+	done_head = done_tail = NULL;
+	SDL_mutexV(load_lock);
+
+	for( ct = 0; job; job = next, ct++ )
+		{
+			next = job->next;
+
+			/* songs can only be started from here, and the song takes over the buffer */
+			if( job->type == LOAD_SONG && job->result )
+				{
+					song_play_loaded(job->result, job->buf, job->arg);
+					job->buf = NULL;
+				}
+
+			if( job->done )
+				job->done(job->id, job->type, job->result, job->data);
+
+			load_job_free(job, 0);
+		}
+
+	return ct;
+
+}
+
+
+
+
+
+
+
+
+
+/*
+ * give a new job its id and queue it, starting the workers if need be
+ */
+static int queue_job(struct load_job *job)
+{
+	int id;
+
+	SDL_mutexP(load_lock);
+
+	while( load_running < LOAD_THREADS )
+		load_threads[load_running++] = SDL_CreateThread(load_worker, NULL);
+
+	if( ++load_next_id <= 0 )
+		load_next_id = 1;
+	job->id = id = load_next_id;
+
+	if( load_tail )
+		load_tail->next = job;
+	else
+		load_head = job;
+	load_tail = job;
+
+	SDL_CondSignal(load_wake);
+	SDL_mutexV(load_lock);
+
+	return id;
+}
+
+
+
+
+/*
+ * a worker thread:  take the oldest job, load it, and pass it on
+ */
+static int load_worker(void *data)
+{
+	struct load_job *job;
+
+	SDL_mutexP(load_lock);
+
+	while( 1 )
+		{
+			while( !load_head && !load_quit )
+				SDL_CondWait(load_wake, load_lock);
+
+			if( load_quit )
+				break;
+
+			job = load_head;
+			load_head = job->next;
+			if( !load_head )
+				load_tail = NULL;
+
+			/* the loading itself runs unlocked, alongside the other workers */
+			SDL_mutexV(load_lock);
+			load_job_run(job);
+			SDL_mutexP(load_lock);
+
+			job->next = NULL;
+			if( done_tail )
+				done_tail->next = job;
+			else
+				done_head = job;
+			done_tail = job;
+		}
+
+	SDL_mutexV(load_lock);
+	return 0;
+
+}
+
+
+
+
+/*
+ * do the actual loading, leaving nothing for the main thread to do
+ */
+static void load_job_run(struct load_job *job)
+{
+	SDL_RWops *rw_buf;
+	frame *fr;
+
+	switch(job->type)
+		{
+			case LOAD_FRAME:
+				fr = job->file ? frame_from_disk(job->file) : frame_from_buffer(job->len, job->buf);
+				if( !fr )
+					break;
+
+				/*
+				 * get the swizzle out of the way now, rather than on the first blit.
+				 * the frame's not been drawn yet, so the mask leaves the scaled cache alone
+				 */
+				swizzle_pixels(fr);
+				if( job->arg & LOAD_MASK )
+					frame_set_mask_from(fr, fr);
+
+				job->result = fr;
+				break;
+
+			case LOAD_SOUND:
+				job->result = job->file ? sound_load_from_disk(job->file) : sound_load_from_buffer(job->len, job->buf);
+				break;
+
+			case LOAD_SONG:
+				if( job->file )
+					job->result = Mix_LoadMUS(job->file);
+				else
+					{
+						/* the mixer reads the song from our buffer, which is kept for it */
+						rw_buf = SDL_RWFromMem(job->buf, job->len);
+						if( !rw_buf )
+							fatal("RWops buffer alloc failed!",99);
+
+						job->result = Mix_LoadMUS_RW(rw_buf);
+						SDL_FreeRW(rw_buf);
+					}
+				break;
+		}
+
+}
+
+
+
+
+/*
+ * free a job, and if it was never claimed, whatever it loaded
+ */
+static void load_job_free(struct load_job *job, int unclaimed)
+{
+	sound *s;
+
+	if( unclaimed && job->result )
+		switch(job->type)
+			{
+				case LOAD_FRAME:
+					frame_delete(job->result);
+					break;
+
+				case LOAD_SOUND:
+					s = job->result;
+					Mix_FreeChunk(s->wave);
+					free(s);
+					break;
+
+				case LOAD_SONG:
+					Mix_FreeMusic(job->result);
+					break;
+			}
+
+	free(job->file);
+	free(job->buf);
+	free(job);
+}
@@ -0,0 +1,54 @@
+/*
+ * background asset loading
+ */
+
+/* how many worker threads decode assets */
+#define LOAD_THREADS 2
+
+struct load_job
+{
+	int id;
+	int type;
+	int arg;                  /* frames:  LOAD_MASK.  songs:  the fade-in delay */
+	char *file;               /* the file to load, or NULL .. */
+	unsigned char *buf;       /* .. for our own copy of a memory buffer */
+	int len;
+	load_done done;
+	void *data;
+	void *result;             /* the loaded asset, or NULL if loading failed */
+	struct load_job *next;
+};
+
+
+
+void init_loader();
+void quit_loader();
+
+int load_async(int, const char *, int, load_done, void *);
+int load_async_buffer(int, int, const unsigned char *, int, load_done, void *);
+int load_poll();
+
+static int queue_job(struct load_job *);
+static int load_worker(void *);
+static void load_job_run(struct load_job *);
+static void load_job_free(struct load_job *, int);
+
+
+/* from frame.c */
+extern void frame_delete(frame *);
+extern int frame_set_mask_from(frame *, frame *);
+extern frame *frame_from_disk(const char *);
+extern frame *frame_from_buffer(int, const unsigned char *);
+
+/* from pixel.c */
+extern void swizzle_pixels(frame *);
+
+/* from audio.c */
+extern sound *sound_load_from_disk(const char *);
+extern sound *sound_load_from_buffer(int, const unsigned char *);
+extern void song_play_loaded(void *, unsigned char *, int);
+
+/* from misc.h */
+extern void fatal(char *,int);
+extern void *ck_malloc(size_t);
+extern void *ck_calloc(int, size_t);
@@ -82,6 +82,8 @@ void map_delete(map *m)
 	if( !m )
 		return;
 
+	object_deleted(OBJ_MAP, m);
+
 	/* free the map data */
 	if( m->data )
 		free(m->data);
@@ -33,3 +33,4 @@ extern void *ck_malloc(size_t);
 extern void *ck_calloc(int, size_t);
 extern void *ck_realloc(void *, size_t);
 extern void fatal(char *,int);
+extern void object_deleted(int, void *);
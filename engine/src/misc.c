@@ -1,10 +1,17 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
 #include "common.h"
 #include "misc.h"
 
 
 
+/* the function told about each object as it's deleted, if any */
+static delete_hook on_delete;
+
+
+
 
 
 
@@ -62,6 +69,87 @@ void *ck_realloc(void *orig, size_t size)
 
 
 
+
+/*
+ * aligned versions of the above, for pixel buffers.  the block is
+ * over-allocated, and the address malloc() returned is kept just
+ * before the aligned start, for ck_free_aligned() to hand back.
+ */
+void *ck_malloc_aligned(size_t size)
+{
+	unsigned char *m, *p;
+
+	if( !size )
+		return NULL;
+
+	m = malloc(size + PIXEL_ALIGN + sizeof(void *));
+	if( !m )
+		fatal("malloc failed!",99);
+
+	p = (unsigned char *)(((uintptr_t)(m + sizeof(void *)) + PIXEL_ALIGN - 1) & ~(uintptr_t)(PIXEL_ALIGN - 1));
+	((void **)p)[-1] = m;
+
+	return p;
+
+}
+
+
+/* the contents are kept, up to the smaller of the old and new sizes */
+void *ck_realloc_aligned(void *orig, size_t old_size, size_t size)
+{
+	void *m;
+
+	if( !size )
+		return orig;
+
+	m = ck_malloc_aligned(size);
+	if( orig )
+		{
+			memcpy(m, orig, old_size < size ? old_size : size);
+			ck_free_aligned(orig);
+		}
+
+	return m;
+
+}
+
+
+void ck_free_aligned(void *p)
+{
+	if( p )
+		free(((void **)p)[-1]);
+}
+
+
+
+
+
+
+/*
+ * have a function told whenever a frame, sprite, tile, map, list,
+ * string or pack is deleted, however it comes to be, e.g. so a
+ * binding can forget its handles for it.  it's told the kind of
+ * object (one of the OBJ_* constants) and its address, just before
+ * it's freed.  NULL stops the calls.
+ */
+void set_delete_hook(delete_hook fn)
+{
+	on_delete = fn;
+}
+
+
+/* let the delete hook know an object's going */
+void object_deleted(int kind, void *ptr)
+{
+	if( on_delete )
+		on_delete(kind, ptr);
+}
+
+
+
+
+
+
 /*
  * use this to sudden exit
  */
@@ -5,4 +5,11 @@ void *ck_malloc(size_t);
 void *ck_calloc(int, size_t);
 void *ck_realloc(void *, size_t);
 
+void *ck_malloc_aligned(size_t);
+void *ck_realloc_aligned(void *, size_t, size_t);
+void ck_free_aligned(void *);
+
+void set_delete_hook(delete_hook);
+void object_deleted(int, void *);
+
 void fatal(char *,int);
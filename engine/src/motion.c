@@ -600,25 +600,47 @@ int motion_exec_list(list *l)
 	/* the results */
 	int res;
 
+	/* for the profiler:  collision tests made by the programs are counted separately */
+	long long t, ct;
+
 	/* fetch the list pointer and verify */
 	if( !l )
 		return ERR_BAD_LIST;
 
 
 	/* and step through the list */
+	STATS_START(t);
+	ct = stats_time[STATS_COLLISION];
+	res = 0;
+
 	iterator_start(iter, l);
 	while( (s = iterator_data(iter)) )
 		{
 			/* run the code, and check the result */
 			res = motion_exec_single(s);
 			if( res < 0 )
-				return res;
+				break;
 
 			iterator_next(iter);
 		}
 
+	/*
+	 * charge the loop's time less the collision tests within it.  if the
+	 * profiler was switched on or reset part way, the figures don't line
+	 * up, so neither part is allowed to go below zero.
+	 */
+	if( stats_active && t )
+		{
+			t = clock_ns() - t;
+			ct = stats_time[STATS_COLLISION] - ct;
+			if( ct > 0 )
+				t -= ct;
+			if( t > 0 )
+				stats_time[STATS_MOTION] += t;
+		}
+
 
-	/* success! */
-	return 0;
+	/* success, or the first failure */
+	return res < 0 ? res : 0;
 
 }
@@ -178,3 +178,10 @@ extern void list_remove(list *, void *, int);
 
 /* from misc.c */
 extern void *ck_malloc(size_t);
+
+/* from stats.c */
+extern int stats_active;
+extern long long stats_time[];
+
+/* from clock.c */
+extern long long clock_ns();
@@ -0,0 +1,740 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "SDL.h"
+#include "SDL_mixer.h"
+#include "common.h"
+#include "pack.h"
+
+
+
+/*
+ * an asset pack is mapped privately and read-write:  frames and sounds
+ * point straight into the mapping, so the pages are shared between
+ * every process using the pack until something writes to them.  each
+ * of them holds a reference to the pack, and a closed pack stays
+ * mapped until the last of them is deleted.
+ */
+
+
+/*
+ * every open pack, sorted by where it's mapped, so a frame's mask can
+ * be traced back to its entry with a pair of binary searches
+ */
+static pack **packs;
+static int pack_ct, pack_slots;
+
+
+
+
+/*
+ * map an asset pack, checking that everything in it lies within the file
+ */
+pack *pack_open(const char *file)
+{
+	const struct pack_header *head;
+	const struct pack_entry *dir;
+	struct stat st;
+	void *map;
+	pack *p;
+	int fd, i, pos;
+
+	/* failsafe */
+	if( !file )
+		return NULL;
+
+	/* map the file */
+	fd = open(file, O_RDONLY);
+	if( fd < 0 )
+		return NULL;
+
+	if( fstat(fd, &st) || st.st_size < (off_t)sizeof(struct pack_header) )
+		{
+			close(fd);
+			return NULL;
+		}
+
+	map = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if( map == MAP_FAILED )
+		return NULL;
+
+
+	/* is it a pack we understand? */
+	head = map;
+	if( memcmp(head->magic, PACK_MAGIC, 4) || SDL_SwapLE32(head->version) != PACK_VERSION || SDL_SwapLE32(head->count) < 0 || \
+		 SDL_SwapLE32(head->count) > (st.st_size - (long)sizeof(struct pack_header)) / (long)sizeof(struct pack_entry) )
+		{
+			munmap(map, st.st_size);
+			return NULL;
+		}
+
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+	/* the numbers are little-endian, so turn them around first */
+	swap_pack(map, st.st_size);
+#endif
+
+	p = ck_calloc(1, sizeof(pack));
+	p->map = map;
+	p->len = st.st_size;
+	p->count = head->count;
+	p->dir = dir = (const struct pack_entry *)(head + 1);
+
+	p->pixel.rshift = head->order[0];
+	p->pixel.gshift = head->order[1];
+	p->pixel.bshift = head->order[2];
+	p->pixel.ashift = head->order[3];
+
+	/* check every entry up front, so the getters can trust them */
+	for( i=0; i < p->count; i++ )
+		if( !check_entry(p, dir + i) )
+			{
+				munmap(map, st.st_size);
+				free(p);
+				return NULL;
+			}
+
+	/* index the masks that have a box */
+	p->masks = ck_malloc((p->count ? p->count : 1) * sizeof(*p->masks));
+	for( i=0; i < p->count; i++ )
+		if( dir[i].type == PACK_FRAME && dir[i].mask && dir[i].bound[2] )
+			p->masks[p->mask_ct++] = dir + i;
+	qsort(p->masks, p->mask_ct, sizeof(*p->masks), compare_mask);
+
+	/* and slot the pack in among the rest */
+	if( pack_ct == pack_slots )
+		{
+			pack_slots = pack_slots ? pack_slots * 2 : 8;
+			packs = ck_realloc(packs, pack_slots * sizeof(*packs));
+		}
+
+	pos = find_pack(map);
+	memmove(packs + pos + 1, packs + pos, (pack_ct - pos) * sizeof(*packs));
+	packs[pos] = p;
+	pack_ct++;
+
+	return p;
+
+}
+
+
+
+
+/*
+ * close a pack.  it's unmapped once every frame and sound taken from
+ * it is gone; until then, they're still good.
+ */
+void pack_close(pack *p)
+{
+	/* failsafe */
+	if( !p || p->closed )
+		return;
+
+	object_deleted(OBJ_PACK, p);
+
+	p->closed = 1;
+	if( !p->refs )
+		unmap_pack(p);
+}
+
+
+
+
+/*
+ * make a frame from the named pack entry.  the pixels and the pixel
+ * mask aren't copied, so the frame keeps the pack mapped until it's
+ * deleted.
+ */
+frame *pack_get_frame(pack *p, const char *name)
+{
+	const struct pack_entry *e;
+
+	e = find_entry(p, name, PACK_FRAME);
+	if( !e )
+		return NULL;
+
+	return shared_frame(p, e->tag, e->w, e->h, (unsigned char *)p->map + e->data, \
+		e->mask ? (unsigned char *)p->map + e->mask : NULL);
+
+}
+
+
+
+
+/*
+ * retrieve the bounding box of the opaque pixels in the named frame
+ */
+int pack_get_bound(pack *p, const char *name, box *res)
+{
+	const struct pack_entry *e;
+
+	e = find_entry(p, name, PACK_FRAME);
+	if( !e || !res )
+		return ERR;
+
+	res->x1 = e->bound[0];
+	res->y1 = e->bound[1];
+	res->x2 = e->bound[2];
+	res->y2 = e->bound[3];
+	return 0;
+
+}
+
+
+
+
+/*
+ * find the precomputed bounding box of a frame whose pixel mask
+ * came from a pack, sparing a scan of the mask
+ */
+int pack_frame_bound(frame *fr, box *res)
+{
+	const struct pack_entry *e;
+	unsigned char *map;
+	int pos, lo, hi, mid;
+	pack *p;
+
+	/* failsafe.  a view may share a pack frame's mask, but not its box */
+	if( !fr || !res || !fr->mask || !(fr->shared & FRAME_SHARED_MASK) || fr->parent || !pack_ct )
+		return ERR;
+
+	/* which pack is the mask in?  the last one mapped at or before it, if any */
+	pos = find_pack(fr->mask + 1) - 1;
+	if( pos < 0 )
+		return ERR;
+
+	p = packs[pos];
+	map = p->map;
+	if( fr->mask >= map + p->len )
+		return ERR;
+
+	/* and which entry?  an empty mask has no box, so it's left to the caller */
+	lo = 0;
+	hi = p->mask_ct;
+	while( lo < hi )
+		{
+			mid = (lo + hi) / 2;
+			e = p->masks[mid];
+			if( e->mask == fr->mask - map )
+				{
+					if( fr->w != e->w || fr->h != e->h || fr->stride != e->w )
+						return ERR;
+
+					res->x1 = e->bound[0];
+					res->y1 = e->bound[1];
+					res->x2 = e->bound[2];
+					res->y2 = e->bound[3];
+					return 0;
+				}
+
+			if( e->mask < fr->mask - map )
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+
+	return ERR;
+
+}
+
+
+
+
+/*
+ * make a sound from the named pack entry.  the samples must already
+ * be in the mixer's format, as with sound_load_raw(), and are played
+ * straight from the mapping.  sounds are never freed, so a pack that's
+ * handed one out stays mapped.
+ */
+sound *pack_get_sound(pack *p, const char *name)
+{
+	const struct pack_entry *e;
+	sound *s;
+
+	e = find_entry(p, name, PACK_SOUND);
+	if( !e )
+		return NULL;
+
+	s = ck_malloc(sizeof(sound));
+	s->buf = NULL;
+	s->wave = Mix_QuickLoad_RAW((unsigned char *)p->map + e->data, e->len);
+	if( !s->wave )
+		{
+			free(s);
+			return NULL;
+		}
+
+	p->refs++;
+	return s;
+
+}
+
+
+
+
+/*
+ * add the named font from the pack.  its characters are stored
+ * already sliced, after a table of their widths.  nothing says when a
+ * font's finished with, so the characters are copied out of the pack,
+ * leaving it free to be closed.
+ */
+int pack_load_font(pack *p, const char *name)
+{
+	const struct pack_entry *e;
+	const int32_t *widths;
+	frame *chars[FONT_CT];
+	unsigned char *data;
+	frame *fr;
+	int i;
+
+	e = find_entry(p, name, PACK_FONT);
+	if( !e )
+		return ERR;
+
+	widths = (const int32_t *)((unsigned char *)p->map + e->data);
+	data = (unsigned char *)(widths + FONT_CT);
+
+	for( i=0; i < FONT_CT; i++ )
+		{
+			fr = shared_frame(p, FRAME_RGBA, widths[i], e->h, data, NULL);
+			chars[i] = frame_copy(fr);
+			frame_delete(fr);
+			data += widths[i] * e->h * RGBA_BYTES;
+		}
+
+	font_add_slices(name, chars);
+	return 0;
+
+}
+
+
+
+
+
+
+
+
+
+
+/*
+ * write a pack holding a single frame, named "frame".  its pixels are
+ * stored in the frame's own pixel order, and the bounding box is that
+ * of the frame's pixel mask, if it has one.
+ */
+int pack_save_frame(const char *file, frame *fr, box *bound)
+{
+	struct pack_entry e;
+	unsigned char order[4];
+	int ok;
+
+	/* failsafe */
+	if( !file || !fr || (fr->tag != FRAME_RGB && fr->tag != FRAME_RGBA) )
+		return ERR;
+
+	memset(&e, 0, sizeof(e));
+	strcpy(e.name, "frame");
+	e.type = PACK_FRAME;
+	e.tag = fr->tag;
+	e.w = fr->w;
+	e.h = fr->h;
+	e.len = fr->w * fr->h * RGBA_BYTES;
+
+	if( bound )
+		{
+			e.bound[0] = bound->x1;
+			e.bound[1] = bound->y1;
+			e.bound[2] = bound->x2;
+			e.bound[3] = bound->y2;
+		}
+
+	order[0] = fr->pixel.rshift;
+	order[1] = fr->pixel.gshift;
+	order[2] = fr->pixel.bshift;
+	order[3] = fr->pixel.ashift;
+
+	/* a view's rows aren't next to each other, so save a packed copy of it */
+	if( fr->stride != fr->w )
+		{
+			fr = frame_copy(fr);
+			ok = write_pack(file, order, &e, fr->data, fr->mask);
+			frame_delete(fr);
+			return ok;
+		}
+
+	return write_pack(file, order, &e, fr->data, fr->mask);
+
+}
+
+
+
+
+/*
+ * write a pack holding a single sound, named "sound", from samples
+ * already in the mixer's format
+ */
+int pack_save_sound(const char *file, int len, const unsigned char *samples)
+{
+	struct pack_entry e;
+	unsigned char order[4] = { 0, 8, 16, 24 };
+
+	/* failsafe */
+	if( !file || !samples || len < 0 )
+		return ERR;
+
+	memset(&e, 0, sizeof(e));
+	strcpy(e.name, "sound");
+	e.type = PACK_SOUND;
+	e.len = len;
+
+	return write_pack(file, order, &e, samples, NULL);
+
+}
+
+
+
+
+
+
+
+
+
+
+/*
+ * look up an entry of the given type by name
+ */
+static const struct pack_entry *find_entry(pack *p, const char *name, int type)
+{
+	const struct pack_entry *e;
+
+	/* failsafe */
+	if( !p || !name )
+		return NULL;
+
+	/* the directory is sorted, so this is a binary search */
+	e = bsearch(name, p->dir, p->count, sizeof(struct pack_entry), compare_entry);
+	if( !e || e->type != type )
+		return NULL;
+
+	return e;
+}
+
+
+
+
+/*
+ * compare a name against a directory entry
+ */
+static int compare_entry(const void *name, const void *e)
+{
+	return strncmp(name, ((const struct pack_entry *)e)->name, PACK_NAME_LEN);
+}
+
+
+
+
+/*
+ * compare two directory entries by where their masks lie
+ */
+static int compare_mask(const void *a, const void *b)
+{
+	const struct pack_entry *ea = *(const struct pack_entry * const *)a;
+	const struct pack_entry *eb = *(const struct pack_entry * const *)b;
+
+	return (ea->mask > eb->mask) - (ea->mask < eb->mask);
+}
+
+
+
+
+/*
+ * where among the open packs one mapped at the given address goes:
+ * the first that's mapped at or after it
+ */
+static int find_pack(const void *map)
+{
+	int lo, hi, mid;
+
+	lo = 0;
+	hi = pack_ct;
+	while( lo < hi )
+		{
+			mid = (lo + hi) / 2;
+			if( (const unsigned char *)packs[mid]->map < (const unsigned char *)map )
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+
+	return lo;
+}
+
+
+
+
+/*
+ * is this entry's data all inside the file, and the size it claims?
+ */
+static int check_entry(pack *p, const struct pack_entry *e)
+{
+	int i;
+	long long need, size;
+	const int32_t *widths;
+
+	if( e->data < 0 || e->len < 0 || e->data % 4 || e->data + (long long)e->len > p->len )
+		return 0;
+
+	switch(e->type)
+		{
+			case PACK_FRAME:
+				/* the size is checked against the length before it's worked out, so it can't overflow */
+				if( (e->tag != FRAME_RGBA && e->tag != FRAME_RGB) || e->w <= 0 || e->h <= 0 )
+					return 0;
+				if( (long long)e->w * e->h > e->len / RGBA_BYTES || e->len != e->w * e->h * RGBA_BYTES )
+					return 0;
+				if( e->mask && (e->mask < 0 || e->mask + (long long)e->w * e->h > p->len) )
+					return 0;
+
+				/* the box goes to sprite bounds and collision clips, so it has to lie inside the frame */
+				if( e->bound[0] < 0 || e->bound[1] < 0 || e->bound[0] > e->bound[2] || e->bound[1] > e->bound[3] || \
+					 e->bound[2] > e->w || e->bound[3] > e->h )
+					return 0;
+				return 1;
+
+			case PACK_SOUND:
+				return 1;
+
+			case PACK_FONT:
+				/* a table of widths, then each character's pixels */
+				if( e->h <= 0 || e->len < FONT_CT * (long)sizeof(int32_t) )
+					return 0;
+
+				widths = (const int32_t *)((unsigned char *)p->map + e->data);
+				need = FONT_CT * sizeof(int32_t);
+				for( i=0; i < FONT_CT; i++ )
+					{
+						if( widths[i] <= 0 )
+							return 0;
+
+						/* stop as soon as it's more than there is, before it can overflow */
+						size = (long long)widths[i] * e->h;
+						if( size > e->len )
+							return 0;
+						need += size * RGBA_BYTES;
+						if( need > e->len )
+							return 0;
+					}
+
+				return need == e->len;
+		}
+
+	return 0;
+}
+
+
+
+
+/*
+ * write out a pack of one entry:  the header, the entry, its data and
+ * any mask, each aligned as brickpack does
+ */
+static int write_pack(const char *file, const unsigned char *order, struct pack_entry *e, const void *data, const void *mask)
+{
+	static const unsigned char pad[PACK_ALIGN];
+	struct pack_header head;
+	struct pack_entry out;
+	FILE *fp;
+	long pos;
+	int ok;
+
+	pos = sizeof(struct pack_header) + sizeof(struct pack_entry);
+	pos = (pos + PACK_ALIGN - 1) & ~(long)(PACK_ALIGN - 1);
+	e->data = pos;
+
+	if( mask )
+		{
+			pos = (pos + e->len + PACK_ALIGN - 1) & ~(long)(PACK_ALIGN - 1);
+			e->mask = pos;
+		}
+
+	fp = fopen(file, "wb");
+	if( !fp )
+		return ERR;
+
+	memcpy(head.magic, PACK_MAGIC, 4);
+	head.version = PACK_VERSION;
+	head.count = 1;
+	memcpy(head.order, order, 4);
+	out = *e;
+
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+	/* the numbers are written little-endian */
+	swap_header(&head);
+	swap_entry(&out);
+#endif
+
+	ok = fwrite(&head, sizeof(head), 1, fp) == 1 && fwrite(&out, sizeof(out), 1, fp) == 1;
+	ok = ok && fwrite(pad, 1, e->data - sizeof(head) - sizeof(*e), fp) == e->data - sizeof(head) - sizeof(*e);
+	ok = ok && fwrite(data, 1, e->len, fp) == e->len;
+	if( mask )
+		{
+			ok = ok && fwrite(pad, 1, e->mask - e->data - e->len, fp) == e->mask - e->data - e->len;
+			ok = ok && fwrite(mask, 1, e->w * e->h, fp) == e->w * e->h;
+		}
+
+	if( fclose(fp) || !ok )
+		{
+			remove(file);
+			return ERR;
+		}
+
+	return 0;
+}
+
+
+
+
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+/*
+ * turn the numbers in a freshly mapped pack to the host's order:  the
+ * header, the directory, and each font's table of widths.  only what
+ * lies within the file is touched; check_entry() finds the rest.
+ */
+static void swap_pack(void *map, long len)
+{
+	struct pack_entry *e;
+	int32_t *widths;
+	int i, j;
+
+	/* the header's already been checked, so the directory's all there */
+	swap_header(map);
+
+	e = (struct pack_entry *)((struct pack_header *)map + 1);
+	for( i=0; i < ((struct pack_header *)map)->count; i++, e++ )
+		{
+			swap_entry(e);
+			if( e->type != PACK_FONT || e->data < 0 || e->data % 4 || e->data + FONT_CT * (long long)sizeof(int32_t) > len )
+				continue;
+
+			widths = (int32_t *)((unsigned char *)map + e->data);
+			for( j=0; j < FONT_CT; j++ )
+				widths[j] = SDL_Swap32(widths[j]);
+		}
+}
+
+
+
+
+/*
+ * turn a pack header's numbers around.  a shift is the bit position of
+ * a byte in a pixel read as a 32-bit number, which is reversed too.
+ */
+static void swap_header(struct pack_header *head)
+{
+	int i;
+
+	head->version = SDL_Swap32(head->version);
+	head->count = SDL_Swap32(head->count);
+	for( i=0; i < 4; i++ )
+		head->order[i] = 24 - head->order[i];
+}
+
+
+
+
+/*
+ * turn a directory entry's numbers around
+ */
+static void swap_entry(struct pack_entry *e)
+{
+	int i;
+
+	e->type = SDL_Swap32(e->type);
+	e->tag = SDL_Swap32(e->tag);
+	e->w = SDL_Swap32(e->w);
+	e->h = SDL_Swap32(e->h);
+	e->data = SDL_Swap32(e->data);
+	e->len = SDL_Swap32(e->len);
+	e->mask = SDL_Swap32(e->mask);
+	for( i=0; i < 4; i++ )
+		e->bound[i] = SDL_Swap32(e->bound[i]);
+	e->reserved = SDL_Swap32(e->reserved);
+}
+#endif
+
+
+
+
+/*
+ * let go of a pack's mapping:  it's taken out of the index, so no
+ * frame's mask is traced back to it any more
+ */
+static void unmap_pack(pack *p)
+{
+	int pos;
+
+	pos = find_pack(p->map);
+	if( pos < pack_ct && packs[pos] == p )
+		{
+			pack_ct--;
+			memmove(packs + pos, packs + pos + 1, (pack_ct - pos) * sizeof(*packs));
+		}
+
+	munmap(p->map, p->len);
+	free(p->masks);
+	free(p);
+}
+
+
+
+
+/*
+ * a frame taken from a pack has been deleted
+ */
+static void release_pack(void *owner)
+{
+	pack *p = owner;
+
+	if( !--p->refs && p->closed )
+		unmap_pack(p);
+}
+
+
+
+
+/*
+ * a frame whose pixels and mask live in the pack
+ */
+static frame *shared_frame(pack *p, int tag, int w, int h, unsigned char *data, unsigned char *mask)
+{
+	frame *f;
+
+	f = ck_calloc(1, sizeof(frame));
+	f->tag = tag;
+	f->w = w;
+	f->h = h;
+	f->data = data;
+	f->mask = mask;
+	f->stride = w;
+	f->shared = FRAME_SHARED_DATA | FRAME_SHARED_MASK;
+
+	/* and the pack stays mapped until it's deleted */
+	f->release = release_pack;
+	f->owner = p;
+	p->refs++;
+
+	/* if the pixels were stored in the display's order, they're ready to draw */
+	f->pixel = p->pixel;
+	if( p->pixel.rshift == system_pixel.rshift && p->pixel.gshift == system_pixel.gshift && \
+		 p->pixel.bshift == system_pixel.bshift && p->pixel.ashift == system_pixel.ashift )
+		f->pixel.epoch = system_pixel.epoch;
+
+	f->clip_rect.x2 = w;
+	f->clip_rect.y2 = h;
+
+	return f;
+}
@@ -0,0 +1,85 @@
+/*
+ * memory-mapped asset packs
+ */
+
+/* the pack file header, and the version of the format read here */
+#define PACK_MAGIC "BRPK"
+#define PACK_VERSION 1
+
+/* what each directory entry holds */
+#define PACK_FRAME 1
+#define PACK_SOUND 2
+#define PACK_FONT 3
+
+#define PACK_NAME_LEN 32
+
+/* every data block starts on this boundary */
+#define PACK_ALIGN 16
+
+/*
+ * the file starts with the header and the directory, sorted by name.
+ * all the numbers are 32-bit little-endian, and are turned around as
+ * the pack is mapped on a big-endian host.  every data block is
+ * aligned to 16 bytes.
+ */
+struct pack_header
+{
+	char magic[4];
+	int32_t version;
+	int32_t count;
+	unsigned char order[4];       /* the r, g, b and a shifts of the stored pixels */
+};
+
+struct pack_entry
+{
+	char name[PACK_NAME_LEN];
+	int32_t type;
+	int32_t tag;                  /* frames:  the frame type */
+	int32_t w, h;
+	int32_t data, len;            /* file offset and length of the pixels or samples */
+	int32_t mask;                 /* frames:  file offset of the pixel mask, or 0 */
+	int32_t bound[4];             /* frames:  the bounding box of the opaque pixels */
+	int32_t reserved;
+};
+
+pack *pack_open(const char *);
+void pack_close(pack *);
+frame *pack_get_frame(pack *, const char *);
+int pack_get_bound(pack *, const char *, box *);
+sound *pack_get_sound(pack *, const char *);
+int pack_load_font(pack *, const char *);
+int pack_frame_bound(frame *, box *);
+int pack_save_frame(const char *, frame *, box *);
+int pack_save_sound(const char *, int, const unsigned char *);
+
+static const struct pack_entry *find_entry(pack *, const char *, int);
+static int compare_entry(const void *, const void *);
+static int compare_mask(const void *, const void *);
+static int find_pack(const void *);
+static int check_entry(pack *, const struct pack_entry *);
+static int write_pack(const char *, const unsigned char *, struct pack_entry *, const void *, const void *);
+static void unmap_pack(pack *);
+static void release_pack(void *);
+static frame *shared_frame(pack *, int, int, int, unsigned char *, unsigned char *);
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+static void swap_pack(void *, long);
+static void swap_header(struct pack_header *);
+static void swap_entry(struct pack_entry *);
+#endif
+
+
+/* from font.c */
+extern void font_add_slices(const char *, frame **);
+
+/* from frame.c */
+extern frame *frame_copy(frame *);
+extern void frame_delete(frame *);
+
+/* from pixel.c */
+extern pixel_fmt system_pixel;
+
+/* from misc.c */
+extern void *ck_malloc(size_t);
+extern void *ck_calloc(int, size_t);
+extern void *ck_realloc(void *, size_t);
+extern void object_deleted(int, void *);
@@ -28,12 +28,12 @@ void rgb_frame_be(frame *dest, frame *f, point *ofs)
 				swizzle_pixels(f);
 
 			/* set dest and filter pointers */
-			src = f->data + (cres.sx + f->w * cres.sy) * RGBA_BYTES;
+			src = f->data + (cres.sx + f->stride * cres.sy) * RGBA_BYTES;
 			tgt = dest->data + (cres.dx + dest->w * cres.dy) * RGBA_BYTES;
 			while( cres.dh-- )
 				{
 					rgb_line(cres.dw, src, tgt);
-					src += f->w * RGBA_BYTES;
+					src += f->stride * RGBA_BYTES;
 					tgt += dest->w * RGBA_BYTES;
 				}
 
@@ -48,7 +48,7 @@ void rgb_frame_be_scaled(frame *dest, frame *f, point *ofs, dimensions *span)
 
 	/* pointers into the rgb data, mask, and render surface */
 	unsigned char *src, *mask, *tgt;
-	point scan, inc;
+	int *xs, *ys, i;
 
 
 	/* failsafe */
@@ -62,28 +62,18 @@ void rgb_frame_be_scaled(frame *dest, frame *f, point *ofs, dimensions *span)
 			if( f->pixel.epoch < system_pixel.epoch )
 				swizzle_pixels(f);
 
-			/* set up scalar increments */
-			inc.x = fp_set(f->w) / span->w;
-			inc.y = fp_set(f->h) / span->h;
-			scan.x = fp_frac(cres.sx * inc.x);
-			scan.y = fp_frac(cres.sy * inc.y);
+			/* the source column and row each one drawn is taken from */
+			xs = span_table(f, SPAN_COLUMNS, span->w)->idx + cres.sx;
+			ys = span_table(f, SPAN_ROWS, span->h)->idx + cres.sy;
 
 			/* set source and target pointers */
-			src = f->data + (fp_int(cres.sx * inc.x) + fp_int(cres.sy * inc.y) * f->w) * RGBA_BYTES;
 			tgt = dest->data + (cres.dx + dest->w * cres.dy) * RGBA_BYTES;
 
 			/* draw the scaled rgb data */
-			while( cres.dh-- )
+			for( i=0; i < cres.dh; i++ )
 				{
-					rgb_line_scaled(cres.dw, scan.x, inc.x, src, tgt);
-
-					/* and adjust the y-increment */
-					scan.y += inc.y;
-					if( scan.y >= fp_set(1) )
-						{
-							src += fp_int(scan.y) * f->w * RGBA_BYTES;
-							scan.y = fp_frac(scan.y);
-						}
+					src = f->data + ys[i] * f->stride * RGBA_BYTES;
+					rgb_line_scaled(cres.dw, xs, src, tgt);
 
 					/* update the destination pointer */
 					tgt += dest->w * RGBA_BYTES;
@@ -105,21 +95,13 @@ static void rgb_line(int len, unsigned char *src, unsigned char *tgt)
 		}
 }
 
-static void rgb_line_scaled(int len, int xi, int xf, unsigned char *src, unsigned char *tgt)
+static void rgb_line_scaled(int len, const int *xs, unsigned char *src, unsigned char *tgt)
 {
-	while( len-- )
-		{
-			rgb_pixel(src, tgt);
-
-			/* adjust the source according to the fixed-point increment */
-			xi += xf;
-			if( xi >= fp_set(1) )
-				{
-					src += fp_int(xi) * RGBA_BYTES;
-					xi = fp_frac(xi);
-				}
+	int i;
 
-			/* and adjust the target */
+	for( i=0; i < len; i++ )
+		{
+			rgb_pixel(src + xs[i] * RGBA_BYTES, tgt);
 			tgt += RGBA_BYTES;
 		}
 
@@ -156,12 +138,12 @@ void rgba_frame_be(frame *dest, frame *f, point *ofs)
 				swizzle_pixels(f);
 
 			/* set dest and filter pointers */
-			src = f->data + (cres.sx + f->w * cres.sy) * RGBA_BYTES;
+			src = f->data + (cres.sx + f->stride * cres.sy) * RGBA_BYTES;
 			tgt = dest->data + (cres.dx + dest->w * cres.dy) * RGBA_BYTES;
 			while( cres.dh-- )
 				{
 					rgba_line(cres.dw, src, tgt);
-					src += f->w * RGBA_BYTES;
+					src += f->stride * RGBA_BYTES;
 					tgt += dest->w * RGBA_BYTES;
 				}
 
@@ -178,7 +160,7 @@ void rgba_frame_be_scaled(frame *dest, frame *f, point *ofs, dimensions *span)
 
 	/* pointers into the rgb data, mask, and render surface */
 	unsigned char *src, *mask, *tgt;
-	point scan, inc;
+	int *xs, *ys, i;
 
 
 	/* failsafe */
@@ -192,28 +174,18 @@ void rgba_frame_be_scaled(frame *dest, frame *f, point *ofs, dimensions *span)
 			if( f->pixel.epoch < system_pixel.epoch )
 				swizzle_pixels(f);
 
-			/* set up scalar increments */
-			inc.x = fp_set(f->w) / span->w;
-			inc.y = fp_set(f->h) / span->h;
-			scan.x = fp_frac(cres.sx * inc.x);
-			scan.y = fp_frac(cres.sy * inc.y);
+			/* the source column and row each one drawn is taken from */
+			xs = span_table(f, SPAN_COLUMNS, span->w)->idx + cres.sx;
+			ys = span_table(f, SPAN_ROWS, span->h)->idx + cres.sy;
 
 			/* set source and target pointers */
-			src = f->data + (fp_int(cres.sx * inc.x) + fp_int(cres.sy * inc.y) * f->w) * RGBA_BYTES;
 			tgt = dest->data + (cres.dx + dest->w * cres.dy) * RGBA_BYTES;
 
 			/* draw the scaled rgb data */
-			while( cres.dh-- )
+			for( i=0; i < cres.dh; i++ )
 				{
-					rgba_line_scaled(cres.dw, scan.x, inc.x, src, tgt);
-
-					/* and adjust the y-increment */
-					scan.y += inc.y;
-					if( scan.y >= fp_set(1) )
-						{
-							src += fp_int(scan.y) * f->w * RGBA_BYTES;
-							scan.y = fp_frac(scan.y);
-						}
+					src = f->data + ys[i] * f->stride * RGBA_BYTES;
+					rgba_line_scaled(cres.dw, xs, src, tgt);
 
 					/* update the destination pointer */
 					tgt += dest->w * RGBA_BYTES;
@@ -237,21 +209,86 @@ static void rgba_line(int len, unsigned char *src, unsigned char *tgt)
 		}
 }
 
-static void rgba_line_scaled(int len, int xi, int xf, unsigned char *src, unsigned char *tgt)
+static void rgba_line_scaled(int len, const int *xs, unsigned char *src, unsigned char *tgt)
 {
-	while( len-- )
+	int i;
+
+	for( i=0; i < len; i++ )
 		{
-			rgba_pixel(src, tgt);
+			rgba_pixel(src + xs[i] * RGBA_BYTES, tgt);
+			tgt += RGBA_BYTES;
+		}
+
+}
+
+
+
+
+/*
+ * a scaled rgba frame, with each pixel blended from the four nearest
+ * in the frame, for sprites that are zoomed in a long way
+ */
+void rgba_frame_be_filtered(frame *dest, frame *f, point *ofs, dimensions *span)
+{
+	/* for frame clipping */
+	struct clip cres;
+
+	/* the source columns and rows, and pointers into the two rows and the render surface */
+	struct span_table *cols, *rows;
+	unsigned char *r0, *r1, *tgt;
+	int i, y;
 
-			/* adjust the source according to the fixed-point increment */
-			xi += xf;
-			if( xi >= fp_set(1) )
+
+	/* failsafe */
+	if( span->w < 1 || span->h < 1 )
+		return;
+
+	/* clip the frame, checking if frame is at least partially on-screen */
+	if( clip_to_frame( ofs, span->w, span->h, &dest->clip_rect, &cres ) )
+		{
+			/* update the frame pixel order if necessary */
+			if( f->pixel.epoch < system_pixel.epoch )
+				swizzle_pixels(f);
+
+			/* the pairs of source columns and rows each one drawn is blended from */
+			cols = span_table(f, SPAN_COLUMNS | SPAN_FILTERED, span->w);
+			rows = span_table(f, SPAN_ROWS | SPAN_FILTERED, span->h);
+
+			tgt = dest->data + (cres.dx + dest->w * cres.dy) * RGBA_BYTES;
+
+			/* draw the filtered rgba data */
+			for( i=0; i < cres.dh; i++ )
 				{
-					src += fp_int(xi) * RGBA_BYTES;
-					xi = fp_frac(xi);
+					y = cres.sy + i;
+					r0 = f->data + rows->idx[y] * f->stride * RGBA_BYTES;
+					r1 = f->data + rows->next[y] * f->stride * RGBA_BYTES;
+					rgba_line_filtered(cres.dw, cols, cres.sx, r0, r1, rows->wt[y], tgt);
+
+					/* update the destination pointer */
+					tgt += dest->w * RGBA_BYTES;
 				}
 
-			/* and adjust the target */
+			SIMD_ADJ;
+
+		}
+
+}
+
+
+static void rgba_line_filtered(int len, struct span_table *cols, int x, unsigned char *r0, unsigned char *r1, int wy, unsigned char *tgt)
+{
+	uint32_t px;
+	int c0, c1, wx;
+
+	for( ; len > 0; len--, x++ )
+		{
+			c0 = cols->idx[x] * RGBA_BYTES;
+			c1 = cols->next[x] * RGBA_BYTES;
+			wx = cols->wt[x];
+
+			/* blend the source pixel, and draw it like any other */
+			filter_pixel(r0 + c0, r0 + c1, r1 + c0, r1 + c1, wx, wy, (unsigned char *)&px);
+			rgba_pixel((unsigned char *)&px, tgt);
 			tgt += RGBA_BYTES;
 		}
 
@@ -293,12 +330,12 @@ void hl_frame_be(frame *dest, frame *f, point *ofs)
 
 			/* load pointers into pixel data */
 			src = dest->data + (cres.dx + dest->w * cres.dy) * RGBA_BYTES;
-			flt = f->data + (cres.sx + f->w * cres.sy) * RGBA_BYTES;
+			flt = f->data + (cres.sx + f->stride * cres.sy) * RGBA_BYTES;
 			while( cres.dh-- )
 				{
 					hl_line(cres.dw, src, flt);
 					src += dest->w * RGBA_BYTES;
-					flt += f->w * RGBA_BYTES;
+					flt += f->stride * RGBA_BYTES;
 				}
 
 			SIMD_ADJ;
@@ -314,7 +351,7 @@ void hl_frame_be_scaled(frame *dest, frame *f, point *ofs, dimensions *span)
 
 	/* pointers into the rgb data, mask, and render surface */
 	unsigned char *src, *flt;
-	point scan, inc;
+	int *xs, *ys, i;
 
 
 	/* failsafe */
@@ -328,27 +365,17 @@ void hl_frame_be_scaled(frame *dest, frame *f, point *ofs, dimensions *span)
 			if( f->pixel.epoch < system_pixel.epoch )
 				swizzle_pixels(f);
 
-			/* set up scalar increments */
-			inc.x = fp_set(f->w) / span->w;
-			inc.y = fp_set(f->h) / span->h;
-			scan.x = fp_frac(cres.sx * inc.x);
-			scan.y = fp_frac(cres.sy * inc.y);
+			/* the source column and row each one drawn is taken from */
+			xs = span_table(f, SPAN_COLUMNS, span->w)->idx + cres.sx;
+			ys = span_table(f, SPAN_ROWS, span->h)->idx + cres.sy;
 
 			/* set dest and filter pointers */
 			src = dest->data + (cres.dx + dest->w * cres.dy) * RGBA_BYTES;
-			flt = f->data + (fp_int(cres.sx * inc.x) + fp_int(cres.sy * inc.y) * f->w) * RGBA_BYTES;
 
-			while( cres.dh-- )
+			for( i=0; i < cres.dh; i++ )
 				{
-					hl_line_scaled(cres.dw, scan.x, inc.x, src, flt);
-
-					/* and adjust the y-increment */
-					scan.y += inc.y;
-					if( scan.y >= fp_set(1) )
-						{
-							flt += fp_int(scan.y) * f->w * RGBA_BYTES;
-							scan.y = fp_frac(scan.y);
-						}
+					flt = f->data + ys[i] * f->stride * RGBA_BYTES;
+					hl_line_scaled(cres.dw, xs, src, flt);
 
 					/* update the destination pointer */
 					src += dest->w * RGBA_BYTES;
@@ -372,21 +399,13 @@ static void hl_line(int len, unsigned char *src, unsigned char *flt)
 		}
 }
 
-static void hl_line_scaled(int len, int xi, int xf, unsigned char *src, unsigned char *flt)
+static void hl_line_scaled(int len, const int *xs, unsigned char *src, unsigned char *flt)
 {
-	while( len-- )
-		{
-			hl_pixel(src, flt);
-
-			/* adjust the filter according to the fixed-point increment */
-			xi += xf;
-			if( xi >= fp_set(1) )
-				{
-					flt += fp_int(xi) * RGBA_BYTES;
-					xi = fp_frac(xi);
-				}
+	int i;
 
-			/* and adjust the source */
+	for( i=0; i < len; i++ )
+		{
+			hl_pixel(src, flt + xs[i] * RGBA_BYTES);
 			src += RGBA_BYTES;
 		}
 
@@ -424,12 +443,12 @@ void sl_frame_be(frame *dest, frame *f, point *ofs)
 
 			/* load pointers into pixel data */
 			src = dest->data + (cres.dx + dest->w * cres.dy) * RGBA_BYTES;
-			flt = f->data + (cres.sx + f->w * cres.sy) * RGBA_BYTES;
+			flt = f->data + (cres.sx + f->stride * cres.sy) * RGBA_BYTES;
 			while( cres.dh-- )
 				{
 					sl_line(cres.dw, src, flt);
 					src += dest->w * RGBA_BYTES;
-					flt += f->w * RGBA_BYTES;
+					flt += f->stride * RGBA_BYTES;
 				}
 
 			SIMD_ADJ;
@@ -445,7 +464,7 @@ void sl_frame_be_scaled(frame *dest, frame *f, point *ofs, dimensions *span)
 
 	/* pointers into the rgb data, mask, and render surface */
 	unsigned char *src, *flt;
-	point scan, inc;
+	int *xs, *ys, i;
 
 
 	/* failsafe */
@@ -459,27 +478,17 @@ void sl_frame_be_scaled(frame *dest, frame *f, point *ofs, dimensions *span)
 			if( f->pixel.epoch < system_pixel.epoch )
 				swizzle_pixels(f);
 
-			/* set up scalar increments */
-			inc.x = fp_set(f->w) / span->w;
-			inc.y = fp_set(f->h) / span->h;
-			scan.x = fp_frac(cres.sx * inc.x);
-			scan.y = fp_frac(cres.sy * inc.y);
+			/* the source column and row each one drawn is taken from */
+			xs = span_table(f, SPAN_COLUMNS, span->w)->idx + cres.sx;
+			ys = span_table(f, SPAN_ROWS, span->h)->idx + cres.sy;
 
 			/* set dest and filter pointers */
 			src = dest->data + (cres.dx + dest->w * cres.dy) * RGBA_BYTES;
-			flt = f->data + (fp_int(cres.sx * inc.x) + fp_int(cres.sy * inc.y) * f->w) * RGBA_BYTES;
 
-			while( cres.dh-- )
+			for( i=0; i < cres.dh; i++ )
 				{
-					sl_line_scaled(cres.dw, scan.x, inc.x, src, flt);
-
-					/* and adjust the y-increment */
-					scan.y += inc.y;
-					if( scan.y >= fp_set(1) )
-						{
-							flt += fp_int(scan.y) * f->w * RGBA_BYTES;
-							scan.y = fp_frac(scan.y);
-						}
+					flt = f->data + ys[i] * f->stride * RGBA_BYTES;
+					sl_line_scaled(cres.dw, xs, src, flt);
 
 					/* update the destination pointer */
 					src += dest->w * RGBA_BYTES;
@@ -503,21 +512,13 @@ static void sl_line(int len, unsigned char *src, unsigned char *flt)
 		}
 }
 
-static void sl_line_scaled(int len, int xi, int xf, unsigned char *src, unsigned char *flt)
+static void sl_line_scaled(int len, const int *xs, unsigned char *src, unsigned char *flt)
 {
-	while( len-- )
-		{
-			sl_pixel(src, flt);
+	int i;
 
-			/* adjust the filter according to the fixed-point increment */
-			xi += xf;
-			if( xi >= fp_set(1) )
-				{
-					flt += fp_int(xi) * RGBA_BYTES;
-					xi = fp_frac(xi);
-				}
-
-			/* and adjust the source */
+	for( i=0; i < len; i++ )
+		{
+			sl_pixel(src, flt + xs[i] * RGBA_BYTES);
 			src += RGBA_BYTES;
 		}
 
@@ -560,12 +561,12 @@ void br_frame_be(frame *dest, frame *f, point *ofs)
 
 			/* load pointers into pixel data */
 			src = dest->data + (cres.dx + dest->w * cres.dy) * RGBA_BYTES;
-			flt = f->data + (cres.sx + f->w * cres.sy) * RGBA_BYTES;
+			flt = f->data + (cres.sx + f->stride * cres.sy) * RGBA_BYTES;
 			while( cres.dh-- )
 				{
 					br_line(cres.dw, src, flt);
 					src += dest->w * RGBA_BYTES;
-					flt += f->w * RGBA_BYTES;
+					flt += f->stride * RGBA_BYTES;
 				}
 
 			SIMD_ADJ;
@@ -581,7 +582,7 @@ void br_frame_be_scaled(frame *dest, frame *f, point *ofs, dimensions *span)
 
 	/* pointers into the rgb data, mask, and render surface */
 	unsigned char *src, *flt;
-	point scan, inc;
+	int *xs, *ys, i;
 
 
 	/* failsafe */
@@ -595,27 +596,17 @@ void br_frame_be_scaled(frame *dest, frame *f, point *ofs, dimensions *span)
 			if( f->pixel.epoch < system_pixel.epoch )
 				swizzle_pixels(f);
 
-			/* set up scalar increments */
-			inc.x = fp_set(f->w) / span->w;
-			inc.y = fp_set(f->h) / span->h;
-			scan.x = fp_frac(cres.sx * inc.x);
-			scan.y = fp_frac(cres.sy * inc.y);
+			/* the source column and row each one drawn is taken from */
+			xs = span_table(f, SPAN_COLUMNS, span->w)->idx + cres.sx;
+			ys = span_table(f, SPAN_ROWS, span->h)->idx + cres.sy;
 
 			/* set dest and filter pointers */
 			src = dest->data + (cres.dx + dest->w * cres.dy) * RGBA_BYTES;
-			flt = f->data + (fp_int(cres.sx * inc.x) + fp_int(cres.sy * inc.y) * f->w) * RGBA_BYTES;
 
-			while( cres.dh-- )
+			for( i=0; i < cres.dh; i++ )
 				{
-					br_line_scaled(cres.dw, scan.x, inc.x, src, flt);
-
-					/* and adjust the y-increment */
-					scan.y += inc.y;
-					if( scan.y >= fp_set(1) )
-						{
-							flt += fp_int(scan.y) * f->w * RGBA_BYTES;
-							scan.y = fp_frac(scan.y);
-						}
+					flt = f->data + ys[i] * f->stride * RGBA_BYTES;
+					br_line_scaled(cres.dw, xs, src, flt);
 
 					/* update the destination pointer */
 					src += dest->w * RGBA_BYTES;
@@ -639,21 +630,13 @@ static void br_line(int len, unsigned char *src, unsigned char *flt)
 		}
 }
 
-static void br_line_scaled(int len, int xi, int xf, unsigned char *src, unsigned char *flt)
+static void br_line_scaled(int len, const int *xs, unsigned char *src, unsigned char *flt)
 {
-	while( len-- )
-		{
-			br_pixel(src, flt);
+	int i;
 
-			/* adjust the filter according to the fixed-point increment */
-			xi += xf;
-			if( xi >= fp_set(1) )
-				{
-					flt += fp_int(xi) * RGBA_BYTES;
-					xi = fp_frac(xi);
-				}
-
-			/* and adjust the source */
+	for( i=0; i < len; i++ )
+		{
+			br_pixel(src, flt + xs[i] * RGBA_BYTES);
 			src += RGBA_BYTES;
 		}
 
@@ -694,13 +677,13 @@ void ct_frame_be(frame *dest, frame *f, point *ofs)
 		{
 			/* load pointers into pixel data */
 			src = dest->data + (cres.dx + dest->w * cres.dy) * RGBA_BYTES;
-			flt = f->data + cres.sx + f->w * cres.sy;
+			flt = f->data + cres.sx + f->stride * cres.sy;
 
 			while( cres.dh-- )
 				{
 					ct_line(cres.dw, src, flt);
 					src += dest->w * RGBA_BYTES;
-					flt += f->w;
+					flt += f->stride;
 				}
 
 			SIMD_ADJ;
@@ -716,7 +699,7 @@ void ct_frame_be_scaled(frame *dest, frame *f, point *ofs, dimensions *span)
 
 	/* pointers into the rgb data, mask, and render surface */
 	unsigned char *src, *flt;
-	point scan, inc;
+	int *xs, *ys, i;
 
 
 	/* failsafe */
@@ -726,27 +709,17 @@ void ct_frame_be_scaled(frame *dest, frame *f, point *ofs, dimensions *span)
 	/* clip the frame, checking if frame is at least partially on-screen */
 	if( clip_to_frame( ofs, span->w, span->h, &dest->clip_rect, &cres ) )
 		{
-			/* set up scalar increments */
-			inc.x = fp_set(f->w) / span->w;
-			inc.y = fp_set(f->h) / span->h;
-			scan.x = fp_frac(cres.sx * inc.x);
-			scan.y = fp_frac(cres.sy * inc.y);
+			/* the source column and row each one drawn is taken from */
+			xs = span_table(f, SPAN_COLUMNS, span->w)->idx + cres.sx;
+			ys = span_table(f, SPAN_ROWS, span->h)->idx + cres.sy;
 
 			/* set dest and filter pointers */
 			src = dest->data + (cres.dx + dest->w * cres.dy) * RGBA_BYTES;
-			flt = f->data + (fp_int(cres.sx * inc.x) + fp_int(cres.sy * inc.y) * f->w);
 
-			while( cres.dh-- )
+			for( i=0; i < cres.dh; i++ )
 				{
-					ct_line_scaled(cres.dw, scan.x, inc.x, src, flt);
-
-					/* and adjust the y-increment */
-					scan.y += inc.y;
-					if( scan.y >= fp_set(1) )
-						{
-							flt += fp_int(scan.y) * f->w * RGBA_BYTES;
-							scan.y = fp_frac(scan.y);
-						}
+					flt = f->data + ys[i] * f->stride;
+					ct_line_scaled(cres.dw, xs, src, flt);
 
 					/* update the destination pointer */
 					src += dest->w * RGBA_BYTES;
@@ -770,21 +743,13 @@ static void ct_line(int len, unsigned char *src, unsigned char *flt)
 		}
 }
 
-static void ct_line_scaled(int len, int xi, int xf, unsigned char *src, unsigned char *flt)
+static void ct_line_scaled(int len, const int *xs, unsigned char *src, unsigned char *flt)
 {
-	while( len-- )
-		{
-			ct_pixel(src, flt);
+	int i;
 
-			/* adjust the filter according to the fixed-point increment */
-			xi += xf;
-			if( xi >= fp_set(1) )
-				{
-					flt += fp_int(xi);
-					xi = fp_frac(xi);
-				}
-
-			/* and adjust the source */
+	for( i=0; i < len; i++ )
+		{
+			ct_pixel(src, flt + xs[i]);
 			src += RGBA_BYTES;
 		}
 
@@ -826,12 +791,12 @@ void sat_frame_be(frame *dest, frame *f, point *ofs)
 		{
 			/* load pointers into pixel data */
 			src = dest->data + (cres.dx + dest->w * cres.dy) * RGBA_BYTES;
-			flt = f->data + cres.sx + f->w * cres.sy;
+			flt = f->data + cres.sx + f->stride * cres.sy;
 			while( cres.dh-- )
 				{
 					sat_line(cres.dw, src, flt);
 					src += dest->w * RGBA_BYTES;
-					flt += f->w;
+					flt += f->stride;
 				}
 
 			SIMD_ADJ;
@@ -847,7 +812,7 @@ void sat_frame_be_scaled(frame *dest, frame *f, point *ofs, dimensions *span)
 
 	/* pointers into the rgb data, mask, and render surface */
 	unsigned char *src, *flt;
-	point scan, inc;
+	int *xs, *ys, i;
 
 
 	/* failsafe */
@@ -857,27 +822,17 @@ void sat_frame_be_scaled(frame *dest, frame *f, point *ofs, dimensions *span)
 	/* clip the frame, checking if frame is at least partially on-screen */
 	if( clip_to_frame( ofs, span->w, span->h, &dest->clip_rect, &cres ) )
 		{
-			/* set up scalar increments */
-			inc.x = fp_set(f->w) / span->w;
-			inc.y = fp_set(f->h) / span->h;
-			scan.x = fp_frac(cres.sx * inc.x);
-			scan.y = fp_frac(cres.sy * inc.y);
+			/* the source column and row each one drawn is taken from */
+			xs = span_table(f, SPAN_COLUMNS, span->w)->idx + cres.sx;
+			ys = span_table(f, SPAN_ROWS, span->h)->idx + cres.sy;
 
 			/* set dest and filter pointers */
 			src = dest->data + (cres.dx + dest->w * cres.dy) * RGBA_BYTES;
-			flt = f->data + (fp_int(cres.sx * inc.x) + fp_int(cres.sy * inc.y) * f->w);
 
-			while( cres.dh-- )
+			for( i=0; i < cres.dh; i++ )
 				{
-					sat_line_scaled(cres.dw, scan.x, inc.x, src, flt);
-
-					/* and adjust the y-increment */
-					scan.y += inc.y;
-					if( scan.y >= fp_set(1) )
-						{
-							flt += fp_int(scan.y) * f->w * RGBA_BYTES;
-							scan.y = fp_frac(scan.y);
-						}
+					flt = f->data + ys[i] * f->stride;
+					sat_line_scaled(cres.dw, xs, src, flt);
 
 					/* update the destination pointer */
 					src += dest->w * RGBA_BYTES;
@@ -901,21 +856,13 @@ static void sat_line(int len, unsigned char *src, unsigned char *flt)
 		}
 }
 
-static void sat_line_scaled(int len, int xi, int xf, unsigned char *src, unsigned char *flt)
+static void sat_line_scaled(int len, const int *xs, unsigned char *src, unsigned char *flt)
 {
-	while( len-- )
-		{
-			sat_pixel(src, flt);
+	int i;
 
-			/* adjust the filter according to the fixed-point increment */
-			xi += xf;
-			if( xi >= fp_set(1) )
-				{
-					flt += fp_int(xi);
-					xi = fp_frac(xi);
-				}
-
-			/* and adjust the source */
+	for( i=0; i < len; i++ )
+		{
+			sat_pixel(src, flt + xs[i]);
 			src += RGBA_BYTES;
 		}
 
@@ -936,85 +883,26 @@ static void sat_line_scaled(int len, int xi, int xf, unsigned char *src, unsigne
 
 /*
  * displacement - each pixel in the frame is obtained from the
- * pixel's x,y + the offset x,y
+ * pixel's x,y + the offset x,y.  the work is the same for either
+ * pixel order, and is done in displace.c.
  */
 void displ_frame_be(frame *dest, frame *f, point *ofs)
 {
-	int i, j;
-
 	/* for frame clipping */
 	struct clip cres;
 
-	/* pointers into the source and target render frames, and into the displacement data */
-	unsigned char *src, *tgt;
-	short *dis;
-
 
 	/* set the clip on the displacement-frame.  note that if it fails, frame is not visible! */
 	if( clip_to_frame( ofs, f->w, f->h, &dest->clip_rect, &cres ) )
-		{
-			/* check the scratchpad buffer */
-			adjust_scratchpad(f->w, f->h);
-
-			/* set surface pointers */
-			dis = (short *)f->data + (cres.sx + f->w * cres.sy) * DISPL_SPAN;
-			src = dest->data + (cres.dx + dest->w * cres.dy) * RGBA_BYTES;
-			tgt = scratchpad;
-
-			/* render the repositioned pixels onto the scratchpad frame */
-			for( i=0; i < cres.dh; i++ )
-				{
-					for( j=0; j < cres.dw; j++ )
-						{
-							/* only if the source pixel is within the render frame boundaries, copy */
-							if( (cres.dx + *dis) < 0 || (cres.dx + *dis) >= dest->w || (cres.dy + *(dis+1)) < 0 || (cres.dy + *(dis+1)) >= dest->h )
-								*(int32_t *)tgt = *(int32_t *)src;
-							else
-								*(int32_t *)tgt = *(int32_t *)(src + (*dis + dest->w * *(dis+1)) * RGBA_BYTES);
-
-							cres.dx++;
-							dis += DISPL_SPAN;
-							src += RGBA_BYTES;
-							tgt += RGBA_BYTES;
-
-						}
-
-					dis += (f->w - cres.dw) * DISPL_SPAN;
-					src += (dest->w - cres.dw) * RGBA_BYTES;
-					cres.dx -= cres.dw;
-					cres.dy++;
-
-				}
-
-			cres.dy -= cres.dh;
-
-			/* copy the scratchpad back onto the canvas */
-			src = scratchpad;
-			tgt = dest->data + (cres.dx + dest->w * cres.dy) * RGBA_BYTES;
-
-			for( i=0; i < cres.dh; i++ )
-				{
-					memcpy( tgt, src, cres.dw * RGBA_BYTES );
-					src += cres.dw * RGBA_BYTES;
-					tgt += dest->w * RGBA_BYTES;
-				}
-
-		}
+		displace(dest, f, &cres);
 
 }
 
 void displ_frame_be_scaled(frame *dest, frame *f, point *ofs, dimensions *span)
 {
-	int i, j;
-
 	/* for frame clipping */
 	struct clip cres;
 
-	/* pointers into the source and target render frames, and into the displacement data */
-	unsigned char *src, *tgt;
-	point scan, inc;
-	short *dis, *dis_rewind;
-
 
 	/* failsafe */
 	if( span->w < 1 || span->h < 1 )
@@ -1022,80 +910,7 @@ void displ_frame_be_scaled(frame *dest, frame *f, point *ofs, dimensions *span)
 
 	/* set the clip on the displacement-frame.  note that if it fails, frame is not visible! */
 	if( clip_to_frame( ofs, span->w, span->h, &dest->clip_rect, &cres ) )
-		{
-			/* check the scratchpad buffer */
-			adjust_scratchpad(cres.dw, cres.dh);
-
-			/* set up scalar increments */
-			inc.x = fp_set(f->w) / span->w;
-			inc.y = fp_set(f->h) / span->h;
-			scan.x = fp_frac(cres.sx * inc.x);
-			scan.y = fp_frac(cres.sy * inc.y);
-
-
-			/* set surface pointers */
-			dis = (short *)f->data + (fp_int(cres.sx * inc.x) + fp_int(cres.sy * inc.y) * f->w) * DISPL_SPAN;
-			src = dest->data + (cres.dx + dest->w * cres.dy) * RGBA_BYTES;
-			tgt = scratchpad;
-
-
-			/* render the repositioned pixels onto the scratchpad frame */
-			for( i=0; i < cres.dh; i++ )
-				{
-					for( j=0, dis_rewind = dis; j < cres.dw; j++ )
-						{
-							/* only if the source pixel is within the render frame boundaries, copy */
-							if( (cres.dx + *dis) < 0 || (cres.dx + *dis) >= dest->w || (cres.dy + *(dis+1)) < 0 || (cres.dy + *(dis+1)) >= dest->h )
-								*(int32_t *)tgt = *(int32_t *)src;
-							else
-								*(int32_t *)tgt = *(int32_t *)(src + (*dis + dest->w * *(dis+1)) * RGBA_BYTES);
-
-							cres.dx++;
-							src += RGBA_BYTES;
-							tgt += RGBA_BYTES;
-
-							/* adjust the filter according to the fixed-point increment */
-							scan.x += inc.x;
-							if( scan.x >= fp_set(1) )
-								{
-									dis += fp_int(scan.x) * DISPL_SPAN;
-									scan.x = fp_frac(scan.x);
-								}
-
-						}
-
-					/* rewind the pointers */
-					dis = dis_rewind;
-					src += (dest->w - cres.dw) * RGBA_BYTES;
-					cres.dx -= cres.dw;
-					cres.dy++;
-					scan.x = fp_frac(cres.sx * inc.x);
-
-					/* and adjust the y-increment */
-					scan.y += inc.y;
-					if( scan.y >= fp_set(1) )
-						{
-							dis += fp_int(scan.y) * f->w * DISPL_SPAN;
-							scan.y = fp_frac(scan.y);
-						}
-
-
-				}
-
-			cres.dy -= cres.dh;
-
-			/* copy the scratchpad back onto the canvas */
-			src = scratchpad;
-			tgt = dest->data + (cres.dx + dest->w * cres.dy) * RGBA_BYTES;
-
-			for( i=0; i < cres.dh; i++ )
-				{
-					memcpy( tgt, src, cres.dw * RGBA_BYTES );
-					src += cres.dw * RGBA_BYTES;
-					tgt += dest->w * RGBA_BYTES;
-				}
-
-		}
+		displace_scaled(dest, f, &cres, span);
 
 }
 
@@ -1114,7 +929,8 @@ void displ_frame_be_scaled(frame *dest, frame *f, point *ofs, dimensions *span)
 
 /*
  * generic convolution kernel - each non-zero pixel in the bit mask
- * runs the convolution on the underlying image data
+ * runs the convolution on the underlying image data.  the work is
+ * the same for either pixel order, and is done in convolve.c.
  */
 void convo_frame_be(frame *dest, frame *f, point *ofs)
 {
@@ -1122,15 +938,9 @@ void convo_frame_be(frame *dest, frame *f, point *ofs)
 	point adjusted_ofs;
 	struct clip cres;
 
-	int i, j, k, l;  /* counters for the render action */
-	int ac[4];       /* accumulators for pixel-calculations */
 	box kofs;          /* offsets from pixel to edge of kernel */
-	int idx;           /* index to the active kernel value */
-	unsigned char *src, *mask, *tgt;  /* pointers into the source and target render frames */
 	convolution *convo;
 
-	struct libdivide_s32_t fast_divisor;  /* the libdivide divisor struct */
-
 
 	/* let's begin */
 	convo = f->aux;
@@ -1138,9 +948,11 @@ void convo_frame_be(frame *dest, frame *f, point *ofs)
 	/*
 	 * set the clip on the convolve bitmask.  note that it is offset by the adjusted
 	 * size of the kernel to ensure enough pixel data and is different for even or
-	 * odd kernel dimensions
+	 * odd kernel dimensions.  blurs stay inside the frame.
 	 */
-	if( convo->kw & 1 )
+	if( convo->mode != CONVO_KERNEL )
+		kofs.x1 = kofs.x2 = 0;
+	else if( convo->kw & 1 )
 		kofs.x1 = kofs.x2 = (convo->kw-1) / 2;
 	else
 		{
@@ -1148,7 +960,9 @@ void convo_frame_be(frame *dest, frame *f, point *ofs)
 			kofs.x2 = convo->kw / 2;
 		}
 
-	if( convo->kh & 1 )
+	if( convo->mode != CONVO_KERNEL )
+		kofs.y1 = kofs.y2 = 0;
+	else if( convo->kh & 1 )
 		kofs.y1 = kofs.y2 = (convo->kh-1) / 2;
 	else
 		{
@@ -1164,101 +978,14 @@ void convo_frame_be(frame *dest, frame *f, point *ofs)
 
 	if( clip_to_frame( &adjusted_ofs, f->w + kofs.x1 + kofs.x2, f->h + kofs.y1 + kofs.y2, &dest->clip_rect, &cres ) )
 		{
-
 			/* check to see if the clipped frame can provide enough data for the kernel */
-			if( cres.dw < convo->kw || cres.dh < convo->kh )
+			if( convo->mode == CONVO_KERNEL && (cres.dw < convo->kw || cres.dh < convo->kh) )
 				return;
 
-			/* check the scratchpad buffer */
-			adjust_scratchpad(f->w, f->h);
-
-
-			/* set surface pointers */
-			src = dest->data + (cres.dx + dest->w * cres.dy) * RGBA_BYTES;
-			mask = f->data + cres.sx + f->w * cres.sy;
-			tgt = scratchpad;
-
-			/* calculate the pregenerated divisor for libdivide */
-			fast_divisor = libdivide_s32_gen(convo->divisor);
-
-			/* render the convolved pixels onto the scratchpad frame */
-			for( i=0; i < cres.dh - convo->kh + 1; i++ )
-				{
-					for( j=0; j < cres.dw - convo->kw + 1; j++ )
-						{
-
-							/* if the pixel-mask is set for this pixel, operate */
-							if( *mask )
-								{
-									/* zero the integer accumulators */
-									memset(ac, 0, sizeof(int) * 4);
-
-									/* loop for each pixel in the kernel - height */
-									for( k=0, idx=0; k < convo->kh; k++ )
-										{
-											/* loop for each pixel in the kernel - width */
-											for( l=0; l < convo->kw; l++ )
-												{
-													/* for each pixel component in the source, multiply by the current kernel value */
-													ac[0] += *src     * convo->kernel[idx];
-													ac[1] += *(src+1) * convo->kernel[idx];
-													ac[2] += *(src+2) * convo->kernel[idx];
-													ac[3] += *(src+3) * convo->kernel[idx];
-													src += RGBA_BYTES;
-													idx++;
-												}
-
-											/* back and down a line */
-											src += (dest->w - convo->kw) * RGBA_BYTES;
-
-										}
-
-									/* apply the divisor and offset */
-									ac[0] = libdivide_s32_do(ac[0], &fast_divisor) + convo->offset;
-									ac[1] = libdivide_s32_do(ac[1], &fast_divisor) + convo->offset;
-									ac[2] = libdivide_s32_do(ac[2], &fast_divisor) + convo->offset;
-									ac[3] = libdivide_s32_do(ac[3], &fast_divisor) + convo->offset;
-
-									/* set the result pixel, pinned to 0..255 range */
-									*tgt     = ac[0] < 0 ? 0 : (ac[0] > RGB_MAX) ? RGB_MAX : ac[0];
-									*(tgt+1) = ac[1] < 0 ? 0 : (ac[1] > RGB_MAX) ? RGB_MAX : ac[1];
-									*(tgt+2) = ac[2] < 0 ? 0 : (ac[2] > RGB_MAX) ? RGB_MAX : ac[2];
-									*(tgt+3) = ac[3] < 0 ? 0 : (ac[3] > RGB_MAX) ? RGB_MAX : ac[3];
-									tgt += RGBA_BYTES;
-
-									/* adjust back up several lines, minus one pixel */
-									src -= (dest->w * convo->kh - 1) * RGBA_BYTES;
-
-								}
-							else
-								{
-									/* pixel mask is blank, copy the pixel */
-									*(int32_t *)tgt = *(int32_t *)(src + (1 + dest->w) * RGBA_BYTES);
-									src += RGBA_BYTES;
-									tgt += RGBA_BYTES;
-								}
-
-							mask++;
-
-						}
-
-					src += (dest->w - (cres.dw - convo->kw + 1)) * RGBA_BYTES;
-					mask += f->w - (cres.dw - convo->kw + 1);
-
-				}
-
-
-			/* copy the scratchpad back onto the canvas */
-			src = scratchpad;
-			tgt = dest->data + (cres.dx + kofs.x1 + dest->w * (cres.dy + kofs.y1)) * RGBA_BYTES;
-
-			for( i=0; i < cres.dh - convo->kh + 1; i++ )
-				{
-					memcpy( tgt, src, (cres.dw - convo->kw + 1) * RGBA_BYTES );
-					src += (cres.dw - convo->kw + 1) * RGBA_BYTES;
-					tgt += dest->w * RGBA_BYTES;
-				}
+			if( cres.dw < 1 || cres.dh < 1 )
+				return;
 
+			convolve(dest, f, &cres, &kofs);
 		}
 
 }
@@ -1288,6 +1015,10 @@ void convo_frame_be_scaled(frame *dest, frame *f, point *ofs, dimensions *span)
 	/* let's begin */
 	convo = f->aux;
 
+	/* blurs are only drawn unscaled */
+	if( convo->mode != CONVO_KERNEL )
+		return;
+
 	/*
 	 * set the clip on the convolve bitmask.  note that it is offset by the adjusted
 	 * size of the kernel to ensure enough pixel data and is different for even or
@@ -1334,7 +1065,7 @@ void convo_frame_be_scaled(frame *dest, frame *f, point *ofs, dimensions *span)
 
 			/* set surface pointers */
 			src = dest->data + (cres.dx + dest->w * cres.dy) * RGBA_BYTES;
-			mask = f->data + (fp_int(cres.sx * inc.x) + fp_int(cres.sy * inc.y) * f->w);
+			mask = f->data + (fp_int(cres.sx * inc.x) + fp_int(cres.sy * inc.y) * f->stride);
 			tgt = scratchpad;
 
 			/* calculate the pregenerated divisor for libdivide */
@@ -1421,7 +1152,7 @@ void convo_frame_be_scaled(frame *dest, frame *f, point *ofs, dimensions *span)
 					scan.y += inc.y;
 					if( scan.y >= fp_set(1) )
 						{
-							mask += fp_int(scan.y) * f->w;
+							mask += fp_int(scan.y) * f->stride;
 							scan.y = fp_frac(scan.y);
 						}
 
@@ -1473,12 +1204,12 @@ void lut_frame_be(frame *dest, frame *f, point *ofs)
 		{
 			/* load pointers into pixel data */
 			src = dest->data + (cres.dx + dest->w * cres.dy) * RGBA_BYTES;
-			flt = f->data + cres.sx + f->w * cres.sy;
+			flt = f->data + cres.sx + f->stride * cres.sy;
 			while( cres.dh-- )
 				{
 					lut_line(cres.dw, src, f->aux, flt);
 					src += dest->w * RGBA_BYTES;
-					flt += f->w;
+					flt += f->stride;
 				}
 
 		}
@@ -1492,7 +1223,7 @@ void lut_frame_be_scaled(frame *dest, frame *f, point *ofs, dimensions *span)
 
 	/* pointers into the rgb data, mask, and render surface */
 	unsigned char *src, *flt;
-	point scan, inc;
+	int *xs, *ys, i;
 
 
 	/* failsafe */
@@ -1502,27 +1233,17 @@ void lut_frame_be_scaled(frame *dest, frame *f, point *ofs, dimensions *span)
 	/* clip the frame, checking if frame is at least partially on-screen */
 	if( clip_to_frame( ofs, span->w, span->h, &dest->clip_rect, &cres ) )
 		{
-			/* set up scalar increments */
-			inc.x = fp_set(f->w) / span->w;
-			inc.y = fp_set(f->h) / span->h;
-			scan.x = fp_frac(cres.sx * inc.x);
-			scan.y = fp_frac(cres.sy * inc.y);
+			/* the source column and row each one drawn is taken from */
+			xs = span_table(f, SPAN_COLUMNS, span->w)->idx + cres.sx;
+			ys = span_table(f, SPAN_ROWS, span->h)->idx + cres.sy;
 
 			/* set dest and filter pointers */
 			src = dest->data + (cres.dx + dest->w * cres.dy) * RGBA_BYTES;
-			flt = f->data + (fp_int(cres.sx * inc.x) + fp_int(cres.sy * inc.y) * f->w);
 
-			while( cres.dh-- )
+			for( i=0; i < cres.dh; i++ )
 				{
-					lut_line_scaled(cres.dw, scan.x, inc.x, src, f->aux, flt);
-
-					/* and adjust the y-increment */
-					scan.y += inc.y;
-					if( scan.y >= fp_set(1) )
-						{
-							flt += fp_int(scan.y) * f->w * RGBA_BYTES;
-							scan.y = fp_frac(scan.y);
-						}
+					flt = f->data + ys[i] * f->stride;
+					lut_line_scaled(cres.dw, xs, src, f->aux, flt);
 
 					/* update the destination pointer */
 					src += dest->w * RGBA_BYTES;
@@ -1546,21 +1267,13 @@ static void lut_line(int len, unsigned char *src, lut *l, unsigned char *flt)
 		}
 }
 
-static void lut_line_scaled(int len, int xi, int xf, unsigned char *src, lut *l, unsigned char *flt)
+static void lut_line_scaled(int len, const int *xs, unsigned char *src, lut *l, unsigned char *flt)
 {
-	while( len-- )
-		{
-			lut_pixel(src, l, flt);
+	int i;
 
-			/* adjust the filter according to the fixed-point increment */
-			xi += xf;
-			if( xi >= fp_set(1) )
-				{
-					flt += fp_int(xi);
-					xi = fp_frac(xi);
-				}
-
-			/* and adjust the source */
+	for( i=0; i < len; i++ )
+		{
+			lut_pixel(src, l, flt + xs[i]);
 			src += RGBA_BYTES;
 		}
 
@@ -1592,12 +1305,12 @@ void xor_frame_be(frame *dest, frame *f, point *ofs)
 
 			/* set dest and filter pointers */
 			src = dest->data + (cres.dx + dest->w * cres.dy) * RGBA_BYTES;
-			flt = f->data + (cres.sx + f->w * cres.sy) * RGBA_BYTES;
+			flt = f->data + (cres.sx + f->stride * cres.sy) * RGBA_BYTES;
 			while( cres.dh-- )
 				{
 					xor_line(cres.dw, src, flt);
 					src += dest->w * RGBA_BYTES;
-					flt += f->w * RGBA_BYTES;
+					flt += f->stride * RGBA_BYTES;
 				}
 
 			SIMD_ADJ;
@@ -1613,7 +1326,7 @@ void xor_frame_be_scaled(frame *dest, frame *f, point *ofs, dimensions *span)
 
 	/* pointers into the rgb data, mask, and render surface */
 	unsigned char *src, *mask, *flt;
-	point scan, inc;
+	int *xs, *ys, i;
 
 
 	/* failsafe */
@@ -1627,28 +1340,18 @@ void xor_frame_be_scaled(frame *dest, frame *f, point *ofs, dimensions *span)
 			if( f->pixel.epoch < system_pixel.epoch )
 				swizzle_pixels(f);
 
-			/* set up scalar increments */
-			inc.x = fp_set(f->w) / span->w;
-			inc.y = fp_set(f->h) / span->h;
-			scan.x = fp_frac(cres.sx * inc.x);
-			scan.y = fp_frac(cres.sy * inc.y);
+			/* the source column and row each one drawn is taken from */
+			xs = span_table(f, SPAN_COLUMNS, span->w)->idx + cres.sx;
+			ys = span_table(f, SPAN_ROWS, span->h)->idx + cres.sy;
 
 			/* set source and target pointers */
 			src = dest->data + (cres.dx + dest->w * cres.dy) * RGBA_BYTES;
-			flt = f->data + (fp_int(cres.sx * inc.x) + fp_int(cres.sy * inc.y) * f->w) * RGBA_BYTES;
 
 			/* draw the scaled xor data */
-			while( cres.dh-- )
+			for( i=0; i < cres.dh; i++ )
 				{
-					xor_line_scaled(cres.dw, scan.x, inc.x, src, flt);
-
-					/* and adjust the y-increment */
-					scan.y += inc.y;
-					if( scan.y >= fp_set(1) )
-						{
-							flt += fp_int(scan.y) * f->w * RGBA_BYTES;
-							scan.y = fp_frac(scan.y);
-						}
+					flt = f->data + ys[i] * f->stride * RGBA_BYTES;
+					xor_line_scaled(cres.dw, xs, src, flt);
 
 					/* update the destination pointer */
 					src += dest->w * RGBA_BYTES;
@@ -1672,21 +1375,13 @@ static void xor_line(int len, unsigned char *src, unsigned char *flt)
 		}
 }
 
-static void xor_line_scaled(int len, int xi, int xf, unsigned char *src, unsigned char *flt)
+static void xor_line_scaled(int len, const int *xs, unsigned char *src, unsigned char *flt)
 {
-	while( len-- )
-		{
-			xor_pixel(src, flt);
-
-			/* adjust the source according to the fixed-point increment */
-			xi += xf;
-			if( xi >= fp_set(1) )
-				{
-					flt += fp_int(xi) * RGBA_BYTES;
-					xi = fp_frac(xi);
-				}
+	int i;
 
-			/* and adjust the target */
+	for( i=0; i < len; i++ )
+		{
+			xor_pixel(src, flt + xs[i] * RGBA_BYTES);
 			src += RGBA_BYTES;
 		}
 
@@ -1749,6 +1444,8 @@ static int clip_to_frame(point *src, int w, int h, box *dest, struct clip *res)
 	if( (src->y + h) > dest->y2 )
 		res->dh -= (src->y + h) - dest->y2;
 
+	STATS_COUNT(STATS_PIXELS, res->dw * res->dh);
+
 
 	/* return 1 if there is something to be drawn */
 	return 1;
@@ -273,6 +273,41 @@
 	while(0)
 
 
+/*
+ * blend four neighbouring pixels into one, for filtered scaling:  each
+ * pair across by wx, and then the two results down by wy, both out of
+ * 256, and rounded.  no sum can overflow 16 bits.
+ */
+#define filter_pixel(p00, p01, p10, p11, wx, wy, out) \
+	do \
+		{ \
+			__m64 ax, bx, w0x, w1x, topx, botx; \
+			\
+			w1x = _mm_set1_pi16(wx); \
+			w0x = _mm_sub_pi16(_mm_set1_pi16(256), w1x); \
+			\
+			/* blend across the top pair, and then the bottom */ \
+			ax = _mm_unpacklo_pi8(_mm_cvtsi32_si64(*(int32_t *)(p00)), _mm_setzero_si64()); \
+			bx = _mm_unpacklo_pi8(_mm_cvtsi32_si64(*(int32_t *)(p01)), _mm_setzero_si64()); \
+			topx = _mm_add_pi16(_mm_mullo_pi16(ax, w0x), _mm_mullo_pi16(bx, w1x)); \
+			topx = _mm_srli_pi16(_mm_add_pi16(topx, _mm_set1_pi16(128)), 8); \
+			\
+			ax = _mm_unpacklo_pi8(_mm_cvtsi32_si64(*(int32_t *)(p10)), _mm_setzero_si64()); \
+			bx = _mm_unpacklo_pi8(_mm_cvtsi32_si64(*(int32_t *)(p11)), _mm_setzero_si64()); \
+			botx = _mm_add_pi16(_mm_mullo_pi16(ax, w0x), _mm_mullo_pi16(bx, w1x)); \
+			botx = _mm_srli_pi16(_mm_add_pi16(botx, _mm_set1_pi16(128)), 8); \
+			\
+			/* and down between the two */ \
+			w1x = _mm_set1_pi16(wy); \
+			w0x = _mm_sub_pi16(_mm_set1_pi16(256), w1x); \
+			ax = _mm_add_pi16(_mm_mullo_pi16(topx, w0x), _mm_mullo_pi16(botx, w1x)); \
+			ax = _mm_srli_pi16(_mm_add_pi16(ax, _mm_set1_pi16(128)), 8); \
+			\
+			*(int32_t *)(out) = _mm_cvtsi64_si32(_mm_packs_pu16(ax, _mm_setzero_si64())); \
+		} \
+	while(0)
+
+
 #else
 
 
@@ -339,4 +374,18 @@
 	while(0)
 
 
+#define filter_pixel(p00, p01, p10, p11, wx, wy, out) \
+	do \
+		{ \
+			int c, top, bot; \
+			for( c=0; c < RGBA_BYTES; c++ ) \
+				{ \
+					top = (*((p00)+c) * (256 - (wx)) + *((p01)+c) * (wx) + 128) >> 8; \
+					bot = (*((p10)+c) * (256 - (wx)) + *((p11)+c) * (wx) + 128) >> 8; \
+					*((out)+c) = (top * (256 - (wy)) + bot * (wy) + 128) >> 8; \
+				} \
+		} \
+	while(0)
+
+
 #endif
@@ -41,21 +41,37 @@ void convo_frame_le_scaled(frame *, frame *, point *, dimensions *);
 void lut_frame_le_scaled(frame *, frame *, point *, dimensions *);
 void xor_frame_le_scaled(frame *, frame *, point *, dimensions *);
 
-static void rgb_line_scaled(int, int, int, unsigned char *, unsigned char *);
-static void rgba_line_scaled(int, int, int, unsigned char *, unsigned char *);
-static void hl_line_scaled(int, int, int, unsigned char *, unsigned char *);
-static void sl_line_scaled(int, int, int, unsigned char *, unsigned char *);
-static void br_line_scaled(int, int, int, unsigned char *, unsigned char *);
-static void ct_line_scaled(int, int, int, unsigned char *, unsigned char *);
-static void sat_line_scaled(int, int, int, unsigned char *, unsigned char *);
-static void lut_line_scaled(int, int, int, unsigned char *, lut *, unsigned char *);
-static void xor_line_scaled(int, int, int, unsigned char *, unsigned char *);
+void rgba_frame_le_filtered(frame *, frame *, point *, dimensions *);
+
+static void rgb_line_scaled(int, const int *, unsigned char *, unsigned char *);
+static void rgba_line_scaled(int, const int *, unsigned char *, unsigned char *);
+static void hl_line_scaled(int, const int *, unsigned char *, unsigned char *);
+static void sl_line_scaled(int, const int *, unsigned char *, unsigned char *);
+static void br_line_scaled(int, const int *, unsigned char *, unsigned char *);
+static void ct_line_scaled(int, const int *, unsigned char *, unsigned char *);
+static void sat_line_scaled(int, const int *, unsigned char *, unsigned char *);
+static void lut_line_scaled(int, const int *, unsigned char *, lut *, unsigned char *);
+static void xor_line_scaled(int, const int *, unsigned char *, unsigned char *);
+
+static void rgba_line_filtered(int, struct span_table *, int, unsigned char *, unsigned char *, int, unsigned char *);
 
 static int clip_to_frame(point *, int, int, box *, struct clip *);
 
+/* from convolve.c */
+extern void convolve(frame *, frame *, struct clip *, box *);
+
+/* from displace.c */
+extern void displace(frame *, frame *, struct clip *);
+extern void displace_scaled(frame *, frame *, struct clip *, dimensions *);
+
 /* from pixel.c */
 extern pixel_fmt system_pixel;
 extern unsigned char *scratchpad;
 
 extern void adjust_scratchpad(int, int);
 extern void swizzle_pixels(frame *);
+extern struct span_table *span_table(frame *, int, int);
+
+/* from stats.c */
+extern int stats_active;
+extern int stats_count[];
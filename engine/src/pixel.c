@@ -1,9 +1,14 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "SDL.h"
 #include "common.h"
 #include "pixel.h"
 
+#ifdef WITH_SIMD
+#include <mmintrin.h>
+#endif
+
 
 
 
@@ -18,6 +23,9 @@ renderer system_frame;
 unsigned char *scratchpad = NULL;
 dimensions scratchpad_size = { 0, 0 };
 
+/* counts the scaling tables asked for, to find the least recently used */
+static unsigned int span_clock;
+
 
 
 
@@ -61,6 +69,8 @@ void set_pixel_order(int r, int g, int b)
 			system_frame.convo_scaled = convo_frame_be_scaled;
 			system_frame.lut_scaled = lut_frame_be_scaled;
 			system_frame.xor_scaled = xor_frame_be_scaled;
+
+			system_frame.rgba_filtered = rgba_frame_be_filtered;
 		}
 	else
 		{
@@ -87,6 +97,8 @@ void set_pixel_order(int r, int g, int b)
 			system_frame.convo_scaled = convo_frame_le_scaled;
 			system_frame.lut_scaled = lut_frame_le_scaled;
 			system_frame.xor_scaled = xor_frame_le_scaled;
+
+			system_frame.rgba_filtered = rgba_frame_le_filtered;
 		}
 
 	/* and make sure that future pixel operations adjust to this order */
@@ -102,10 +114,35 @@ void set_pixel_order(int r, int g, int b)
 
 
 /*
- * convert an rgb buffer to rgba, setting the alpha component to max
+ * convert an rgb buffer to rgba, setting the alpha component to max.
+ * four pixels at a time are three words read and four written, and
+ * any left over are done a byte at a time.
  */
 void unpack_rgb(int len, const unsigned char *src, unsigned char *dest)
 {
+	uint32_t in[3], out[4];
+
+	for( ; len >= 4; len -= 4 )
+		{
+			memcpy(in, src, sizeof(in));
+
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+			out[0] = (in[0] & 0xffffff00) | 0xff;
+			out[1] = (in[0] << 24) | ((in[1] >> 8) & 0xffff00) | 0xff;
+			out[2] = (in[1] << 16) | ((in[2] >> 16) & 0xff00) | 0xff;
+			out[3] = (in[2] << 8) | 0xff;
+#else
+			out[0] = in[0] | 0xff000000;
+			out[1] = (in[0] >> 24) | (in[1] << 8) | 0xff000000;
+			out[2] = (in[1] >> 16) | (in[2] << 16) | 0xff000000;
+			out[3] = (in[2] >> 8) | 0xff000000;
+#endif
+
+			memcpy(dest, out, sizeof(out));
+			dest += RGBA_BYTES * 4;
+			src += RGB_BYTES * 4;
+		}
+
 	while( len-- )
 		{
 			*dest = *src;
@@ -134,6 +171,74 @@ unsigned char desaturate_pixel(const unsigned char *src, pixel_fmt p)
 
 
 
+/*
+ * set a row of pixel-mask bytes from a row of pixels:  a pixel is "hot"
+ * if its alpha, or if the alpha isn't used, its desaturated value, is
+ * at least half.  with SIMD, eight pixels are done at a time, each pair
+ * in an mmx register; the weighted sum of a pixel's components fits in
+ * 16 bits, so the top one of those says whether it's hot.
+ */
+void mask_from_pixels(int len, const unsigned char *src, unsigned char *mask, pixel_fmt p, int alpha)
+{
+#ifdef WITH_SIMD
+	__m64 hot[4], px, lo, hi, wgt, one, zero, bit;
+	unsigned short w[4];
+	int i;
+
+	memset(w, 0, sizeof(w));
+	w[p.rshift>>3] = R_WGT;
+	w[p.gshift>>3] = G_WGT;
+	w[p.bshift>>3] = B_WGT;
+
+	wgt = _mm_set_pi16(w[3], w[2], w[1], w[0]);
+	one = _mm_set1_pi32(1);
+	zero = _mm_setzero_si64();
+	bit = _mm_cvtsi32_si64(alpha ? p.ashift + 7 : WGT_DIV + 7);
+
+	for( ; len >= 8; len -= 8 )
+		{
+			for( i=0; i < 4; i++ )
+				{
+					px = *(__m64 *)(src + i * 2 * RGBA_BYTES);
+
+					/* the weighted sums of each pixel's components */
+					if( !alpha )
+						{
+							lo = _mm_madd_pi16(_mm_unpacklo_pi8(px, zero), wgt);
+							hi = _mm_madd_pi16(_mm_unpackhi_pi8(px, zero), wgt);
+							px = _mm_add_pi32(_mm_unpacklo_pi32(lo, hi), _mm_unpackhi_pi32(lo, hi));
+						}
+
+					hot[i] = _mm_and_si64(_mm_srl_pi32(px, bit), one);
+				}
+
+			/* narrow the eight results down to bytes */
+			*(__m64 *)mask = _mm_packs_pu16(_mm_packs_pi32(hot[0], hot[1]), _mm_packs_pi32(hot[2], hot[3]));
+
+			src += RGBA_BYTES * 8;
+			mask += 8;
+		}
+
+	_mm_empty();
+#endif
+
+	for( ; len > 0; len-- )
+		{
+			if( alpha )
+				*mask = *(src + (p.ashift>>3)) >= A_MID ? 1 : 0;
+			else
+				*mask = desaturate_pixel(src, p) >= A_MID ? 1 : 0;
+
+			src += RGBA_BYTES;
+			mask++;
+		}
+
+}
+
+
+
+
+
 
 
 
@@ -143,16 +248,135 @@ unsigned char desaturate_pixel(const unsigned char *src, pixel_fmt p)
  */
 void swizzle_pixels(frame *f)
 {
-	int i;
+	int i, j, moves;
 
 	/* the pixel buffer */
 	unsigned char *buf;
 	uint32_t pix;
 
-	/* now, rearrange the pixel component order */
+	/* the components that move together, and how far */
+	uint32_t move_mask[4];
+	int move_shift[4], from[4], to[4];
+#ifdef WITH_SIMD
+	__m64 pair, res, mmx_mask[4], mmx_shift[4];
+#else
+	uint64_t pair, res, pair_mask[4];
+#endif
+
+	/*
+	 * a view's pixels belong to its parent, which is reordered as a whole,
+	 * so that every view of it agrees on the order.
+	 */
+	if( f->parent && (f->shared & FRAME_SHARED_DATA) )
+		{
+			if( f->parent->pixel.epoch < system_pixel.epoch )
+				swizzle_pixels(f->parent);
+			f->pixel = f->parent->pixel;
+			return;
+		}
+
+	/*
+	 * if the order already matches, there's nothing to move.  this also
+	 * keeps frames that point into a mapped asset pack from being copied.
+	 */
+	if( f->pixel.rshift == system_pixel.rshift && f->pixel.gshift == system_pixel.gshift && \
+		 f->pixel.bshift == system_pixel.bshift && f->pixel.ashift == system_pixel.ashift )
+		{
+			f->pixel.epoch = system_pixel.epoch;
+			return;
+		}
+
+	/*
+	 * borrowed pixels, e.g. in an asset pack, may be shared with other
+	 * frames that still expect the old order, so they're reordered in a
+	 * copy of our own.  a frame with views keeps them, as the views must
+	 * see the new order too.
+	 */
+	if( (f->shared & FRAME_SHARED_DATA) && !f->refs )
+		{
+			buf = ck_malloc_aligned(f->w * f->h * RGBA_BYTES + PIXEL_PAD);
+			memset(buf + f->w * f->h * RGBA_BYTES, 0, PIXEL_PAD);
+			for( i=0; i < f->h; i++ )
+				memcpy(buf + i * f->w * RGBA_BYTES, (unsigned char *)f->data + i * f->stride * RGBA_BYTES, f->w * RGBA_BYTES);
+
+			f->data = buf;
+			f->stride = f->w;
+			f->shared &= ~FRAME_SHARED_DATA;
+		}
+
+	/*
+	 * each component moves by the difference between its old and new
+	 * shifts, and those that move by the same amount move together.
+	 * a byte that stays within its pixel can't spill into the next, so
+	 * two pixels are moved at once.
+	 */
+	from[0] = f->pixel.rshift;  to[0] = system_pixel.rshift;
+	from[1] = f->pixel.gshift;  to[1] = system_pixel.gshift;
+	from[2] = f->pixel.bshift;  to[2] = system_pixel.bshift;
+	from[3] = f->pixel.ashift;  to[3] = system_pixel.ashift;
+
+	for( i = moves = 0; i < 4; i++ )
+		{
+			for( j=0; j < moves && move_shift[j] != to[i] - from[i]; j++ )
+				;
+			if( j == moves )
+				{
+					move_mask[moves] = 0;
+					move_shift[moves++] = to[i] - from[i];
+				}
+			move_mask[j] |= (uint32_t)0xff << from[i];
+		}
+
 	buf = f->data;
 	i = f->w * f->h;
-	while( i-- )
+
+#ifdef WITH_SIMD
+	for( j=0; j < moves; j++ )
+		{
+			mmx_mask[j] = _mm_set1_pi32(move_mask[j]);
+			mmx_shift[j] = _mm_cvtsi32_si64(abs(move_shift[j]));
+		}
+
+	for( ; i >= 2; i -= 2 )
+		{
+			pair = *(__m64 *)buf;
+			res = _mm_setzero_si64();
+			for( j=0; j < moves; j++ )
+				{
+					if( move_shift[j] >= 0 )
+						res = _mm_or_si64(res, _mm_sll_si64(_mm_and_si64(pair, mmx_mask[j]), mmx_shift[j]));
+					else
+						res = _mm_or_si64(res, _mm_srl_si64(_mm_and_si64(pair, mmx_mask[j]), mmx_shift[j]));
+				}
+			*(__m64 *)buf = res;
+
+			buf += RGBA_BYTES * 2;
+		}
+
+	_mm_empty();
+#else
+	for( j=0; j < moves; j++ )
+		pair_mask[j] = ((uint64_t)move_mask[j] << 32) | move_mask[j];
+
+	for( ; i >= 2; i -= 2 )
+		{
+			memcpy(&pair, buf, sizeof(pair));
+			res = 0;
+			for( j=0; j < moves; j++ )
+				{
+					if( move_shift[j] >= 0 )
+						res |= (pair & pair_mask[j]) << move_shift[j];
+					else
+						res |= (pair & pair_mask[j]) >> -move_shift[j];
+				}
+			memcpy(buf, &res, sizeof(res));
+
+			buf += RGBA_BYTES * 2;
+		}
+#endif
+
+	/* and an odd pixel left over */
+	if( i )
 		{
 			pix = *(uint32_t *)buf;
 			*(uint32_t *)buf = \
@@ -160,9 +384,6 @@ void swizzle_pixels(frame *f)
 				(((pix >> f->pixel.gshift) & 0xff) << system_pixel.gshift) | \
 				(((pix >> f->pixel.bshift) & 0xff) << system_pixel.bshift) | \
 				(((pix >> f->pixel.ashift) & 0xff) << system_pixel.ashift);
-
-			buf += RGBA_BYTES;
-
 		}
 
 	/* and last, update the pixel epoch and orientation */
@@ -184,10 +405,115 @@ void adjust_scratchpad(int w, int h)
 	/* only resize the buffer up */
 	if( w > scratchpad_size.w || h > scratchpad_size.h )
 		{
-			/* resize and save the new limits */
-			scratchpad = ck_realloc(scratchpad, w * h * RGBA_BYTES);
+			/*
+			 * resize and save the new limits.  nothing in the scratchpad
+			 * outlives a single blit, so it needn't be copied over.
+			 */
+			ck_free_aligned(scratchpad);
+			scratchpad = ck_malloc_aligned(w * h * RGBA_BYTES + PIXEL_PAD);
+			memset(scratchpad + w * h * RGBA_BYTES, 0, PIXEL_PAD);
 			scratchpad_size.w = w;
 			scratchpad_size.h = h;
 		}
 
 }
+
+
+
+
+
+/*
+ * the table of where each column or row of a frame drawn over the
+ * given span comes from.  a frame keeps tables for the last SPAN_WAYS
+ * spans of each kind it was drawn over, so a frame drawn at a few
+ * sizes at once (e.g. by sprites at different scales) doesn't rebuild
+ * them on every blit, and the blitters just look up each pixel's
+ * source.  the least recently used is rebuilt for a new span.  a
+ * column table and a row table are always in different sets, so
+ * asking for one never replaces the other.
+ *
+ * a nearest-neighbour table gives the source each one falls in.  a
+ * filtered table lines up the pixel centres of the frame and the span,
+ * and gives the two sources each one falls between, and how far along.
+ */
+struct span_table *span_table(frame *f, int which, int span)
+{
+	struct span_table *set, *t;
+	long long u;
+	int len, inc, j;
+
+	if( !f->spans )
+		f->spans = ck_calloc(SPAN_TABLES * SPAN_WAYS, sizeof(struct span_table));
+
+	set = &f->spans[which * SPAN_WAYS];
+	len = (which & SPAN_ROWS) ? f->h : f->w;
+
+	/* kept already?  or else, the one to rebuild */
+	t = set;
+	for( j=0; j < SPAN_WAYS; j++ )
+		{
+			if( set[j].len == len && set[j].span == span )
+				{
+					set[j].used = ++span_clock;
+					return &set[j];
+				}
+			if( set[j].used < t->used )
+				t = &set[j];
+		}
+
+	t->used = ++span_clock;
+
+	/* only grow the table */
+	if( span > t->size )
+		{
+			t->size = span;
+			t->idx = ck_realloc(t->idx, span * ((which & SPAN_FILTERED) ? 3 : 1) * sizeof(int));
+			t->next = t->idx + span;
+			t->wt = t->idx + span * 2;
+		}
+
+	t->len = len;
+	t->span = span;
+	inc = fp_set(len) / span;
+
+	if( !(which & SPAN_FILTERED) )
+		{
+			for( j=0; j < span; j++ )
+				t->idx[j] = fp_int(j * inc);
+			return t;
+		}
+
+	for( j=0; j < span; j++ )
+		{
+			u = (long long)j * inc + inc / 2 - fp_set(1) / 2;
+			u = max(u, 0);
+
+			t->idx[j] = min((int)fp_int(u), len - 1);
+			t->next[j] = min(t->idx[j] + 1, len - 1);
+			t->wt[j] = (int)fp_frac(u) >> 8;
+		}
+
+	return t;
+
+}
+
+
+
+
+/*
+ * let go of a frame's scaling tables
+ */
+void free_span_tables(frame *f)
+{
+	int i;
+
+	if( !f->spans )
+		return;
+
+	for( i=0; i < SPAN_TABLES * SPAN_WAYS; i++ )
+		free(f->spans[i].idx);
+
+	free(f->spans);
+	f->spans = NULL;
+
+}
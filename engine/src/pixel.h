@@ -4,10 +4,13 @@
 void set_pixel_order(int, int, int);
 void unpack_rgb(int, const unsigned char *, unsigned char *);
 char unsigned desaturate_pixel(const unsigned char *, pixel_fmt);
+void mask_from_pixels(int, const unsigned char *, unsigned char *, pixel_fmt, int);
 
 /* these are more for internal-use .. */
 void swizzle_pixels(frame *);
 void adjust_scratchpad(int, int);
+struct span_table *span_table(frame *, int, int);
+void free_span_tables(frame *);
 
 
 
@@ -36,6 +39,8 @@ extern void convo_frame_le_scaled(frame *, frame *, point *, dimensions *);
 extern void lut_frame_le_scaled(frame *, frame *, point *, dimensions *);
 extern void xor_frame_le_scaled(frame *, frame *, point *, dimensions *);
 
+extern void rgba_frame_le_filtered(frame *, frame *, point *, dimensions *);
+
 /* from pixel-be.c */
 extern void rgb_frame_be(frame *, frame *, point *);
 extern void rgba_frame_be(frame *, frame *, point *);
@@ -61,10 +66,14 @@ extern void convo_frame_be_scaled(frame *, frame *, point *, dimensions *);
 extern void lut_frame_be_scaled(frame *, frame *, point *, dimensions *);
 extern void xor_frame_be_scaled(frame *, frame *, point *, dimensions *);
 
+extern void rgba_frame_be_filtered(frame *, frame *, point *, dimensions *);
+
 
 /* from graphics.c */
 extern int display_rotation;
 
 /* from misc.c */
-extern void *ck_malloc(size_t);
+extern void *ck_calloc(int, size_t);
 extern void *ck_realloc(void *, size_t);
+extern void *ck_malloc_aligned(size_t);
+extern void ck_free_aligned(void *);
@@ -11,6 +11,34 @@
 
 
 
+/*
+ * profiler hooks:  each is a single test of stats_active when the
+ * profiler is off.  a module using them declares the stats_* globals
+ * and clock_ns() in its own header.  the timestamp is zero if the
+ * profiler was off at the start, so a phase it's turned on during
+ * isn't counted.
+ */
+#define STATS_START(t) do { (t) = stats_active ? clock_ns() : 0; } while(0)
+#define STATS_STOP(phase, t) do { if( stats_active && (t) ) stats_time[phase] += clock_ns() - (t); } while(0)
+#define STATS_COUNT(counter, n) do { if( stats_active ) stats_count[counter] += (n); } while(0)
+
+
+/*
+ * pixel buffers start on a PIXEL_ALIGN boundary, and have PIXEL_PAD
+ * zeroed bytes past their end, so a blitter may read up to that far
+ * past the end of any row of a frame that owns its pixels.
+ */
+#define PIXEL_ALIGN 32
+#define PIXEL_PAD 32
+
+
+/*
+ * a sprite's angle is drawn to the nearest of this many steps in a
+ * whole turn
+ */
+#define ROTATE_STEPS 256
+
+
 /* pixel defines */
 #define A_MID 128
 #define A_DIV 8
@@ -41,6 +69,29 @@
  */
 struct clip { int sx, sy, dx, dy, dw, dh; };
 
+
+/*
+ * which of a frame's cached scaling tables:  its columns or rows, for
+ * nearest-neighbour or filtered scaling
+ */
+#define SPAN_COLUMNS 0
+#define SPAN_ROWS 1
+#define SPAN_FILTERED 2
+#define SPAN_TABLES 4
+
+/* how many spans of each kind a frame keeps tables for */
+#define SPAN_WAYS 4
+
+/* where each column (or row) of a scaled frame is drawn from */
+struct span_table
+{
+	int len, span;    /* the frame's width (or height), and the span it's drawn over */
+	int size;         /* how many entries there's room for */
+	int *idx;         /* the source column for each one drawn */
+	int *next, *wt;   /* and when filtered, the one it's blended with, and its weight out of 256 */
+	unsigned int used;   /* when it was last asked for */
+};
+
 typedef struct renderer {
 	void (*rgb)(frame *, frame *, point *);
 	void (*rgba)(frame *, frame *, point *);
@@ -65,4 +116,6 @@ typedef struct renderer {
 	void (*convo_scaled)(frame *, frame *, point *, dimensions *);
 	void (*lut_scaled)(frame *, frame *, point *, dimensions *);
 	void (*xor_scaled)(frame *, frame *, point *, dimensions *);
+
+	void (*rgba_filtered)(frame *, frame *, point *, dimensions *);
 } renderer;
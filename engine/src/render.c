@@ -1,5 +1,6 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <limits.h>
 #include <stdint.h>
 #include <string.h>
 #include "SDL.h"
@@ -14,6 +15,16 @@
 static int bg_fill;
 static color bg_color;
 
+/*
+ * a sprite's frames, placed on the canvas in the order they're drawn,
+ * and the buffer that runs of them are fused in
+ */
+static struct placement *placed;
+static int placed_size;
+
+static unsigned char *band_buf;
+static int band_buf_size;
+
 
 
 
@@ -92,8 +103,19 @@ void render_set_bg_color(char r, char g, char b)
  */
 void render_display()
 {
+	long long t;
+
+	/* hand over anything loaded in the background since the last frame */
+	load_poll();
+
 	render_scene();
+
+	STATS_START(t);
 	show_rendered();
+	STATS_STOP(STATS_PRESENT, t);
+
+	/* a displayed frame closes off the profiler's frame */
+	stats_frame();
 }
 
 
@@ -167,6 +189,8 @@ static void render_scene()
 	int32_t packed_c;
 	unsigned char *tgt;
 
+	long long t;
+
 
 	/* failsafe */
 	if( !canvas )
@@ -176,6 +200,8 @@ static void render_scene()
 	/* fill the background if necessary */
 	if( bg_fill )
 		{
+			STATS_START(t);
+
 			/* set the pixel for the appropriate system endianness */
 			packed_c = \
 				(bg_color.r << system_pixel.rshift) | \
@@ -191,6 +217,7 @@ static void render_scene()
 					tgt += RGBA_BYTES;
 				}
 
+			STATS_STOP(STATS_BG, t);
 		}
 
 
@@ -227,18 +254,17 @@ static void render_layer(int layer_id)
 	map *m;
 	list *l;
 	sprite *sp;
-	font *f;
 	string *st;
 	frame *fr;
 
 	/* for rendering the tilemap */
 	dimensions ct;     /* how many tiles to draw horiz and vert */
 	point mpos, ofs;   /* two offsets: into the tilemap, of the tiles relative to the screen */
-	dimensions span;   /* the size of the target rendered frame */
 	tile *tptr;        /* ptr into the tilemap */
 
-	/* specific to the text strings */
-	int reset, len;
+	/* for the profiler:  phase start time, sprite visibility */
+	long long t;
+	int shown;
 
 
 
@@ -268,6 +294,7 @@ static void render_layer(int layer_id)
 	m = layer_get_map(layer_id);
 	if( m && m->data )
 		{
+			STATS_START(t);
 
 			/* get the number of tiles across and down that are actually displayed */
 			ct.w = libdivide_s32_do(canvas->clip_rect.x2 - canvas->clip_rect.x1 + m->tw - 1, m->tw_div) + 1;
@@ -281,9 +308,6 @@ static void render_layer(int layer_id)
 			ofs.x = view.x1 + -camera.x % m->tw;
 			ofs.y = view.y1 + -camera.y % m->th;
 
-			span.w = m->tw;
-			span.h = m->th;
-
 			for( i=0; i < ct.h; i++ )
 				{
 					for( j=0; j < ct.w; j++ )
@@ -299,7 +323,10 @@ static void render_layer(int layer_id)
 									/* blit! */
 									if( tptr )              /* does the tile exist .. */
 										if( tptr->frame_ct )  /* and have image data ? */
-											draw(canvas, tptr->frames[tptr->cur_frame], &ofs);
+											{
+												draw(canvas, tptr->frames[tptr->cur_frame], &ofs);
+												STATS_COUNT(STATS_TILES, 1);
+											}
 
 								}
 
@@ -317,6 +344,7 @@ static void render_layer(int layer_id)
 
 				}
 
+			STATS_STOP(STATS_MAP, t);
 
 		}
 
@@ -333,10 +361,15 @@ static void render_layer(int layer_id)
 
 			/* sort the list by z-hint */
 			if( layer_get_sorting(layer_id) > 0 )
-				list_sort( l, compare_by_z_hint );
+				{
+					STATS_START(t);
+					list_sort( l, compare_by_z_hint );
+					STATS_STOP(STATS_SORT, t);
+				}
 
 
 			/* and render all */
+			STATS_START(t);
 			iterator_start(iter, l);
 			while( (sp = iterator_data(iter)) )
 				{
@@ -346,46 +379,20 @@ static void render_layer(int layer_id)
 						{
 
 							/* and draw the frame stack, last to first */
-							i = sp->frames[sp->cur_frame].len;
-							while( i-- )
-								{
+							shown = draw_stack(sp, &camera, &view);
 
-									fr = sp->frames[sp->cur_frame].stack[i];
-
-									/* set the destination x, y with camera adjustment */
-									if( sp->scale.x == fp_set(1) && sp->scale.y == fp_set(1) )
-										{
-											/* unscaled */
-											ofs.x = sp->pos.x - camera.x + view.x1 + fr->offset.x;
-											ofs.y = sp->pos.y - camera.y + view.y1 + fr->offset.y;
-
-											/* and draw the appropriate frame */
-											draw(canvas, fr, &ofs);
-
-										}
-									else
-										{
-											/* scaled */
-											ofs.x = sp->pos.x - camera.x + view.x1 + fp_int(fr->offset.x * sp->scale.x);
-											ofs.y = sp->pos.y - camera.y + view.y1 + fp_int(fr->offset.y * sp->scale.y);
-											span.w = fp_int(sp->frames[sp->cur_frame].stack[i]->w * sp->scale.x);
-											span.h = fp_int(sp->frames[sp->cur_frame].stack[i]->h * sp->scale.y);
-
-											/* and draw the appropriate frame */
-											draw_scaled(canvas, fr, &ofs, &span);
-
-										}
-
-
-								}
+							STATS_COUNT(shown ? STATS_SPRITES_DRAWN : STATS_SPRITES_CULLED, 1);
 
 						}
+					else
+						STATS_COUNT(STATS_SPRITES_CULLED, 1);
 
 					/* advance to next item in list */
 					iterator_next(iter);
 
 				}
 
+			STATS_STOP(STATS_SPRITES, t);
 		}
 
 
@@ -398,76 +405,279 @@ static void render_layer(int layer_id)
 	l = layer_get_string_list(layer_id);
 	if( l )
 		{
+			STATS_START(t);
 
-			/* render all osd strings */
+			/* render all osd strings, each drawn out ahead of time into a frame of its own */
 			iterator_start(iter, l);
 			while( (st = iterator_data(iter)) )
 				{
-
-					/* do we have text to draw? */
-					len = strlen(st->text);
-					if( len )
+					fr = string_get_surface(st);
+					if( fr )
 						{
+							/* set the destination x, y */
+							ofs.x = st->x + canvas_overdraw.w;
+							ofs.y = st->y + canvas_overdraw.h;
+							system_frame.rgba(canvas, fr, &ofs);
+						}
+
+					/* advance to next item in list */
+					iterator_next(iter);
+
+				}
+
+			STATS_STOP(STATS_STRINGS, t);
+		}
+
+
+
+}
+
+
+
+
+
 
-							/* yes!  get the font ptr */
-							f = get_font_by_name(st->font);
-							if( f )
-								{
 
-									/* set the destination x, y with camera adjustment */
-									ofs.x = st->x + canvas_overdraw.w;
-									ofs.y = st->y + canvas_overdraw.h;
-									reset = ofs.x;
-
-									/* loop through the strings, drawing each letter .. */
-									for( i=0; i<len; i++ )
-										{
-											fr = f->chars[(int)*(st->text+i)];
-
-											/* in a proportional-width font, there can be a null frame, so check the frame now */
-											if( fr )
-												{
-													switch( *(st->text + i) )
-														{
-															case '\t':
-																/* tab stop uses 8 spaces */
-																ofs.x += f->chars[32]->w * 8;
-																break;
-															case '\n':
-																ofs.y += fr->h;
-																break;
-															case '\r':
-																ofs.x = reset;
-																break;
-															default:
-																system_frame.rgba(canvas, fr, &ofs);
-																ofs.x += fr->w;
-																break;
-														}
-
-												}
-
-										}
 
-								}
 
+/*
+ * draw a sprite's current frame stack, last to first, and return
+ * whether any of it was on the canvas (only when profiling).
+ *
+ * frames that each change only the pixels under them, without looking
+ * at their neighbours, can be drawn in any slices at all.  so a run of
+ * them that overlap enough is drawn a band of rows at a time into a
+ * buffer small enough to stay in cache, and the canvas is read and
+ * written once for the whole run instead of once for every frame.
+ */
+static int draw_stack(sprite *sp, point *camera, box *view)
+{
+	struct framestack *fs;
+	struct placement *p;
+	frame *fr, *copy;
+	point pivot;
+	dimensions rspan;
+	box area;
+	int i, run, scaled, how, shown;
+
+
+	fs = &sp->frames[sp->cur_frame];
+	scaled = sp->scale.x != fp_set(1) || sp->scale.y != fp_set(1);
+	how = !scaled ? DRAW_PLAIN : (sp->filter && !sp->turn) ? DRAW_FILTERED : DRAW_SCALED;
+
+	/* the copies kept for the last sprite aren't needed any more */
+	if( scaled || sp->turn )
+		release_scaled_frames();
+
+	/* a turned sprite turns about the middle of its first frame, as it's drawn without its offset */
+	if( sp->turn )
+		{
+			fr = fs->stack[0];
+			pivot.x = 2 * (sp->pos.x - camera->x + view->x1) + fp_int(fr->w * sp->scale.x);
+			pivot.y = 2 * (sp->pos.y - camera->y + view->y1) + fp_int(fr->h * sp->scale.y);
+		}
+
+	if( fs->len > placed_size )
+		{
+			placed_size = fs->len;
+			placed = ck_realloc(placed, placed_size * sizeof(struct placement));
+		}
+
+	/* set the destination x, y of every frame with camera adjustment */
+	shown = 0;
+	for( i=0; i < fs->len; i++ )
+		{
+			p = &placed[i];
+			p->fr = fr = fs->stack[fs->len - 1 - i];
+
+			if( !scaled )
+				{
+					p->ofs.x = sp->pos.x - camera->x + view->x1 + fr->offset.x;
+					p->ofs.y = sp->pos.y - camera->y + view->y1 + fr->offset.y;
+					p->span.w = fr->w;
+					p->span.h = fr->h;
+				}
+			else
+				{
+					p->ofs.x = sp->pos.x - camera->x + view->x1 + fp_int(fr->offset.x * sp->scale.x);
+					p->ofs.y = sp->pos.y - camera->y + view->y1 + fp_int(fr->offset.y * sp->scale.y);
+					p->span.w = fp_int(fr->w * sp->scale.x);
+					p->span.h = fp_int(fr->h * sp->scale.y);
+				}
+
+			/*
+			 * a turned frame is drawn from a turned copy, moved to where the
+			 * pivot turns it (a frame that can't be turned is drawn as it
+			 * is), and a scaled one from a copy kept at that size, unless
+			 * it's to be filtered
+			 */
+			if( sp->turn )
+				{
+					if( (copy = rotated_frame(fr, &p->span, sp->turn)) )
+						{
+							rspan.w = copy->w;
+							rspan.h = copy->h;
+							turn_placement(&p->ofs, &p->span, &pivot, sp->turn, &rspan);
+							p->fr = copy;
+							p->span = rspan;
 						}
+				}
+			else if( scaled && !(how == DRAW_FILTERED && fr->tag == FRAME_RGBA) && (copy = scaled_frame(fr, &p->span)) )
+				p->fr = copy;
 
-					/* advance to next item in list */
-					iterator_next(iter);
+			if( stats_active )
+				shown |= on_canvas(&p->ofs, p->span.w, p->span.h);
+		}
 
+	/* and draw them, a frame or a fused run at a time */
+	for( i=0; i < fs->len; i += run )
+		{
+			run = fusible_run(&placed[i], fs->len - i, &area);
+			if( run > 1 )
+				{
+					draw_fused(&placed[i], run, how, &area);
+					STATS_COUNT(STATS_FRAMES_FUSED, run);
 				}
+			else
+				draw_placement(canvas, &placed[i], &placed[i].ofs, how);
+		}
+
+	return shown;
+}
+
+
+
+
+/*
+ * how many frames from here on can be drawn as one fused run?  they
+ * must all be pointwise, and cover enough of the same pixels that
+ * copying the area they share in and out of the band buffer costs
+ * less than the passes it saves.  the area is returned, clipped.
+ */
+static int fusible_run(struct placement *p, int len, box *area)
+{
+	int i, covered, x1, y1, x2, y2;
+
 
+	area->x1 = area->y1 = INT_MAX;
+	area->x2 = area->y2 = INT_MIN;
+	covered = 0;
+
+	for( i=0; i < len; i++ )
+		{
+			switch( p[i].fr->tag )
+				{
+					case FRAME_RGB:  case FRAME_RGBA:
+					case FRAME_HL:   case FRAME_SL:
+					case FRAME_BR:   case FRAME_CT:
+					case FRAME_SAT:  case FRAME_LUT:
+					case FRAME_XOR:
+						break;
+
+					default:
+						len = i;
+						continue;
+				}
+
+			/* the part of the frame inside the canvas clip */
+			x1 = max(p[i].ofs.x, canvas->clip_rect.x1);
+			y1 = max(p[i].ofs.y, canvas->clip_rect.y1);
+			x2 = min(p[i].ofs.x + p[i].span.w, canvas->clip_rect.x2);
+			y2 = min(p[i].ofs.y + p[i].span.h, canvas->clip_rect.y2);
+			if( x2 <= x1 || y2 <= y1 )
+				continue;
+
+			covered += (x2 - x1) * (y2 - y1);
+			area->x1 = min(area->x1, x1);
+			area->y1 = min(area->y1, y1);
+			area->x2 = max(area->x2, x2);
+			area->y2 = max(area->y2, y2);
 		}
 
+	if( len < 2 || area->x2 <= area->x1 )
+		return 1;
 
+	/* the frames cover their shared area at least one and a half times over? */
+	if( covered * 2 < (area->x2 - area->x1) * (area->y2 - area->y1) * 3 )
+		return 1;
 
+	return len;
 }
 
 
 
 
+/*
+ * draw a run of pointwise frames over the given area of the canvas, a
+ * band of rows at a time.  the band is a frame of its own, so the
+ * frames are drawn onto it by the usual blitters.
+ */
+static void draw_fused(struct placement *p, int len, int how, box *area)
+{
+	frame band;
+	point ofs;
+	unsigned char *row;
+	int i, y, w, rows, pitch;
+
+
+	w = area->x2 - area->x1;
+	pitch = w * RGBA_BYTES;
+	rows = max(STACK_BAND_BYTES / pitch, 1);
+
+	if( rows * pitch > band_buf_size )
+		{
+			/* aligned and padded like any frame's pixels, as the blitters may expect */
+			band_buf_size = rows * pitch;
+			ck_free_aligned(band_buf);
+			band_buf = ck_malloc_aligned(band_buf_size + PIXEL_PAD);
+			memset(band_buf + band_buf_size, 0, PIXEL_PAD);
+		}
+
+	memset(&band, 0, sizeof(frame));
+	band.tag = FRAME_RGBA;
+	band.data = band_buf;
+	band.w = band.stride = w;
+	band.pixel = canvas->pixel;
+
+	for( y = area->y1; y < area->y2; y += rows )
+		{
+			band.h = min(rows, area->y2 - y);
+			band.clip_rect.x1 = band.clip_rect.y1 = 0;
+			band.clip_rect.x2 = w;
+			band.clip_rect.y2 = band.h;
+
+			/* bring the rows in .. */
+			row = (unsigned char *)canvas->data + (area->x1 + canvas->w * y) * RGBA_BYTES;
+			for( i=0; i < band.h; i++ )
+				memcpy(band_buf + i * pitch, row + i * canvas->w * RGBA_BYTES, pitch);
+
+			/* .. draw every frame over them .. */
+			for( i=0; i < len; i++ )
+				{
+					ofs.x = p[i].ofs.x - area->x1;
+					ofs.y = p[i].ofs.y - y;
 
+					draw_placement(&band, &p[i], &ofs, how);
+				}
+
+			/* .. and put them back */
+			for( i=0; i < band.h; i++ )
+				memcpy(row + i * canvas->w * RGBA_BYTES, band_buf + i * pitch, pitch);
+		}
+
+}
+
+
+
+
+/*
+ * does a frame drawn at the given offset touch the canvas clipping rect?
+ */
+static int on_canvas(point *ofs, int w, int h)
+{
+	return ofs->x < canvas->clip_rect.x2 && ofs->x + w > canvas->clip_rect.x1 &&
+		ofs->y < canvas->clip_rect.y2 && ofs->y + h > canvas->clip_rect.y1;
+}
 
 
 
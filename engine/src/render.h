@@ -3,6 +3,22 @@
  * rendering functions
  */
 
+/* how much of the canvas a fused run of sprite frames is drawn through at once */
+#define STACK_BAND_BYTES 32768
+
+/* how a sprite's frames are drawn:  as they are, scaled, or scaled with rgba frames filtered */
+#define DRAW_PLAIN 0
+#define DRAW_SCALED 1
+#define DRAW_FILTERED 2
+
+/* a sprite frame, and where and how large it's drawn */
+struct placement
+{
+	frame *fr;
+	point ofs;
+	dimensions span;
+};
+
 #define draw(dest, f, ofs) \
 	do \
 		{ \
@@ -43,6 +59,19 @@
 			} \
 	while(0)
 
+/* a placement is drawn scaled unless its frame, which may be a kept copy, is already the size it's drawn */
+#define draw_placement(dest, p, ofs, how) \
+	do \
+		{ \
+			if( (how) == DRAW_FILTERED && (p)->fr->tag == FRAME_RGBA ) \
+				system_frame.rgba_filtered((dest), (p)->fr, (ofs), &(p)->span); \
+			else if( (p)->span.w != (p)->fr->w || (p)->span.h != (p)->fr->h ) \
+				draw_scaled((dest), (p)->fr, (ofs), &(p)->span); \
+			else \
+				draw((dest), (p)->fr, (ofs)); \
+		} \
+	while(0)
+
 
 
 
@@ -56,12 +85,22 @@ int render_to_disk(const char *);
 
 static void render_scene();
 static void render_layer(int);
+static int draw_stack(sprite *, point *, box *);
+static int fusible_run(struct placement *, int, box *);
+static void draw_fused(struct placement *, int, int, box *);
+static int on_canvas(point *, int, int);
 static int compare_by_z_hint(void *, void *);
 
 
 /* from pixel.c */
 extern renderer system_frame;
 
+/* from scaled.c */
+extern frame *scaled_frame(frame *, dimensions *);
+extern frame *rotated_frame(frame *, dimensions *, int);
+extern void turn_placement(point *, dimensions *, point *, int, dimensions *);
+extern void release_scaled_frames();
+
 /* from list.c */
 extern void list_sort(list *, int (*)(void *, void *));
 
@@ -85,8 +124,23 @@ extern frame *canvas;
 extern dimensions canvas_overdraw;
 
 
-/* from font.c */
-extern font *get_font_by_name(const char *);
+/* from string.c */
+extern frame *string_get_surface(string *);
+
+/* from stats.c */
+extern int stats_active;
+extern long long stats_time[];
+extern int stats_count[];
+extern void stats_frame();
+
+/* from clock.c */
+extern long long clock_ns();
+
+/* from loader.c */
+extern int load_poll();
 
 /* from misc.h */
 extern void fatal(char *,int);
+extern void *ck_realloc(void *, size_t);
+extern void *ck_malloc_aligned(size_t);
+extern void ck_free_aligned(void *);
@@ -0,0 +1,527 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "SDL.h"
+#include "common.h"
+#include "scaled.h"
+
+
+
+/*
+ * most scaled sprites are drawn at one of a few fixed scales, so
+ * instead of scaling a frame's pixels every time it's drawn (and its
+ * mask every time it's tested for collisions), a copy of it at the
+ * size it's drawn at is kept here, and used through the unscaled
+ * blitters and tests.  the copies are picked the same way the scaled
+ * blitters pick pixels, so what's drawn is no different.  turned
+ * sprites are drawn the same way, from copies of their frames turned
+ * to one of ROTATE_STEPS angles, as there's no blitter that turns.
+ *
+ * there's room for SCALED_ENTRIES copies, taking up no more than
+ * SCALED_BYTES between them, and the least recently used are let go
+ * first.  but a caller may hold on to several copies at once, e.g. one
+ * for each frame in a sprite's stack, so the copies handed out since
+ * the last call to release_scaled_frames() are never let go; each use
+ * of the cache starts with that call.  a frame's copies are dropped as
+ * soon as it's changed or deleted.
+ */
+static struct scaled_entry scaled_cache[SCALED_ENTRIES];
+static size_t scaled_bytes;
+static unsigned int scaled_clock, scaled_held;
+
+/* the sine of each step of a quarter turn, in fixed point, once it's worked out */
+static int quarter_sin[ROTATE_STEPS / 4 + 1];
+
+
+
+
+/*
+ * the frame at the given size:  the frame itself if that's its own
+ * size, or else a copy of it at that size.  returns NULL if it has to
+ * be scaled as it's used instead, because it's a type that isn't
+ * copied, it would take up too much of the cache, or there's no room
+ * left that isn't held.
+ */
+frame *scaled_frame(frame *f, dimensions *span)
+{
+	if( span->w == f->w && span->h == f->h )
+		return f;
+
+	/* failsafe */
+	if( span->w < 1 || span->h < 1 )
+		return NULL;
+
+	return keep_copy(f, span, 0);
+}
+
+
+
+
+/*
+ * the frame at the given size, turned the given number of steps
+ * clockwise about its middle:  an rgba copy of it, the size of the box
+ * the turned frame fits in (see rotated_span()) and clear around it.
+ * only rgb and rgba frames can be turned, so NULL is returned for the
+ * rest, or if there's no room left that isn't held.
+ */
+frame *rotated_frame(frame *f, dimensions *span, int turn)
+{
+	turn &= ROTATE_STEPS - 1;
+	if( !turn )
+		return scaled_frame(f, span);
+
+	/* failsafe */
+	if( span->w < 1 || span->h < 1 || (f->tag != FRAME_RGB && f->tag != FRAME_RGBA) )
+		return NULL;
+
+	return keep_copy(f, span, turn);
+}
+
+
+
+
+/*
+ * the sine of an angle in steps, in fixed point.  the cosine is the
+ * sine a quarter turn on.
+ */
+int rotate_sin(int turn)
+{
+	double c, s0, s1, s2;
+	int i, sign;
+
+
+	/* work out a quarter turn the first time, by the recurrence sin((k+1)a) = 2 cos(a) sin(ka) - sin((k-1)a) */
+	if( !quarter_sin[ROTATE_STEPS / 4] )
+		{
+			c = 0.99969881869620422;    /* the cosine of one step (of 256) */
+			s0 = 0.0;
+			s1 = 0.02454122852291229;   /* and its sine */
+
+			for( i=0; i <= ROTATE_STEPS / 4; i++ )
+				{
+					quarter_sin[i] = (int)(s0 * fp_set(1) + 0.5);
+					s2 = 2.0 * c * s1 - s0;
+					s0 = s1;
+					s1 = s2;
+				}
+		}
+
+	/* and the rest of the turn mirrors it */
+	turn &= ROTATE_STEPS - 1;
+	sign = 1;
+	if( turn >= ROTATE_STEPS / 2 )
+		{
+			turn -= ROTATE_STEPS / 2;
+			sign = -1;
+		}
+
+	if( turn > ROTATE_STEPS / 4 )
+		turn = ROTATE_STEPS / 2 - turn;
+
+	return sign * quarter_sin[turn];
+
+}
+
+
+
+
+/*
+ * the size of the box a frame drawn at the given size fits in, when
+ * it's turned the given number of steps
+ */
+void rotated_span(dimensions *span, int turn, dimensions *res)
+{
+	long long c, s;
+
+	c = abs(rotate_sin(turn + ROTATE_STEPS / 4));
+	s = abs(rotate_sin(turn));
+
+	res->w = (int)((span->w * c + span->h * s + fp_set(1) - 1) >> 16);
+	res->h = (int)((span->w * s + span->h * c + fp_set(1) - 1) >> 16);
+}
+
+
+
+
+/*
+ * move a frame drawn at ofs over span to where its turned copy, of
+ * size rspan, is drawn:  the middle of the frame is turned about the
+ * pivot, which is given in half pixels (i.e. doubled) so it can fall
+ * between them, and the copy is centred on it.
+ */
+void turn_placement(point *ofs, dimensions *span, point *pivot, int turn, dimensions *rspan)
+{
+	long long c, s, dx, dy;
+
+	c = rotate_sin(turn + ROTATE_STEPS / 4);
+	s = rotate_sin(turn);
+
+	/* the middle of the frame, from the pivot, in half pixels */
+	dx = 2 * ofs->x + span->w - pivot->x;
+	dy = 2 * ofs->y + span->h - pivot->y;
+
+	ofs->x = (int)((pivot->x + ((c * dx - s * dy + fp_set(1) / 2) >> 16) - rspan->w) >> 1);
+	ofs->y = (int)((pivot->y + ((s * dx + c * dy + fp_set(1) / 2) >> 16) - rspan->h) >> 1);
+}
+
+
+
+
+/*
+ * find, or make and keep, a copy of a frame at the given size and
+ * turn
+ */
+static frame *keep_copy(frame *f, dimensions *span, int turn)
+{
+	struct scaled_entry *e, *slot, *lru;
+	dimensions rspan;
+	size_t bytes;
+	int i, bpp;
+
+
+	for( i=0; i < SCALED_ENTRIES; i++ )
+		{
+			e = &scaled_cache[i];
+			if( e->fr && e->src == f && e->turn == turn && e->span.w == span->w && e->span.h == span->h )
+				{
+					e->used = ++scaled_clock;
+					return e->fr;
+				}
+		}
+
+	/* not kept yet:  is it worth keeping? */
+	if( turn )
+		{
+			/* a turned frame can't be drawn any other way, so it's kept whatever its size, if there's room */
+			rotated_span(span, turn, &rspan);
+			bytes = (size_t)rspan.w * rspan.h * (RGBA_BYTES + (f->mask ? 1 : 0));
+			bpp = RGBA_BYTES;
+		}
+	else
+		{
+			bpp = scaled_pixel_bytes(f->tag);
+			if( !bpp )
+				return NULL;
+
+			bytes = (size_t)span->w * span->h * (bpp + (f->mask ? 1 : 0));
+			if( bytes > SCALED_BYTES / 4 )
+				return NULL;
+		}
+
+	/* make room for it, letting go of the least recently used copies that aren't held */
+	for( ;; )
+		{
+			slot = lru = NULL;
+			for( i=0; i < SCALED_ENTRIES; i++ )
+				{
+					e = &scaled_cache[i];
+					if( !e->fr )
+						{
+							if( !slot )
+								slot = e;
+						}
+					else if( e->used < scaled_held && (!lru || e->used < lru->used) )
+						lru = e;
+				}
+
+			/* a turned copy larger than the whole cache gets it to itself */
+			if( slot && (scaled_bytes + bytes <= SCALED_BYTES || (turn && !scaled_bytes)) )
+				break;
+
+			if( !lru )
+				return NULL;
+
+			drop_entry(lru);
+		}
+
+	slot->fr = turn ? rotate_frame(f, span, turn, &rspan) : scale_frame(f, span, bpp);
+	slot->src = f;
+	slot->span = *span;
+	slot->turn = turn;
+	slot->bytes = bytes;
+	slot->used = ++scaled_clock;
+	scaled_bytes += bytes;
+
+	/* so the family knows to look here when it changes */
+	f->shared |= FRAME_SCALED;
+	if( f->parent )
+		f->parent->shared |= FRAME_SCALED;
+
+	return slot->fr;
+
+}
+
+
+
+
+/*
+ * start a new use of the cache:  the copies handed out so far aren't
+ * held any longer, and may be let go to make room
+ */
+void release_scaled_frames()
+{
+	scaled_held = scaled_clock + 1;
+}
+
+
+
+
+/*
+ * let go of the copies of a frame, because it's been changed or it's
+ * going away.  a view and its parent may share pixels or a mask, so
+ * the copies of the rest of the family go too.  a family that's never
+ * been copied is left without looking at the cache, which is what
+ * lets the loader threads change frames they haven't handed out yet.
+ */
+void drop_scaled_frames(frame *f)
+{
+	struct scaled_entry *e;
+	frame *root;
+	int i;
+
+	/* nothing kept? */
+	root = f->parent ? f->parent : f;
+	if( !((f->shared | root->shared) & FRAME_SCALED) || !scaled_bytes )
+		return;
+
+	for( i=0; i < SCALED_ENTRIES; i++ )
+		{
+			e = &scaled_cache[i];
+			if( e->fr && (e->src == f || e->src == root || e->src->parent == root) )
+				drop_entry(e);
+		}
+
+}
+
+
+
+
+
+
+
+
+
+
+/*
+ * how many bytes each pixel of a frame type takes, for the types whose
+ * pixels are drawn without looking at their neighbours, or 0
+ */
+static int scaled_pixel_bytes(int tag)
+{
+	switch( tag )
+		{
+			case FRAME_RGB:
+			case FRAME_RGBA:
+			case FRAME_HL:
+			case FRAME_SL:
+			case FRAME_BR:
+			case FRAME_XOR:
+				return RGBA_BYTES;
+
+			case FRAME_CT:
+			case FRAME_SAT:
+			case FRAME_LUT:
+				return 1;
+		}
+
+	return 0;
+}
+
+
+
+
+/*
+ * make a copy of a frame, and of its mask, at the given size
+ */
+static frame *scale_frame(frame *f, dimensions *span, int bpp)
+{
+	const int *xs, *ys;
+	frame *new;
+
+
+	new = frame_create(f->tag, span->w, span->h, NULL, NULL);
+	new->pixel = f->pixel;
+
+	if( f->tag == FRAME_LUT )
+		memcpy(new->aux, f->aux, sizeof(lut));
+
+	/* the same columns and rows the scaled blitters would draw */
+	xs = span_table(f, SPAN_COLUMNS, span->w)->idx;
+	ys = span_table(f, SPAN_ROWS, span->h)->idx;
+
+	scale_rows(new->data, f->data, f->stride * bpp, bpp, xs, ys, span);
+
+	if( f->mask )
+		{
+			new->mask = ck_malloc(span->w * span->h);
+			scale_rows(new->mask, f->mask, f->stride, 1, xs, ys, span);
+		}
+
+	return new;
+
+}
+
+
+
+
+/*
+ * pick the given columns of the given rows of a buffer
+ */
+static void scale_rows(unsigned char *dest, const unsigned char *src, int pitch, int bpp, const int *xs, const int *ys, dimensions *span)
+{
+	const unsigned char *row;
+	int x, y;
+
+	for( y=0; y < span->h; y++ )
+		{
+			row = src + ys[y] * pitch;
+
+			if( bpp == RGBA_BYTES )
+				for( x=0; x < span->w; x++, dest += RGBA_BYTES )
+					memcpy(dest, row + xs[x] * RGBA_BYTES, RGBA_BYTES);
+			else
+				for( x=0; x < span->w; x++ )
+					*dest++ = row[xs[x]];
+		}
+
+}
+
+
+
+
+/*
+ * make a turned copy of an rgb or rgba frame, and of its mask.  each
+ * row of the copy crosses the frame along a straight line, stepping
+ * the same distance through it from one pixel to the next, so the part
+ * of the row that lands on the frame is found first, and only that is
+ * walked; the rest is left clear.
+ */
+static frame *rotate_frame(frame *f, dimensions *span, int turn, dimensions *rspan)
+{
+	long long c, s, x0, y0, u0, v0;
+	int dux, duy, dvx, dvy, u, v, x, x1, x2, y, a;
+	unsigned char *row, *mrow;
+	frame *new;
+
+
+	new = frame_create(FRAME_RGBA, rspan->w, rspan->h, NULL, NULL);
+	new->pixel = f->pixel;
+	memset(new->data, 0, rspan->w * rspan->h * RGBA_BYTES);
+
+	if( f->mask )
+		new->mask = ck_calloc(rspan->w * rspan->h, 1);
+
+	/* an rgb frame is opaque, so its copy's alpha is set wherever it's drawn */
+	a = (f->tag == FRAME_RGB) ? f->pixel.ashift >> 3 : -1;
+
+	/*
+	 * how far through the frame, in its own pixels, each step along a
+	 * row (x) or down a column (y) of the copy goes.  the copy is turned
+	 * back the other way to find where each pixel of it comes from.
+	 */
+	c = rotate_sin(turn + ROTATE_STEPS / 4);
+	s = rotate_sin(turn);
+	dux = (int)(c * f->w / span->w);
+	duy = (int)(s * f->w / span->w);
+	dvx = (int)(-s * f->h / span->h);
+	dvy = (int)(c * f->h / span->h);
+
+	/* the middle of the first pixel of the copy, from the middle of the copy */
+	x0 = fp_set(1) / 2 - (long long)fp_set(rspan->w) / 2;
+
+	for( y=0; y < rspan->h; y++ )
+		{
+			y0 = fp_set(1) / 2 + (long long)fp_set(y) - (long long)fp_set(rspan->h) / 2;
+			u0 = fp_set(f->w) / 2 + ((x0 * dux + y0 * duy) >> 16);
+			v0 = fp_set(f->h) / 2 + ((x0 * dvx + y0 * dvy) >> 16);
+
+			/* the part of the row that lands on the frame */
+			x1 = 0;
+			x2 = rspan->w;
+			clip_axis(u0, dux, fp_set(f->w), &x1, &x2);
+			clip_axis(v0, dvx, fp_set(f->h), &x1, &x2);
+
+			row = (unsigned char *)new->data + y * rspan->w * RGBA_BYTES;
+			mrow = f->mask ? new->mask + y * rspan->w : NULL;
+			u = (int)(u0 + (long long)x1 * dux);
+			v = (int)(v0 + (long long)x1 * dvx);
+
+			for( x = x1; x < x2; x++, u += dux, v += dvx )
+				{
+					memcpy(row + x * RGBA_BYTES, (unsigned char *)f->data + (fp_int(v) * f->stride + fp_int(u)) * RGBA_BYTES, RGBA_BYTES);
+					if( a >= 0 )
+						row[x * RGBA_BYTES + a] = RGB_MAX;
+					if( f->mask )
+						mrow[x] = f->mask[fp_int(v) * f->stride + fp_int(u)];
+				}
+		}
+
+	return new;
+
+}
+
+
+
+
+/*
+ * narrow a range of steps x1 <= x < x2 down to those where p + x * d
+ * is within 0 <= .. < lim
+ */
+static void clip_axis(long long p, int d, int lim, int *x1, int *x2)
+{
+	long long lo, hi;
+
+	if( d == 0 )
+		{
+			if( p < 0 || p >= lim )
+				*x2 = *x1;
+			return;
+		}
+
+	if( d > 0 )
+		{
+			lo = -floor_div(p, d);
+			hi = -floor_div(p - lim, d);
+		}
+	else
+		{
+			lo = floor_div(p - lim, -d) + 1;
+			hi = floor_div(p, -d) + 1;
+		}
+
+	if( lo > *x1 )
+		*x1 = (int)min(lo, *x2);
+	if( hi < *x2 )
+		*x2 = (int)max(hi, *x1);
+
+}
+
+
+
+
+/*
+ * division rounded down, for a positive divisor
+ */
+static long long floor_div(long long a, long long b)
+{
+	return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+
+
+
+/*
+ * let go of a kept copy
+ */
+static void drop_entry(struct scaled_entry *e)
+{
+	frame *fr;
+
+	/* the entry is cleared first, since deleting the copy looks through the cache too */
+	fr = e->fr;
+	e->fr = NULL;
+	e->src = NULL;
+	scaled_bytes -= e->bytes;
+
+	frame_delete(fr);
+}
@@ -0,0 +1,46 @@
+
+/*
+ * copies of frames at the sizes and angles sprites are drawn at
+ */
+#define SCALED_ENTRIES 64
+#define SCALED_BYTES (4 << 20)
+
+struct scaled_entry
+{
+	frame *src;          /* the frame, */
+	dimensions span;     /* the size it's drawn at, */
+	int turn;            /* the steps it's turned, */
+	frame *fr;           /* and its copy at that size, if the entry's in use */
+	size_t bytes;        /* how much the copy's pixels and mask take up */
+	unsigned int used;   /* and when it was last asked for */
+};
+
+
+frame *scaled_frame(frame *, dimensions *);
+frame *rotated_frame(frame *, dimensions *, int);
+int rotate_sin(int);
+void rotated_span(dimensions *, int, dimensions *);
+void turn_placement(point *, dimensions *, point *, int, dimensions *);
+void release_scaled_frames();
+void drop_scaled_frames(frame *);
+
+static frame *keep_copy(frame *, dimensions *, int);
+static int scaled_pixel_bytes(int);
+static frame *scale_frame(frame *, dimensions *, int);
+static void scale_rows(unsigned char *, const unsigned char *, int, int, const int *, const int *, dimensions *);
+static frame *rotate_frame(frame *, dimensions *, int, dimensions *);
+static void clip_axis(long long, int, int, int *, int *);
+static long long floor_div(long long, long long);
+static void drop_entry(struct scaled_entry *);
+
+
+/* from frame.c */
+extern frame *frame_create(int, int, int, const void *, const void *);
+extern void frame_delete(frame *);
+
+/* from pixel.c */
+extern struct span_table *span_table(frame *, int, int);
+
+/* from misc.c */
+extern void *ck_calloc(int, size_t);
+extern void *ck_malloc(size_t);
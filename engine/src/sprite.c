@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
 #include "common.h"
 #include "sprite.h"
 
@@ -101,6 +102,8 @@ void sprite_delete(sprite *s)
 	if( !s )
 		return;
 
+	object_deleted(OBJ_SPRITE, s);
+
 	/* remove the specific data for each frame */
 	for( i=0; i < s->frame_ct; i++ )
 		{
@@ -172,6 +175,30 @@ int sprite_get_z_hint(sprite *s, int *z_hint)
 
 
 
+int sprite_get_filter(sprite *s, int *filter)
+{
+	/* failsafe */
+	if( !s )
+		return ERR;
+
+	*filter = s->filter;
+	return 0;
+}
+
+
+
+int sprite_get_angle(sprite *s, int *angle)
+{
+	/* failsafe */
+	if( !s )
+		return ERR;
+
+	*angle = s->angle;
+	return 0;
+}
+
+
+
 int sprite_get_position(sprite *s, int *x, int *y)
 {
 	/* failsafe */
@@ -266,6 +293,18 @@ void sprite_set_z_hint(sprite *s, int z_hint)
 
 
 
+void sprite_set_filter(sprite *s, int filter)
+{
+	/* failsafe */
+	if( !s )
+		return;
+
+	s->filter = filter ? 1 : 0;
+
+}
+
+
+
 void sprite_set_collides(sprite *s, int mode)
 {
 	/* failsafe */
@@ -332,6 +371,27 @@ void sprite_set_scale(sprite *s, int sx, int sy)
 
 
 
+void sprite_set_angle(sprite *s, int angle)
+{
+	/* failsafe */
+	if( !s )
+		return;
+
+	/* keep it within a single turn */
+	angle %= fp_set(360);
+	if( angle < 0 )
+		angle += fp_set(360);
+
+	s->angle = angle;
+	s->turn = (int)(((long long)angle * ROTATE_STEPS + fp_set(180)) / fp_set(360)) % ROTATE_STEPS;
+
+	/* the sprite's bounds turn with it */
+	update_bound_cache(s);
+
+}
+
+
+
 
 
 
@@ -398,8 +458,9 @@ void sprite_set_pixel_mask_from(sprite *s, int idx, frame *src)
 	if( frame_set_mask_from(*s->frames[idx].stack, src) == ERR )
 		return;
 
-	/* update the pixel bounds for this frame */
-	find_pixel_bounds(*s->frames[idx].stack, &s->bound[idx]);
+	/* update the pixel bounds for this frame, unless they came with the mask */
+	if( pack_frame_bound(*s->frames[idx].stack, &s->bound[idx]) == ERR )
+		find_pixel_bounds(*s->frames[idx].stack, &s->bound[idx]);
 
 	/* update the sprite bound cache, if needed */
 	if( idx == s->cur_frame )
@@ -569,6 +630,9 @@ void update_bound_cache(sprite *s)
 					s->bc.y2 = s->pos.y + fp_int(s->bound[s->cur_frame].y2 * s->scale.y) - 1;
 				}
 
+			if( s->turn )
+				turn_bound_cache(s);
+
 		}
 
 }
@@ -576,15 +640,87 @@ void update_bound_cache(sprite *s)
 
 
 
+/*
+ * turn the bounds cache with a turned sprite, about the same pivot it's
+ * drawn turned about.  pixel-accurate collisions test the mask of the
+ * turned copy of the first frame, so the bounds are the box that copy
+ * is drawn in; otherwise they're the box the corners of the bounds
+ * turn into.
+ */
+static void turn_bound_cache(sprite *s)
+{
+	frame *f;
+	dimensions span, rspan;
+	point pivot, ofs;
+	long long c, sn, dx, dy, rx, ry;
+	int i, x1, y1, x2, y2;
+
+
+	f = s->frames[s->cur_frame].stack[0];
+	span.w = fp_int(f->w * s->scale.x);
+	span.h = fp_int(f->h * s->scale.y);
+
+	/* in half pixels, as the middle of the frame may fall between them */
+	pivot.x = 2 * s->pos.x + span.w;
+	pivot.y = 2 * s->pos.y + span.h;
+
+	if( s->collides == COLLISION_PIXEL )
+		{
+			rotated_span(&span, s->turn, &rspan);
+			ofs = s->pos;
+			turn_placement(&ofs, &span, &pivot, s->turn, &rspan);
+
+			s->bc.x1 = ofs.x;
+			s->bc.y1 = ofs.y;
+			s->bc.x2 = ofs.x + rspan.w - 1;
+			s->bc.y2 = ofs.y + rspan.h - 1;
+			return;
+		}
+
+	c = rotate_sin(s->turn + ROTATE_STEPS / 4);
+	sn = rotate_sin(s->turn);
+
+	x1 = y1 = INT_MAX;
+	x2 = y2 = INT_MIN;
+	for( i=0; i < 4; i++ )
+		{
+			/* each corner, from the pivot, in half pixels */
+			dx = 2 * ((i & 1) ? s->bc.x2 + 1 : s->bc.x1) - pivot.x;
+			dy = 2 * ((i & 2) ? s->bc.y2 + 1 : s->bc.y1) - pivot.y;
+
+			rx = pivot.x + ((c * dx - sn * dy) >> 16);
+			ry = pivot.y + ((sn * dx + c * dy) >> 16);
+
+			x1 = min(x1, (int)rx);
+			y1 = min(y1, (int)ry);
+			x2 = max(x2, (int)rx);
+			y2 = max(y2, (int)ry);
+		}
+
+	/* back to whole pixels, rounding outwards */
+	s->bc.x1 = x1 >> 1;
+	s->bc.y1 = y1 >> 1;
+	s->bc.x2 = ((x2 + 1) >> 1) - 1;
+	s->bc.y2 = ((y2 + 1) >> 1) - 1;
+
+}
+
+
+
+
 
 
 
 /*
- * find the outer edges of a pixel mask
+ * find the outer edges of a pixel mask.  the rows are scanned in
+ * order, a word of mask bytes at a time:  first for the top and bottom
+ * rows with anything set, and then each row in between only for set
+ * pixels outside the left and right edges found so far.
  */
 static void find_pixel_bounds(frame *fr, box *bound)
 {
-	int px, py;
+	unsigned char *row;
+	int py, i;
 
 	/* find the pixel mask boundary */
 	bound->x1 = fr->w;
@@ -592,27 +728,83 @@ static void find_pixel_bounds(frame *fr, box *bound)
 	bound->x2 = 0;
 	bound->y2 = 0;
 
-	for( px=0; px < fr->w; px++ )
-		for( py=0; py < fr->h; py++ )
-			{
-
-				/* if there is a pel set here, check to see if the boundary must be adjusted. */
-				if( *(fr->mask + px + py * fr->w) )
-					{
-						if( px < bound->x1 )
-							bound->x1 = px;
-						if( px > bound->x2 )
-							bound->x2 = px;
-						if( py < bound->y1 )
-							bound->y1 = py;
-						if( py > bound->y2 )
-							bound->y2 = py;
-					}
-
-			}
+	for( py=0; py < fr->h; py++ )
+		if( first_set(fr->mask + py * fr->stride, fr->w) < fr->w )
+			break;
+
+	/* an empty mask */
+	if( py == fr->h )
+		{
+			bound->x2++;
+			bound->y2++;
+			return;
+		}
+
+	bound->y1 = py;
+	for( py = fr->h - 1; py > bound->y1; py-- )
+		if( first_set(fr->mask + py * fr->stride, fr->w) < fr->w )
+			break;
+	bound->y2 = py;
+
+	bound->x2 = -1;
+	for( py = bound->y1; py <= bound->y2; py++ )
+		{
+			row = fr->mask + py * fr->stride;
+
+			/* if there is a pel set out here, the boundary must be adjusted */
+			bound->x1 = first_set(row, bound->x1);
+
+			i = last_set(row + bound->x2 + 1, fr->w - bound->x2 - 1);
+			if( i >= 0 )
+				bound->x2 += i + 1;
+		}
 
 	/* adjust the lower and right bounds by one to enclose the pixel area .. */
 	bound->x2++;
 	bound->y2++;
 
 }
+
+
+
+
+/*
+ * the first and last non-zero bytes of a run of mask bytes, skipping
+ * words of zeros.  first_set() returns the length if there are none,
+ * and last_set() returns -1.
+ */
+static int first_set(const unsigned char *p, int len)
+{
+	unsigned long word;
+	int i;
+
+	for( i=0; i + (int)sizeof(word) <= len; i += sizeof(word) )
+		{
+			memcpy(&word, p + i, sizeof(word));
+			if( word )
+				break;
+		}
+
+	for( ; i < len && !p[i]; i++ )
+		;
+
+	return i;
+}
+
+static int last_set(const unsigned char *p, int len)
+{
+	unsigned long word;
+	int i;
+
+	for( i = len; i - (int)sizeof(word) >= 0; i -= sizeof(word) )
+		{
+			memcpy(&word, p + i - sizeof(word), sizeof(word));
+			if( word )
+				break;
+		}
+
+	for( i--; i >= 0 && !p[i]; i-- )
+		;
+
+	return i;
+}
@@ -15,6 +15,8 @@ int sprite_get_collides(sprite *, int *);
 int sprite_get_position(sprite *, int *, int *);
 int sprite_get_velocity(sprite *, int *, int *);
 int sprite_get_scale(sprite *, int *, int *);
+int sprite_get_filter(sprite *, int *);
+int sprite_get_angle(sprite *, int *);
 
 void sprite_set_frame(sprite *, int);
 void sprite_set_z_hint(sprite *, int);
@@ -22,6 +24,8 @@ void sprite_set_collides(sprite *, int);
 void sprite_set_position(sprite *, int, int);
 void sprite_set_velocity(sprite *, int, int);
 void sprite_set_scale(sprite *, int, int);
+void sprite_set_filter(sprite *, int);
+void sprite_set_angle(sprite *, int);
 void sprite_set_bounding_box(sprite *, int, box *);
 void sprite_set_pixel_mask(sprite *, int, const unsigned char *);
 void sprite_set_pixel_mask_from(sprite *, int, frame *);
@@ -33,7 +37,11 @@ int sprite_load_program(sprite *, const char *);
 void adjust_sprite_frame(sprite *, int);
 void update_bound_cache(sprite *);
 
+static void turn_bound_cache(sprite *);
+
 static void find_pixel_bounds(frame *, box *);
+static int first_set(const unsigned char *, int);
+static int last_set(const unsigned char *, int);
 
 
 /* from misc.c */
@@ -41,6 +49,7 @@ extern void *ck_calloc(int, size_t);
 extern void *ck_malloc(size_t);
 extern void *ck_realloc(void *, size_t);
 extern void fatal(char *,int);
+extern void object_deleted(int, void *);
 
 /* from motion.c */
 extern int parse_mcp(const char *, mcp *);
@@ -52,3 +61,11 @@ extern void frame_set_scale(frame *, int);
 extern int frame_set_mask(frame *, const unsigned char *);
 extern int frame_set_mask_from(frame *, frame *);
 extern void frame_delete(frame *);
+
+/* from scaled.c */
+extern int rotate_sin(int);
+extern void rotated_span(dimensions *, int, dimensions *);
+extern void turn_placement(point *, dimensions *, point *, int, dimensions *);
+
+/* from pack.c */
+extern int pack_frame_bound(frame *, box *);
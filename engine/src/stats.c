@@ -0,0 +1,146 @@
+#include <stdio.h>
+#include <string.h>
+#include "common.h"
+#include "stats.h"
+
+
+
+/*
+ * the profiler is off unless asked for:  the hooks scattered through
+ * the renderer test stats_active and do nothing else.
+ */
+int stats_active = 0;
+
+/* the running totals for the frame in progress */
+long long stats_time[STATS_PHASES];
+int stats_count[STATS_COUNTERS];
+
+/* when the frame in progress started */
+static long long frame_start;
+
+/* the rolling window of finished frames */
+static frame_stats history[STATS_WINDOW];
+static int hist_pos, hist_len;
+
+
+
+
+/*
+ * switch the profiler on or off
+ */
+void stats_set_enabled(int on)
+{
+	stats_active = on ? 1 : 0;
+	stats_reset();
+}
+
+int stats_get_enabled()
+{
+	return stats_active;
+}
+
+
+
+
+/*
+ * forget everything gathered so far, and start a new frame
+ */
+void stats_reset()
+{
+	memset(stats_time, 0, sizeof(stats_time));
+	memset(stats_count, 0, sizeof(stats_count));
+	hist_pos = hist_len = 0;
+	frame_start = clock_ns();
+}
+
+
+
+
+/*
+ * close off the frame in progress and add it to the window
+ */
+void stats_frame()
+{
+	long long now, wall, other;
+	frame_stats *f;
+	int i;
+
+	if( !stats_active )
+		return;
+
+	now = clock_ns();
+	wall = now - frame_start;
+	frame_start = now;
+
+	/*
+	 * anything not spent in a measured phase was spent by the
+	 * caller, i.e. in the game's own code or script
+	 */
+	other = wall;
+	for( i=0; i < STATS_PHASES; i++ )
+		other -= stats_time[i];
+	stats_time[STATS_OTHER] = other > 0 ? other : 0;
+
+	/* store the frame, in microseconds */
+	f = &history[hist_pos];
+	f->frames = 1;
+	for( i=0; i < STATS_PHASES; i++ )
+		f->time[i] = (int)(stats_time[i] / 1000);
+	for( i=0; i < STATS_COUNTERS; i++ )
+		f->count[i] = stats_count[i];
+
+	hist_pos = (hist_pos + 1) % STATS_WINDOW;
+	if( hist_len < STATS_WINDOW )
+		hist_len++;
+
+	/* and start the next frame from zero */
+	memset(stats_time, 0, sizeof(stats_time));
+	memset(stats_count, 0, sizeof(stats_count));
+}
+
+
+
+
+/*
+ * read back the figures for the last frame, or the mean or peak
+ * over the window
+ */
+void stats_get(int mode, frame_stats *res)
+{
+	frame_stats *f;
+	int i, j;
+
+	memset(res, 0, sizeof(frame_stats));
+	if( !hist_len )
+		return;
+
+	switch(mode)
+		{
+			case STATS_LAST:
+				*res = history[(hist_pos + STATS_WINDOW - 1) % STATS_WINDOW];
+				break;
+
+			case STATS_MEAN:
+			case STATS_PEAK:
+				for( i=0; i < hist_len; i++ )
+					{
+						f = &history[i];
+						for( j=0; j < STATS_PHASES; j++ )
+							res->time[j] = mode == STATS_MEAN ? res->time[j] + f->time[j] : max(res->time[j], f->time[j]);
+						for( j=0; j < STATS_COUNTERS; j++ )
+							res->count[j] = mode == STATS_MEAN ? res->count[j] + f->count[j] : max(res->count[j], f->count[j]);
+					}
+
+				if( mode == STATS_MEAN )
+					{
+						for( j=0; j < STATS_PHASES; j++ )
+							res->time[j] /= hist_len;
+						for( j=0; j < STATS_COUNTERS; j++ )
+							res->count[j] /= hist_len;
+					}
+
+				res->frames = hist_len;
+				break;
+		}
+
+}
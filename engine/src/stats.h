@@ -0,0 +1,16 @@
+/*
+ * the per-frame profiler
+ */
+
+/* how many frames are kept for the mean and peak figures */
+#define STATS_WINDOW 120
+
+void stats_set_enabled(int);
+int stats_get_enabled();
+void stats_reset();
+void stats_frame();
+void stats_get(int, frame_stats *);
+
+
+/* from clock.c */
+extern long long clock_ns();
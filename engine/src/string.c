@@ -1,5 +1,6 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
 #include "common.h"
 #include "string.h"
@@ -15,6 +16,7 @@ string *string_create()
 	/* initialize the new string */
 	st = ck_calloc(1,sizeof(string));
 	strcpy(st->font,"default");
+	st->face = font_intern(st->font);
 
 	return st;
 
@@ -32,6 +34,9 @@ void string_delete(string *st)
 	if( !st )
 		return;
 
+	object_deleted(OBJ_STRING, st);
+
+	frame_delete(st->surface);
 	free(st);
 
 }
@@ -45,74 +50,221 @@ void string_delete(string *st)
  */
 int string_get_box(string *st, int *w, int *h)
 {
-	int i, len, line_w;
-	font *f;
+	/* failsafe */
+	if( !st )
+		return ERR;
+
+	/* the box is worked out once, when the text or font changes */
+	if( st->face_gen != st->face->gen )
+		string_invalidate(st);
+	if( !st->laid_out )
+		string_layout(st, st->face, NULL);
+
+	*w = st->w;
+	*h = st->h;
+
+	/* ok, done */
+	return 0;
+
+}
+
 
 
+
+
+
+/*
+ * get the string's text drawn out into an RGBA frame, rendering it
+ * if the text or font has changed since it was last drawn.  a frame
+ * is blitted once per string rather than once per character.
+ */
+frame *string_get_surface(string *st)
+{
+	font *f;
+	dimensions span;
+
 	/* failsafe */
 	if( !st )
-		return ERR;
+		return NULL;
+
+	/* already drawn, with the font's current characters? */
+	f = st->face;
+	if( st->face_gen != f->gen )
+		string_invalidate(st);
+	if( st->surface )
+		return st->surface;
+
+	/* nothing to draw, or no font yet to draw it with */
+	if( !f->gen || !*st->text )
+		return NULL;
+
+	/* find the area the characters cover .. */
+	string_layout(st, f, &span);
+	if( span.w <= 0 || span.h <= 0 )
+		return NULL;
+
+	/*
+	 * .. and copy them in, keeping their transparency for when the
+	 * whole string is drawn.  characters side by side are copied, and
+	 * only those struck over others (after a carriage return) are
+	 * blended in.
+	 */
+	st->surface = frame_create(FRAME_RGBA, span.w, span.h, NULL, NULL);
+	memset(st->surface->data, 0, span.w * span.h * RGBA_BYTES);
+	string_draw(st, f, st->surface);
+	st->surface->pixel = system_pixel;
+
+	return st->surface;
+
+}
+
 
 
-	/* initialize the box dimensions */
-	*w = 0;
-	*h = 0;
 
 
-	/* check the font ptr */
-	f = get_font_by_name(st->font);
-	if( f )
+/*
+ * lay out the string's text:  find its bounding box, treating each
+ * newline as the start of a new line, and, if a span is given, the
+ * area its characters cover when drawn.  when drawn, a newline only
+ * moves down a line, and a carriage return moves back to the start.
+ */
+static void string_layout(string *st, font *f, dimensions *span)
+{
+	int i, line_w, x, y;
+	frame *fr;
+	unsigned char c;
+
+	st->w = 0;
+	st->h = 0;
+
+	if( span )
+		{
+			span->w = 0;
+			span->h = 0;
+		}
+
+	/* no text, or no font loaded under the name yet, no box */
+	st->laid_out = 1;
+	st->face_gen = f->gen;
+	if( !*st->text || !f->gen )
+		return;
+
+	/* initialize the line height */
+	st->h = f->chars['\n'] ? f->chars['\n']->h : 0;
+	line_w = 0;
+	x = y = 0;
+
+	for( i=0; st->text[i]; i++ )
 		{
-			/* find and calculate the string length */
-			len = strlen(st->text);
+			c = st->text[i];
+			fr = c < FONT_CT ? f->chars[c] : NULL;
+
+			/* in a proportional-width font, there can be a null frame */
+			if( !fr )
+				continue;
 
-			if( len )
+			/* .. and the switch handles our specific control characters */
+			switch( c )
 				{
-					/* initialize the line height */
-					*h = f->chars['\n']->h;
-					line_w = 0;
+					case '\t':
+						/* tab stop uses 8 spaces */
+						line_w += f->chars[32]->w * 8;
+						x += f->chars[32]->w * 8;
+						break;
+
+					case '\n':
+						/* check to see if this is the longest line yet, and add a new line */
+						if( st->w < line_w )
+							st->w = line_w;
+						line_w = 0;
+						st->h += fr->h;
+						y += fr->h;
+						break;
+
+					case '\r':
+						x = 0;
+						break;
+
+					default:
+						line_w += fr->w;
+						if( span && span->w < x + fr->w )
+							span->w = x + fr->w;
+						if( span && span->h < y + fr->h )
+							span->h = y + fr->h;
+						x += fr->w;
+						break;
 
-					for( i=0; i < len; i++ )
-						{
-							/* .. and the switch handles our specific control characters */
-							switch( *(st->text + i) )
-								{
-									case '\t':
-										line_w += f->chars[32]->w * 8;
-										break;
+				}
+
+		}
 
-									case '\n':
-										/* check to see if this is the longest line yet */
-										if( *w < line_w )
-											*w = line_w;
+	/* check to see if we've saved the length of the longest line */
+	if( st->w < line_w )
+		st->w = line_w;
+
+}
 
-										/* add a new line */
-										line_w = 0;
-										*h += f->chars['\n']->h;
-										break;
 
-									case '\r':
-										break;
 
-									default:
-										line_w += f->chars[*(st->text + i)]->w;
-										break;
 
-								}
 
-						}
+/*
+ * copy the string's characters into a frame, following the layout
+ * above.  the characters of each line are gathered into a run, and
+ * the run is copied a scanline at a time.  nothing needs clipping,
+ * as the frame was sized to fit the text.
+ */
+static void string_draw(string *st, font *f, frame *dest)
+{
+	struct glyph run[MAX_STRING_LENGTH];
+	int i, n, x, y, right;
+	frame *fr;
+	unsigned char c;
 
-					/* check to see if we've saved the length of the longest line */
-					if( *w < line_w )
-						*w = line_w;
+	n = 0;
+	x = y = right = 0;
 
+	for( i=0; st->text[i]; i++ )
+		{
+			c = st->text[i];
+			fr = c < FONT_CT ? f->chars[c] : NULL;
+			if( !fr )
+				continue;
 
+			switch( c )
+				{
+					case '\t':
+						x += f->chars[32]->w * 8;
+						break;
+					case '\n':
+						/* the line's done */
+						copy_run(dest, run, n, y);
+						n = 0;
+						y += fr->h;
+						right = 0;
+						break;
+					case '\r':
+						x = 0;
+						break;
+					default:
+						/* characters are copied as they are, so they need to be in the display's order first */
+						if( fr->pixel.epoch < system_pixel.epoch )
+							swizzle_pixels(fr);
+
+						/* anything left of where the line's been drawn to is struck over it */
+						run[n].fr = fr;
+						run[n].x = x;
+						run[n].over = x < right;
+						n++;
+						x += fr->w;
+						if( right < x )
+							right = x;
+						break;
 				}
 
 		}
 
-	/* ok, done */
-	return 0;
+	copy_run(dest, run, n, y);
 
 }
 
@@ -120,6 +272,104 @@ int string_get_box(string *st, int *w, int *h)
 
 
 
+/*
+ * copy a run of characters into a frame, row by row, starting at the
+ * given row.  characters later in the run land on top of earlier ones,
+ * and are blended over them where they're struck over.
+ */
+static void copy_run(frame *dest, struct glyph *run, int n, int y)
+{
+	int i, row, h;
+	unsigned char *tgt, *src;
+
+	/* the run is as tall as its tallest character */
+	h = 0;
+	for( i=0; i < n; i++ )
+		if( h < run[i].fr->h )
+			h = run[i].fr->h;
+
+	for( row=0; row < h; row++ )
+		{
+			tgt = (unsigned char *)dest->data + (y + row) * dest->stride * RGBA_BYTES;
+			for( i=0; i < n; i++ )
+				{
+					if( row >= run[i].fr->h )
+						continue;
+
+					src = (unsigned char *)run[i].fr->data + row * run[i].fr->stride * RGBA_BYTES;
+					if( run[i].over )
+						strike_row(run[i].fr->w, src, tgt + run[i].x * RGBA_BYTES);
+					else
+						memcpy(tgt + run[i].x * RGBA_BYTES, src, run[i].fr->w * RGBA_BYTES);
+				}
+		}
+
+}
+
+
+
+
+/*
+ * lay a row of a character over what's already drawn, as drawing one
+ * and then the other would:  the result has the transparency of both
+ * together, so blending it in once gives the same colours.
+ */
+static void strike_row(int len, const unsigned char *src, unsigned char *tgt)
+{
+	uint32_t sp, dp, out;
+	int j, k, sa, da, wt, sum, shift[3];
+
+	shift[0] = system_pixel.rshift;
+	shift[1] = system_pixel.gshift;
+	shift[2] = system_pixel.bshift;
+
+	for( j=0; j < len; j++, src += RGBA_BYTES, tgt += RGBA_BYTES )
+		{
+			sp = *(const uint32_t *)src;
+			dp = *(uint32_t *)tgt;
+			sa = sp >> system_pixel.ashift & RGB_MAX;
+			da = dp >> system_pixel.ashift & RGB_MAX;
+
+			/* nothing to blend with, or nothing to blend in */
+			if( sa == RGB_MAX || !da )
+				{
+					*(uint32_t *)tgt = sp;
+					continue;
+				}
+			if( !sa )
+				continue;
+
+			/* the weights of the two, and of the result, out of 255 * 255 */
+			wt = da * (RGB_MAX - sa);
+			sum = sa * RGB_MAX + wt;
+
+			out = (uint32_t)((sum + RGB_MAX / 2) / RGB_MAX) << system_pixel.ashift;
+			for( k=0; k < 3; k++ )
+				out |= (uint32_t)((((sp >> shift[k]) & RGB_MAX) * sa * RGB_MAX + ((dp >> shift[k]) & RGB_MAX) * wt + sum / 2) / sum) << shift[k];
+
+			*(uint32_t *)tgt = out;
+		}
+
+}
+
+
+
+
+
+/*
+ * forget the string's layout and drawn text, after a change to either
+ */
+static void string_invalidate(string *st)
+{
+	frame_delete(st->surface);
+	st->surface = NULL;
+	st->laid_out = 0;
+}
+
+
+
+
+
 
 
 /*
@@ -131,7 +381,14 @@ void string_set_font(string *st, const char *font)
 	if( !st )
 		return;
 
+	/* a change of font means the text needs laying out and drawing again */
+	if( !strncmp(st->font, font, 49) )
+		return;
+
+	/* the name is looked up here, once, rather than whenever the string is drawn */
 	strncpy(st->font, font, 49);
+	st->face = font_intern(st->font);
+	string_invalidate(st);
 
 }
 
@@ -157,7 +414,12 @@ void string_set_text(string *st, const char *text)
 	if( !st )
 		return;
 
+	/* setting the same text again leaves the drawn text alone */
+	if( !strncmp(st->text, text, MAX_STRING_LENGTH-1) )
+		return;
+
 	/* set the text contents of the specified string */
 	strncpy(st->text, text, MAX_STRING_LENGTH-1);
+	string_invalidate(st);
 
 }
@@ -2,17 +2,41 @@
  * string.h
  */
 
+/* a character placed in a run of text */
+struct glyph
+{
+	frame *fr;
+	int x;
+	int over;    /* whether it's struck over characters already drawn */
+};
+
 string *string_create();
 void string_delete(string *);
 
 int string_get_box(string *, int *, int *);
+frame *string_get_surface(string *);
 void string_set_font(string *, const char *);
 void string_set_position(string *, int, int);
 void string_set_text(string *, const char *);
 
+static void string_layout(string *, font *, dimensions *);
+static void string_draw(string *, font *, frame *);
+static void copy_run(frame *, struct glyph *, int, int);
+static void strike_row(int, const unsigned char *, unsigned char *);
+static void string_invalidate(string *);
+
 
 /* from font.c */
-extern font *get_font_by_name(const char *);
+extern font *font_intern(const char *);
+
+/* from frame.c */
+extern frame *frame_create(int, int, int, const void *, const void *);
+extern void frame_delete(frame *);
+
+/* from pixel.c */
+extern pixel_fmt system_pixel;
+extern void swizzle_pixels(frame *);
 
 /* from misc.c */
 extern void *ck_calloc(int, size_t);
+extern void object_deleted(int, void *);
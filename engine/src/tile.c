@@ -44,6 +44,8 @@ void tile_delete(tile *t)
 	if( !t )
 		return;
 
+	object_deleted(OBJ_TILE, t);
+
 	/* free the tile data */
 	for( i=0; i < t->frame_ct; i++ )
 		frame_delete(t->frames[i]);
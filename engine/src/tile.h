@@ -28,3 +28,4 @@ extern void frame_delete(frame *);
 extern void *ck_calloc(int, size_t);
 extern void *ck_realloc(void *, size_t);
 extern void fatal(char *, int);
+extern void object_deleted(int, void *);
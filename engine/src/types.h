@@ -14,10 +14,13 @@ typedef struct box { int x1, y1, x2, y2; } box;
 typedef struct color { unsigned char r, g, b, a; } color;
 
 /* a couple of oddball data structures */
-typedef struct convolution { int kw, kh; char kernel[MAX_CK_SIZE*MAX_CK_SIZE]; int divisor; int offset; } convolution;
+typedef struct convolution { int kw, kh; char kernel[MAX_CK_SIZE*MAX_CK_SIZE]; int divisor; int offset; int mode, radius; } convolution;
 typedef struct lut { unsigned char r[RGB_RANGE], g[RGB_RANGE], b[RGB_RANGE]; } lut;
 typedef struct mcp { unsigned char *code; int tick; } mcp;
 typedef void (*event)(void *);
+typedef void (*load_done)(int, int, void *, void *);
+typedef void (*frame_release)(void *);
+typedef void (*delete_hook)(int, void *);
 
 typedef struct pixel_fmt { char rshift, gshift, bshift, ashift; int epoch; } pixel_fmt;
 
@@ -43,9 +46,10 @@ typedef struct iterator { list *my_l; element *my_el; int ct; } iterator;
 /* the image frame struct, as seen in sprites and map tiles */
 typedef struct frame
 {
-	/* frame type, dimensions */
+	/* frame type, dimensions, and the distance between rows in pixels (the width, except in views) */
 	int tag;
 	int w, h;
+	int stride;
 
 	pixel_fmt pixel;
 
@@ -60,6 +64,23 @@ typedef struct frame
 
 	/* a pixel mask, typically used for pixel-accurate collisions */
 	unsigned char *mask;
+
+	/* FRAME_SHARED_* flags, for data or a mask the frame doesn't own (e.g. from an asset pack) */
+	int shared;
+
+	/* a view's parent frame, and how many views this frame has */
+	struct frame *parent;
+	int refs;
+
+	/* masks replaced while views shared them, kept until the views are gone */
+	list *old_masks;
+
+	/* adopted data is handed back to its owner when the frame is deleted */
+	frame_release release;
+	void *owner;
+
+	/* the scaling tables for the spans the frame was last drawn over */
+	struct span_table *spans;
 } frame;
 
 
@@ -76,8 +97,13 @@ typedef struct sprite
 	point pos;                    /* current position */
 	vector vel;                   /* the current velocity */
 
-	/* the scale factor of the rendered sprite */
+	/* the scale factor of the rendered sprite, and whether its rgba frames are filtered when scaled */
 	point scale;
+	int filter;
+
+	/* the angle it's turned clockwise, in fixed-point degrees, and the nearest of the ROTATE_STEPS it's drawn at */
+	int angle;
+	int turn;
 
 	/* the sprite's composited frames */
 	struct framestack { int len; frame **stack; } *frames;
@@ -136,6 +162,7 @@ typedef struct font
 	char name[50];
 	int w,h;
 	struct frame *chars[FONT_CT];  /* the character slices */
+	int gen;                       /* bumped each time characters are loaded under this name */
 } font;
 
 typedef struct string
@@ -143,6 +170,11 @@ typedef struct string
 	char font[50];                        /* which font to use */
 	int x,y;                              /* the position of this string */
 	char text[MAX_STRING_LENGTH];         /* 240 character limit */
+	int w,h;                              /* the text's bounding box, once it's laid out */
+	int laid_out;
+	struct frame *surface;                /* the text drawn out, once it's been rendered */
+	struct font *face;                    /* the font named above, looked up once */
+	int face_gen;                         /* the font's generation when the text was laid out */
 } string;
 
 
@@ -189,6 +221,24 @@ typedef struct sound
 
 
 
+/*
+ * a memory-mapped asset pack
+ */
+typedef struct pack
+{
+	void *map;            /* the mapping, and its length */
+	long len;
+	int count;            /* how many entries, and the sorted directory of them */
+	const void *dir;
+	pixel_fmt pixel;      /* the pixel order the frames were stored in */
+	const void **masks;   /* the frame entries with a bounding box, sorted by where their masks lie */
+	int mask_ct;
+	int refs;             /* how many frames and sounds still point into the mapping, */
+	int closed;           /* and whether it's unmapped once they're gone */
+} pack;
+
+
+
 /*
  * input-related structs:  axes are analog (or mapped keys) and are
  * always read in pairs, e.g. analog stick 0 will be read on axes 0
@@ -208,3 +258,32 @@ typedef struct mouse
 	int x,y;
 	int button[7];
 } mouse;
+
+
+
+
+/*
+ * frame-pacing statistics, as gathered by clock_wait():  times are
+ * in microseconds, taken over the most recent frames.
+ */
+typedef struct frame_timing
+{
+	int frames;          /* frames paced since the last reset */
+	int missed;          /* how many of those missed their deadline */
+	int mean;            /* mean frame time */
+	int p99;             /* 99th-percentile frame time */
+	int worst;           /* longest frame time */
+} frame_timing;
+
+
+
+/*
+ * per-frame profiler figures:  phase times are in microseconds,
+ * and the counters are totals for the frame.
+ */
+typedef struct frame_stats
+{
+	int frames;                     /* how many frames these figures cover */
+	int time[STATS_PHASES];         /* time spent in each phase */
+	int count[STATS_COUNTERS];      /* work done:  tiles, sprites, pixels .. */
+} frame_stats;
@@ -0,0 +1,200 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "SDL.h"
+#include "SDL_thread.h"
+#include "SDL_mutex.h"
+#include "common.h"
+#include "worker.h"
+
+
+
+/*
+ * rendering work that's split by rows goes to a few threads, each
+ * given a band of rows, while the asking thread does the first band
+ * itself and then waits for the rest.  the threads are only started
+ * the first time there's enough work to share, and one job is shared
+ * out at a time; a job that arrives while another's running is just
+ * done on the spot.
+ */
+static struct worker_band work_bands[WORKER_THREADS];
+static SDL_Thread *work_threads[WORKER_THREADS];
+static int work_running, work_pending, work_busy, work_gen, work_quit;
+static int work_cpus;
+
+static SDL_mutex *work_lock;
+static SDL_cond *work_wake, *work_done;
+
+
+
+
+/*
+ * prepare the worker pool
+ */
+void init_workers()
+{
+	DEBUG( "Initializing render workers...");
+
+	work_running = work_pending = work_busy = work_gen = work_quit = 0;
+	work_cpus = cpu_count();
+
+	work_lock = SDL_CreateMutex();
+	work_wake = SDL_CreateCond();
+	work_done = SDL_CreateCond();
+	DEBUGF;
+}
+
+
+
+
+void quit_workers()
+{
+	int i;
+
+	DEBUG( "Quitting render workers...");
+
+	SDL_mutexP(work_lock);
+	work_quit = 1;
+	SDL_CondBroadcast(work_wake);
+	SDL_mutexV(work_lock);
+
+	for( i=0; i < work_running; i++ )
+		SDL_WaitThread(work_threads[i], NULL);
+	work_running = 0;
+
+	SDL_DestroyCond(work_done);
+	SDL_DestroyCond(work_wake);
+	SDL_DestroyMutex(work_lock);
+	work_lock = NULL;
+	DEBUGF;
+}
+
+
+
+
+
+
+
+/*
+ * run fn(data, y1, y2) over the rows 0 .. rows-1, in bands split
+ * among the worker threads.  cost is the work per row, in pixel
+ * operations, which decides how many bands the rows are worth.
+ * returns once every band is done.
+ */
+void workers_run(int rows, int cost, worker_fn fn, void *data)
+{
+	int i, n;
+
+	/* how many bands? */
+	n = work_lock ? 1 + min(WORKER_THREADS, work_cpus - 1) : 1;
+	n = min(n, rows);
+	n = min(n, (int)((long long)rows * cost / WORKER_MIN_WORK));
+
+	if( n <= 1 )
+		{
+			fn(data, 0, rows);
+			return;
+		}
+
+	SDL_mutexP(work_lock);
+
+	/* already sharing out a job?  then this one's done here */
+	if( work_busy )
+		{
+			SDL_mutexV(work_lock);
+			fn(data, 0, rows);
+			return;
+		}
+
+	work_busy = 1;
+
+	/* start any threads not yet running */
+	for( ; work_running < n - 1; work_running++ )
+		work_threads[work_running] = SDL_CreateThread(worker_loop, (void *)(long)work_running);
+
+	/* hand out every band but the first */
+	work_gen++;
+	for( i=0; i < n - 1; i++ )
+		{
+			work_bands[i].fn = fn;
+			work_bands[i].data = data;
+			work_bands[i].y1 = (long long)rows * (i + 1) / n;
+			work_bands[i].y2 = (long long)rows * (i + 2) / n;
+			work_bands[i].gen = work_gen;
+		}
+
+	work_pending = n - 1;
+	SDL_CondBroadcast(work_wake);
+	SDL_mutexV(work_lock);
+
+	/* do the first band here, and wait for the others */
+	fn(data, 0, rows / n);
+
+	SDL_mutexP(work_lock);
+	while( work_pending )
+		SDL_CondWait(work_done, work_lock);
+	work_busy = 0;
+	SDL_mutexV(work_lock);
+
+}
+
+
+
+
+
+
+
+/*
+ * a worker thread:  wait for a band, work on it, and report back
+ */
+static int worker_loop(void *data)
+{
+	struct worker_band band;
+	int i, last;
+
+	i = (int)(long)data;
+	last = 0;
+
+	SDL_mutexP(work_lock);
+
+	while( 1 )
+		{
+			while( !work_quit && work_bands[i].gen == last )
+				SDL_CondWait(work_wake, work_lock);
+
+			if( work_quit )
+				break;
+
+			band = work_bands[i];
+			last = band.gen;
+
+			SDL_mutexV(work_lock);
+			band.fn(band.data, band.y1, band.y2);
+			SDL_mutexP(work_lock);
+
+			if( !--work_pending )
+				SDL_CondSignal(work_done);
+		}
+
+	SDL_mutexV(work_lock);
+	return 0;
+
+}
+
+
+
+
+/*
+ * how many processors are there to share the work?
+ */
+static int cpu_count()
+{
+#ifdef _SC_NPROCESSORS_ONLN
+	long n;
+
+	n = sysconf(_SC_NPROCESSORS_ONLN);
+	return n > 0 ? n : 1;
+#else
+	return 1 + WORKER_THREADS;
+#endif
+}
@@ -0,0 +1,29 @@
+/*
+ * a pool of threads that rendering work is split among, by rows
+ */
+
+/* the most threads that help out, besides the one asking */
+#define WORKER_THREADS 3
+
+/* the least work, in pixel operations, that's worth handing to a thread */
+#define WORKER_MIN_WORK 16384
+
+typedef void (*worker_fn)(void *, int, int);
+
+struct worker_band
+{
+	worker_fn fn;
+	void *data;
+	int y1, y2;     /* the rows this thread works on */
+	int gen;        /* bumped each time the band is handed out */
+};
+
+
+
+void init_workers();
+void quit_workers();
+
+void workers_run(int, int, worker_fn, void *);
+
+static int worker_loop(void *);
+static int cpu_count();
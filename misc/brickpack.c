@@ -0,0 +1,504 @@
+// brickpack.c - Asset-pack builder for the Brick Engine
+// License:  BSD-style (for this file only)
+// Revision: 261018
+
+//--------------------------------------------------------------------
+// Documentation.
+
+// 1. This program builds an asset pack: a single file holding frames,
+// sounds, and fonts in the form the engine uses them in memory. The
+// engine maps the pack  with "pack_open" (or  "br::pack open") and
+// draws and plays its contents straight from the mapping, so nothing
+// has to be decoded or copied at startup.
+
+// 2. To compile this program under Linux:
+//
+//    cc -o brickpack brickpack.c
+
+// 3. For usage instructions, see the usage-text section.
+
+// 4. The  layout is described in "engine/src/pack.h". All numbers are
+// 32-bit little-endian, so this program must be run on a little-endian
+// machine.
+
+//--------------------------------------------------------------------
+// Global setup.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#define PROGREV "261018"        // Six-digit program revision string
+#define MAGIC   "BRPK"          // File-type string
+#define VERSION 1               // Pack-format version
+
+#define ZERO    0               // zero
+#define ONE     1               // one
+
+#define FALSE   0               // Boolean false
+#define TRUE    1               // Boolean true
+
+#define PACK_FRAME  1           // Entry types
+#define PACK_SOUND  2
+#define PACK_FONT   3
+
+#define FRAME_RGBA  1           // Engine frame types
+#define FRAME_RGB   2
+
+#define NAME_LEN    32          // Longest entry name, plus one
+#define FONT_CT     128         // Characters per font
+#define A_MID       128         // Alpha at which a pixel is "hot"
+#define ALIGN       16          // Data-block alignment
+
+struct header
+{
+    char magic [4];
+    int32_t version;
+    int32_t count;
+    unsigned char order [4];    // r, g, b, a shifts
+};
+
+struct entry
+{
+    char name [NAME_LEN];
+    int32_t type;
+    int32_t tag;
+    int32_t w, h;
+    int32_t data, len;
+    int32_t mask;
+    int32_t bound [4];
+    int32_t reserved;
+};
+
+struct item                     // An entry and its data blocks
+{
+    struct entry e;
+    unsigned char *data;        // Pixels or samples
+    unsigned char *mask;        // Pixel mask, or NULL
+    int32_t *widths;            // Font character widths, or NULL
+};
+
+static unsigned char order [4] = { 16, 8, 0, 24 };
+
+static void fail (const char *msg, const char *arg)
+{
+    fprintf (stderr, "Error: %s %s\n", msg, arg);
+    exit (ONE);
+}
+
+//--------------------------------------------------------------------
+// Read a PNM token (skipping whitespace and comments).
+
+static int pnm_token (FILE *fp, char *buf, int len)
+{
+    int c;
+    int i = ZERO;
+
+    while ((c = getc (fp)) != EOF)
+    {
+        if (c == '#')
+            while ((c = getc (fp)) != EOF && c != '\n') ;
+        else if (c > ' ')
+            break;
+    }
+
+    while (c != EOF && c > ' ' && i < len - 1)
+    {
+        buf [i++] = c;
+        c = getc (fp);
+    }
+
+    buf [i] = '\0';
+    return i;
+}
+
+//--------------------------------------------------------------------
+// Load a P6 (PPM) or P7 (PAM, RGB or RGB_ALPHA) image as RGBA bytes.
+// Sets *alpha if the image carried an alpha channel.
+
+static unsigned char *load_image (const char *file, int *w, int *h,
+    int *alpha)
+{
+    FILE *fp;
+    char tok [64];
+    unsigned char *rgba;
+    int depth = 3;
+    int maxval = 255;
+    int c;
+    int i;
+    int j;
+
+    if ((fp = fopen (file, "rb")) == NULL)
+        fail ("Can't open input file", file);
+
+    *w = *h = ZERO;
+    pnm_token (fp, tok, sizeof (tok));
+
+    if (!strcmp (tok, "P6"))
+    {
+        pnm_token (fp, tok, sizeof (tok)); *w = atoi (tok);
+        pnm_token (fp, tok, sizeof (tok)); *h = atoi (tok);
+        pnm_token (fp, tok, sizeof (tok)); maxval = atoi (tok);
+    }
+    else if (!strcmp (tok, "P7"))
+    {
+        while (pnm_token (fp, tok, sizeof (tok)) &&
+               strcmp (tok, "ENDHDR"))
+        {
+            if (!strcmp (tok, "WIDTH"))
+                { pnm_token (fp, tok, sizeof (tok)); *w = atoi (tok); }
+            else if (!strcmp (tok, "HEIGHT"))
+                { pnm_token (fp, tok, sizeof (tok)); *h = atoi (tok); }
+            else if (!strcmp (tok, "DEPTH"))
+                { pnm_token (fp, tok, sizeof (tok)); depth = atoi (tok); }
+            else if (!strcmp (tok, "MAXVAL"))
+                { pnm_token (fp, tok, sizeof (tok)); maxval = atoi (tok); }
+            else if (!strcmp (tok, "TUPLTYPE"))
+                pnm_token (fp, tok, sizeof (tok));
+        }
+    }
+    else
+        fail ("Not a P6 or P7 image:", file);
+
+    if (*w <= ZERO || *h <= ZERO || maxval != 255 ||
+        (depth != 3 && depth != 4))
+        fail ("Unsupported image (8-bit RGB or RGBA only):", file);
+
+    *alpha = (depth == 4);
+    rgba = malloc ((size_t) *w * *h * 4);
+    if (rgba == NULL) fail ("Out of memory reading", file);
+
+    for (i = ZERO; i < *w * *h; i++)
+    {
+        for (j = ZERO; j < depth; j++)
+        {
+            if ((c = getc (fp)) == EOF)
+                fail ("Truncated image", file);
+            rgba [i * 4 + j] = c;
+        }
+        if (depth == 3) rgba [i * 4 + 3] = 255;
+    }
+
+    fclose (fp);
+    return rgba;
+}
+
+//--------------------------------------------------------------------
+// Rearrange RGBA bytes into the pack's pixel order.
+
+static void reorder (unsigned char *px, int n)
+{
+    unsigned char c [4];
+    int i;
+    int j;
+
+    for (i = ZERO; i < n; i++, px += 4)
+    {
+        memcpy (c, px, 4);
+        for (j = ZERO; j < 4; j++)
+            px [order [j] >> 3] = c [j];
+    }
+}
+
+//--------------------------------------------------------------------
+// Read a whole file.
+
+static unsigned char *load_file (const char *file, int *len)
+{
+    FILE *fp;
+    unsigned char *buf;
+    long n;
+
+    if ((fp = fopen (file, "rb")) == NULL)
+        fail ("Can't open input file", file);
+
+    fseek (fp, 0L, SEEK_END);
+    n = ftell (fp);
+    rewind (fp);
+
+    buf = malloc (n > ZERO ? n : ONE);
+    if (buf == NULL || fread (buf, ONE, n, fp) != (size_t) n)
+        fail ("Can't read input file", file);
+
+    fclose (fp);
+    *len = (int) n;
+    return buf;
+}
+
+//--------------------------------------------------------------------
+// Build the entry for one command-line item.
+
+static void make_frame (struct item *it, const char *file)
+{
+    int w, h, alpha;
+    int x, y;
+    unsigned char *m = NULL;
+    int32_t *b = it->e.bound;
+
+    it->data = load_image (file, &w, &h, &alpha);
+    it->e.tag = alpha ? FRAME_RGBA : FRAME_RGB;
+    it->e.w = w;
+    it->e.h = h;
+    it->e.len = w * h * 4;
+
+    // The mask and bounding box come from alpha >= A_MID, as in the
+    // engine's own frame_set_mask_from()
+
+    b [0] = w; b [1] = h; b [2] = ZERO; b [3] = ZERO;
+    if (alpha) it->mask = m = malloc ((size_t) w * h);
+
+    for (y = ZERO; y < h; y++)
+        for (x = ZERO; x < w; x++)
+        {
+            int hot = it->data [(y * w + x) * 4 + 3] >= A_MID;
+            if (alpha) *m++ = hot;
+            if (!hot) continue;
+            if (x < b [0]) b [0] = x;
+            if (y < b [1]) b [1] = y;
+            if (x + 1 > b [2]) b [2] = x + 1;
+            if (y + 1 > b [3]) b [3] = y + 1;
+        }
+
+    if (b [2] == ZERO) b [0] = b [1] = b [3] = ZERO;
+    reorder (it->data, w * h);
+}
+
+static void make_font (struct item *it, const char *file,
+    const char *wfile)
+{
+    unsigned char *img;
+    unsigned char *dst;
+    int w, h, alpha;
+    int i, x, y;
+    FILE *fp;
+
+    img = load_image (file, &w, &h, &alpha);
+    it->widths = malloc (FONT_CT * sizeof (int32_t));
+
+    // Character widths are a file of FONT_CT numbers; without one,
+    // the characters are of fixed width
+
+    if (wfile != NULL)
+    {
+        if ((fp = fopen (wfile, "r")) == NULL)
+            fail ("Can't open width file", wfile);
+        for (i = ZERO; i < FONT_CT; i++)
+            if (fscanf (fp, "%d", &it->widths [i]) != ONE)
+                fail ("Too few character widths in", wfile);
+        fclose (fp);
+    }
+    else
+        for (i = ZERO; i < FONT_CT; i++)
+            it->widths [i] = w / FONT_CT;
+
+    // Store each character's pixels one after another, already sliced
+
+    for (i = ZERO, x = ZERO; i < FONT_CT; i++)
+    {
+        if (it->widths [i] <= ZERO) fail ("Bad character width in", file);
+        x += it->widths [i];
+    }
+    if (x > w) fail ("Character widths exceed image width:", file);
+
+    it->e.h = h;
+    it->e.len = FONT_CT * sizeof (int32_t) + x * h * 4;
+    it->data = dst = malloc ((size_t) x * h * 4);
+
+    for (i = ZERO, x = ZERO; i < FONT_CT; i++)
+    {
+        for (y = ZERO; y < h; y++)
+        {
+            memcpy (dst, img + (y * w + x) * 4, it->widths [i] * 4);
+            dst += it->widths [i] * 4;
+        }
+        x += it->widths [i];
+    }
+
+    reorder (it->data, (it->e.len - FONT_CT * sizeof (int32_t)) / 4);
+    free (img);
+}
+
+//--------------------------------------------------------------------
+// Pad the output to the data alignment.
+
+static long pad (FILE *fp, long pos)
+{
+    while (pos % ALIGN) { putc (ZERO, fp); pos++; }
+    return pos;
+}
+
+static int by_name (const void *a, const void *b)
+{
+    return strncmp (((const struct item *) a)->e.name,
+                    ((const struct item *) b)->e.name, NAME_LEN);
+}
+
+//--------------------------------------------------------------------
+// Main program.
+
+int main (int argc, char **argv)
+{
+    struct header head;
+    struct item *items;
+    FILE *ofp;
+    char *ofname;               // Output-file name
+    char *cp;                   // Scratch
+    long pos;                   // Output position
+    int n = ZERO;               // Number of entries
+    int i;                      // Counter
+    int a = ONE;                // Argument index
+
+//--------------------------------------------------------------------
+// Handle usage errors.
+
+    if (argc > ONE && !strcmp (argv [ONE], "-rgba"))
+    {
+        order [0] = 0; order [1] = 8; order [2] = 16; order [3] = 24;
+        a++;
+    }
+
+    if (argc - a < 4)
+    {
+puts ("");
+printf ("brickpack %s - Asset-pack builder for the Brick Engine\n",
+    PROGREV);
+puts ("");
+puts ("Usage: brickpack [-rgba] OUTPUT ENTRY...\n");
+puts ("ENTRY is one of:");
+puts ("    frame NAME IMAGE          (IMAGE = P6 or P7 RGB/RGBA)");
+puts ("    sound NAME RAWFILE        (samples in the mixer's format)");
+puts ("    font  NAME IMAGE          (fixed-width characters)");
+puts ("    vfont NAME IMAGE WIDTHS   (WIDTHS = file of 128 numbers)");
+puts ("");
+puts ("Pixels are stored in the  engine's  default display order (as");
+puts ("set by  set_pixel_order(16,8,0)) so they can be drawn without");
+puts ("being touched; \"-rgba\" stores them in frame_create()'s order.");
+puts ("Frames with alpha also get a pixel mask (alpha >= 128) and the");
+puts ("bounding box of their opaque pixels.");
+puts ("");
+
+exit (ONE);
+    }
+
+    ofname = argv [a++];
+
+//--------------------------------------------------------------------
+// Collect the entries.
+
+    items = calloc (argc, sizeof (struct item));
+
+    while (a < argc)
+    {
+        struct item *it = &items [n++];
+
+        if (a + 2 >= argc) fail ("Incomplete entry at", argv [a]);
+        cp = argv [a + ONE];
+        if (strlen (cp) >= NAME_LEN) fail ("Name too long:", cp);
+        strncpy (it->e.name, cp, NAME_LEN);
+
+        if (!strcmp (argv [a], "frame"))
+        {
+            it->e.type = PACK_FRAME;
+            make_frame (it, argv [a + 2]);
+            a += 3;
+        }
+        else if (!strcmp (argv [a], "sound"))
+        {
+            it->e.type = PACK_SOUND;
+            it->data = load_file (argv [a + 2], &it->e.len);
+            a += 3;
+        }
+        else if (!strcmp (argv [a], "font"))
+        {
+            it->e.type = PACK_FONT;
+            make_font (it, argv [a + 2], NULL);
+            a += 3;
+        }
+        else if (!strcmp (argv [a], "vfont") && a + 3 < argc)
+        {
+            it->e.type = PACK_FONT;
+            make_font (it, argv [a + 2], argv [a + 3]);
+            a += 4;
+        }
+        else
+            fail ("Unknown entry type", argv [a]);
+    }
+
+    // The engine looks entries up with a binary search
+
+    qsort (items, n, sizeof (struct item), by_name);
+    for (i = ONE; i < n; i++)
+        if (!by_name (&items [i - 1], &items [i]))
+            fail ("Duplicate name", items [i].e.name);
+
+//--------------------------------------------------------------------
+// Lay out the data blocks after the directory.
+
+    pos = sizeof (struct header) + n * sizeof (struct entry);
+
+    for (i = ZERO; i < n; i++)
+    {
+        struct item *it = &items [i];
+
+        pos = (pos + ALIGN - 1) / ALIGN * ALIGN;
+        it->e.data = pos;
+        pos += it->e.len;
+
+        if (it->mask != NULL)
+        {
+            pos = (pos + ALIGN - 1) / ALIGN * ALIGN;
+            it->e.mask = pos;
+            pos += it->e.w * it->e.h;
+        }
+    }
+
+    if (pos > 0x7fffffffL) fail ("Pack too large:", ofname);
+
+//--------------------------------------------------------------------
+// Write it out.
+
+    if ((ofp = fopen (ofname, "wb")) == NULL)
+        fail ("Can't open output file", ofname);
+
+    memcpy (head.magic, MAGIC, 4);
+    head.version = VERSION;
+    head.count = n;
+    memcpy (head.order, order, 4);
+    fwrite (&head, sizeof (head), ONE, ofp);
+
+    for (i = ZERO; i < n; i++)
+        fwrite (&items [i].e, sizeof (struct entry), ONE, ofp);
+
+    pos = sizeof (struct header) + n * sizeof (struct entry);
+
+    for (i = ZERO; i < n; i++)
+    {
+        struct item *it = &items [i];
+        int len = it->e.len;
+
+        pos = pad (ofp, pos);
+        if (it->widths != NULL)
+        {
+            fwrite (it->widths, sizeof (int32_t), FONT_CT, ofp);
+            len -= FONT_CT * sizeof (int32_t);
+        }
+        fwrite (it->data, ONE, len, ofp);
+        pos += it->e.len;
+
+        if (it->mask != NULL)
+        {
+            pos = pad (ofp, pos);
+            fwrite (it->mask, ONE, it->e.w * it->e.h, ofp);
+            pos += it->e.w * it->e.h;
+        }
+    }
+
+    if (fclose (ofp))
+        fail ("Can't write output file", ofname);
+
+//--------------------------------------------------------------------
+// Wrap it up.
+
+    return (ZERO);
+}